@@ -24,6 +24,7 @@
 
 #include "./types.hpp"
 #include "./collision.hpp"
+#include "./collision_query.hpp"
 #include "./data_block.hpp"
 #include "./transform.hpp"
 
@@ -107,6 +108,8 @@ class Actor {
          * @note The resolution of collisions works better when moving relative in comparison to moving by absolute coordinates
          */
         bool move_relative(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        /// Same as move_relative but with the collidees and hitboxes of a precompiled query
+        bool move_relative(float x, float y, const CollisionQuery& query, bool notify);
 
         /**
          * @brief Moves relative to the world origin respecting potential collision
@@ -120,6 +123,8 @@ class Actor {
          * @note The resolution of collisions works better when moving relative in comparison to moving by absolute coordinates
          */
         bool move_absolute(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        /// Same as move_absolute but with the collidees and hitboxes of a precompiled query
+        bool move_absolute(float x, float y, const CollisionQuery& query, bool notify);
 
         /**
          * @brief Moves relative to current position with no collision check
@@ -141,6 +146,8 @@ class Actor {
          * @return True if at least one collision happened/got resolved, false if there wasn't any collision
          */
         bool unstuck(Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        /// Same as unstuck but with the collidees and hitboxes of a precompiled query
+        bool unstuck(const CollisionQuery& query, bool notify);
 
         /**
          * @brief Separate this actor from all possible collidees by moving in a distinct direction
@@ -148,6 +155,8 @@ class Actor {
          * @note see unstuck for other params
          */
         bool unstuck_along_path(float x, float y,Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        /// Same as unstuck_along_path but with the collidees and hitboxes of a precompiled query
+        bool unstuck_along_path(float x, float y, const CollisionQuery& query, bool notify);
 
         /**
          * @brief Test if this actor is colliding with another actor
@@ -158,6 +167,8 @@ class Actor {
          * @return True if a collision occured, false otherwise
          */
         bool check_collision(Actor other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        /// Same as check_collision but with the hitboxes of a precompiled query, its target is ignored
+        bool check_collision(Actor other, const CollisionQuery& query, bool notify);
 
         /**
          * @brief Separate this actor from another actor
@@ -166,12 +177,16 @@ class Actor {
          * @return True if at least one collision happened/got resolved, false if there wasn't any collision
          */
         bool separate(Actor actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes);
+        /// Same as separate but with the hitboxes of a precompiled query, its target is ignored
+        bool separate(Actor actor, const CollisionQuery& query);
         /**
          * @brief Separate this actor from another actor by moving along supplied direction vector
          * @param x, y The vector indicating the direction used for resolving collisions
          * @note see basic function for more information
          */
         bool separate(float x, float y, Actor actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes);
+        /// Same as separate but with the hitboxes of a precompiled query, its target is ignored
+        bool separate(float x, float y, Actor actor, const CollisionQuery& query);
         /**
          * @brief Separate two actors from each other by moving along two distinct vectors
          * @param x1, y1 The direction supplied for this actor
@@ -179,6 +194,8 @@ class Actor {
          * @note see basic function for more information
          */
         bool separate(float x1, float y1, float x2, float y2, Actor actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes);
+        /// Same as separate but with the hitboxes of a precompiled query, its target is ignored
+        bool separate(float x1, float y1, float x2, float y2, Actor actor, const CollisionQuery& query);
 
         /**
          * @brief Returns true if hitbox is touching other hitboxes of tiles or actors in a specific direction
@@ -190,6 +207,8 @@ class Actor {
          * @return true if there is at least one hitbox pair touching
          */
         bool on_ground(Collidees target, std::string my_hitbox, const std::vector<std::string>& other_hitboxes, Direction dir = Direction::down, int tolerance = 0) const;
+        /// Same as on_ground but with a precompiled query, true if any of its own hitboxes is touching
+        bool on_ground(const CollisionQuery& query, Direction dir = Direction::down, int tolerance = 0) const;
 
         /// When set to true, hitboxes scale proportionally when the actor itself is scaled
         void set_resize_hitbox(bool mode);
@@ -201,7 +220,12 @@ class Actor {
         /// Returns the number of frames the currently active animation type direction combination has
         int get_anim_frame_count() const;
 
-        /// Returns vector containing all collisions since last clear_collisions() call
+        /**
+         * @brief Returns vector containing all collisions since last clear_collisions() call
+         *
+         * Several collisions with the same collidee are ordered by hitbox in the order the hitbox
+         * names first appeared while loading maps, not in the alphabetical order of the names.
+         */
         std::vector<Collision> get_collisions();
         /// Clears actor of its detected collisions
         void clear_collisions();
@@ -209,6 +233,15 @@ class Actor {
         /// When set to false, collisions won't be stored and directly discarded, when true they will be stored again
         void register_collisions(bool r);
 
+        /// Set the category bits of this actor, which get matched against the collision masks of others
+        void set_collision_category(unsigned category);
+        /// Returns the category bits of this actor, 1 by default or as set by the COLLISION_CATEGORY property
+        unsigned get_collision_category() const;
+        /// Set the bits of all categories of actors and map layers this actor collides with
+        void set_collision_mask(unsigned mask);
+        /// Returns the collision mask of this actor, all bits by default or as set by the COLLISION_MASK property
+        unsigned get_collision_mask() const;
+
         /// Returns true if actor is currently hidden, false otherwise
         bool get_hidden() const;
         /// When mode is true, rendering will be suspended, when false actor will be rendered again
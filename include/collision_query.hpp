@@ -0,0 +1,63 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COLLISION_QUERY_HPP_INCLUDED
+#define COLLISION_QUERY_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "./types.hpp"
+
+namespace salmon {
+
+/**
+ * @brief Precompiled set of hitboxes and collidees used by the collision methods of Actor
+ *
+ * The hitbox names get resolved once on construction, so passing the same query
+ * every frame avoids building string vectors and looking up names on each call.
+ * Build queries up front instead of calling the overloads taking hitbox names each frame.
+ */
+class CollisionQuery {
+    public:
+        /**
+         * @brief Resolve the hitbox names of a collision check
+         * @param target Determines if actors, or tiles, or both are checked for collision
+         * @param my_hitboxes A list of hitbox names of the actor to check with
+         * @param other_hitboxes A list of hitbox names of the collidees to check against
+         */
+        CollisionQuery(Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes);
+
+        /// Returns which kind of collidees get checked
+        Collidees get_target() const {return m_target;}
+        /// Sets which kind of collidees get checked without resolving the hitboxes again
+        void set_target(Collidees target) {m_target = target;}
+
+        /// Returns the resolved ids of the hitboxes of the actor
+        const std::vector<unsigned>& get_my_hitboxes() const {return m_my_hitboxes;}
+        /// Returns the resolved ids of the hitboxes of the collidees
+        const std::vector<unsigned>& get_other_hitboxes() const {return m_other_hitboxes;}
+
+    private:
+        Collidees m_target;
+        std::vector<unsigned> m_my_hitboxes;
+        std::vector<unsigned> m_other_hitboxes;
+};
+}
+
+#endif // COLLISION_QUERY_HPP_INCLUDED
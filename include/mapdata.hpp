@@ -26,6 +26,7 @@
 #include "./text.hpp"
 #include "./data_block.hpp"
 #include "./camera.hpp"
+#include "./raycast_hit.hpp"
 
 namespace salmon {
 
@@ -120,6 +121,36 @@ class MapData {
         std::string get_path() const;
         /// Returns reference to DataBlock of this map which holds all property values supplied via tiled
         DataBlock get_data();
+
+        /// Select how actor pairs which possibly collide get found, grid by default
+        void set_broad_phase(BroadPhase strategy);
+        /// Returns the active strategy to find possibly colliding actor pairs
+        BroadPhase get_broad_phase() const;
+
+        /**
+         * @brief Cast a ray and return the closest hitbox it hits
+         * @param origin The start of the ray in world coords
+         * @param direction The direction of the ray, which doesn't need to be normalized
+         * @param max_distance The length of the ray in pixels
+         * @param target Determines if actors, or tiles, or both can be hit
+         * @param hitboxes A list of hitbox names which can be hit
+         * @param mask Only actors and map layers whose collision category shares a bit with the mask can be hit
+         * @return RaycastHit object which is empty if nothing got hit
+         * @note Like collisions, merely touching a hitbox doesn't count as a hit
+         * @note Actors are hit with their hitboxes of the last map update, like the collisions they got
+         */
+        RaycastHit raycast(Point origin, Point direction, float max_distance, Collidees target,
+                           const std::vector<std::string>& hitboxes = {DEFAULT_HITBOX}, unsigned mask = 0xFFFFFFFF);
+        /// Same as raycast but returns every hitbox the ray hits sorted by distance
+        std::vector<RaycastHit> raycast_all(Point origin, Point direction, float max_distance, Collidees target,
+                                            const std::vector<std::string>& hitboxes = {DEFAULT_HITBOX}, unsigned mask = 0xFFFFFFFF);
+
+        /// Same as raycast but the ray runs from one point to another
+        RaycastHit segment_cast(Point from, Point to, Collidees target,
+                                const std::vector<std::string>& hitboxes = {DEFAULT_HITBOX}, unsigned mask = 0xFFFFFFFF);
+        /// Same as raycast_all but the ray runs from one point to another
+        std::vector<RaycastHit> segment_cast_all(Point from, Point to, Collidees target,
+                                                 const std::vector<std::string>& hitboxes = {DEFAULT_HITBOX}, unsigned mask = 0xFFFFFFFF);
     private:
         internal::MapData* m_impl;
 };
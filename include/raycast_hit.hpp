@@ -0,0 +1,76 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RAYCAST_HIT_HPP_INCLUDED
+#define RAYCAST_HIT_HPP_INCLUDED
+
+#include <string>
+#include <memory>
+
+#include "./types.hpp"
+#include "./actor.hpp"
+#include "./tile_instance.hpp"
+
+namespace salmon {
+
+namespace internal{struct RaycastHit;}
+
+/**
+ * @brief Result of a raycast. Identifies the tile or actor which got hit and where.
+ *
+ * The placed tile gets copied out when the raycast returns, so the hit doesn't refer to
+ * the lookup tables of the map. Like collisions, the tile and the actor of a hit stay
+ * valid until the map gets closed or the actor gets erased.
+ * Actors are hit with their hitboxes of the last map update.
+ */
+class RaycastHit {
+    public:
+        /// Constructs a result which didn't hit anything
+        RaycastHit();
+        RaycastHit(internal::RaycastHit hit);
+
+        /// Return true if the ray hit anything
+        bool hit() const;
+        /// Return true if the ray hit a tile
+        bool tile() const;
+        /// Return true if the ray hit an actor
+        bool actor() const;
+
+        /// Returns the point in world coords where the ray enters the hitbox
+        Point get_point() const;
+        /// Returns the unit normal of the side of the hitbox which got hit, zero if the ray started inside of it
+        Point get_normal() const;
+        /// Returns the distance from the origin of the ray to the hit point
+        float get_distance() const;
+        /// Return the name of the hitbox which got hit
+        std::string get_hitbox() const;
+
+        /// Returns the actor which got hit, check actor() since it is invalid if no actor got hit
+        Actor get_actor() const;
+        /// Return the actor id of the actor which got hit, otherwise return 0
+        unsigned get_actor_id() const;
+        /// Returns the instance of the tile which got hit, check tile() since it is invalid if no tile got hit
+        TileInstance get_tile() const;
+
+    private:
+        struct Data;
+        std::shared_ptr<const Data> m_impl;
+};
+}
+
+#endif // RAYCAST_HIT_HPP_INCLUDED
@@ -119,6 +119,12 @@ enum class Collidees {
     tile_and_actor = 3,
 };
 
+/// Determine how actor pairs which possibly collide get found
+enum class BroadPhase {
+    grid = 0, ///< Rebuild a uniform grid each frame, suits most maps
+    sweep_and_prune = 1, ///< Keep actors sorted along one axis between frames, suits many steadily moving actors
+};
+
 /// Useful enum used in many different contexts
 enum class Direction {
     up = 0,
@@ -1,2 +1,2 @@
 #!/bin/bash
-sudo apt-get install zlib1g libb64-0d libtinyxml2-9 libsdl2-2.0-0 libsdl2-image-2.0-0 libsdl2-ttf-2.0-0 libsdl2-mixer-2.0-0
\ No newline at end of file
+sudo apt-get install zlib1g libtinyxml2-9 libsdl2-2.0-0 libsdl2-image-2.0-0 libsdl2-ttf-2.0-0 libsdl2-mixer-2.0-0
\ No newline at end of file
@@ -39,13 +39,13 @@ if [ "$P" == "linux" ]
 then
     if [ "$B" == "64" ]
     then
-        sudo apt-get install libtinyxml2-dev zlib1g-dev libb64-dev libsdl2-dev libsdl2-image-dev libsdl2-ttf-dev libsdl2-mixer-dev
+        sudo apt-get install libtinyxml2-dev zlib1g-dev libsdl2-dev libsdl2-image-dev libsdl2-ttf-dev libsdl2-mixer-dev
         exit
     elif [ "$B" == "32" ]
     then
         sudo apt-get install libglib2.0-dev:i386
         sudo apt-get install libpulse-dev:i386
-        sudo apt-get install gcc-multilib g++-multilib zlib1g-dev:i386 libb64-dev:i386 libtinyxml2-dev:i386
+        sudo apt-get install gcc-multilib g++-multilib zlib1g-dev:i386 libtinyxml2-dev:i386
         sudo apt-get install libsdl2-dev:i386 libsdl2-image-dev:i386 libsdl2-mixer-dev:i386 libsdl2-ttf-dev:i386
         exit
     else
@@ -33,10 +33,10 @@ Actor::Actor(MapData* map) : m_map{map} {}
 
 /**
  * @brief Initialize actor dimensions and name from XML info
- * @param source The @c XMLElement which contains the information
+ * @param source The @c Element which contains the information
  * @return an @c XMLError object which indicates success or error type
  */
-tinyxml2::XMLError Actor::parse_base(tinyxml2::XMLElement* source) {
+tinyxml2::XMLError Actor::parse_base(const Element* source) {
     using namespace tinyxml2;
     XMLError eResult;
 
@@ -80,18 +80,18 @@ tinyxml2::XMLError Actor::parse_base(tinyxml2::XMLElement* source) {
 
 /**
  * @brief Initialize custom actor properties from XML info
- * @param source The @c XMLElement which contains the information
+ * @param source The @c Element which contains the information
  * @return an @c XMLError object which indicates success or error type
  */
-tinyxml2::XMLError Actor::parse_properties(tinyxml2::XMLElement* source) {
+tinyxml2::XMLError Actor::parse_properties(const Element* source) {
     using namespace tinyxml2;
 
-    XMLElement* p_tile_properties = source->FirstChildElement("properties");
+    const Element* p_tile_properties = source->FirstChildElement("properties");
     if(p_tile_properties == nullptr) {
         // Missing properties are generally considered okay
         return XML_SUCCESS;
     }
-    XMLElement* p_property = p_tile_properties->FirstChildElement("property");
+    const Element* p_property = p_tile_properties->FirstChildElement("property");
 
     // Iterate over all property elements
     while(p_property != nullptr) {
@@ -151,6 +151,22 @@ tinyxml2::XMLError Actor::parse_properties(tinyxml2::XMLElement* source) {
             }
         }
 
+        else if(name == "COLLISION_CATEGORY") {
+            XMLError eResult = parse::collision_bits(p_property, m_collision_filter.category);
+            if(eResult != XML_SUCCESS) {
+                Logger(Logger::error) << "Failed parsing the COLLISION_CATEGORY property";
+                return eResult;
+            }
+        }
+
+        else if(name == "COLLISION_MASK") {
+            XMLError eResult = parse::collision_bits(p_property, m_collision_filter.mask);
+            if(eResult != XML_SUCCESS) {
+                Logger(Logger::error) << "Failed parsing the COLLISION_MASK property";
+                return eResult;
+            }
+        }
+
         else if(name == "LATE_POLLING") {
             XMLError eResult = p_property->QueryBoolAttribute("value", &m_late_polling);
             if(eResult != XML_SUCCESS) {
@@ -251,20 +267,20 @@ void Actor::render(float x_cam, float y_cam) const {
  */
 bool Actor::move(float x_factor, float y_factor, bool absolute) {
 
-    unstuck(Collidees::tile,{DEFAULT_HITBOX},{DEFAULT_HITBOX},true);
+    unstuck(Collidees::tile,{HitboxNames::DEFAULT},{HitboxNames::DEFAULT},true);
     if(absolute) {
-        return move_absolute(x_factor,y_factor,Collidees::tile,{DEFAULT_HITBOX},{DEFAULT_HITBOX},true);
+        return move_absolute(x_factor,y_factor,Collidees::tile,{HitboxNames::DEFAULT},{HitboxNames::DEFAULT},true);
     }
     else {
-        return move_relative(x_factor,y_factor,Collidees::tile,{DEFAULT_HITBOX},{DEFAULT_HITBOX},true);
+        return move_relative(x_factor,y_factor,Collidees::tile,{HitboxNames::DEFAULT},{HitboxNames::DEFAULT},true);
     }
 }
 
-bool Actor::move_relative(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::move_relative(float x, float y, Collidees target, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
     move_relative(x,y);
     return !unstuck_along_path(-x,-y,target,my_hitboxes,other_hitboxes,notify);
 }
-bool Actor::move_absolute(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::move_absolute(float x, float y, Collidees target, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
     move_absolute(x,y);
     return !unstuck(target,my_hitboxes,other_hitboxes,notify);
 }
@@ -276,17 +292,18 @@ void Actor::move_absolute(float x, float y) {
     m_transform.set_pos(x,y);
 }
 
-bool Actor::unstuck(Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::unstuck(Collidees target, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
     LayerCollection& layer_collection = get_map().get_layer_collection();
     Rect bounds = m_transform.to_bounding_box();
     bool moved = false;
     if(target == Collidees::tile || target == Collidees::tile_and_actor) {
         for(MapLayer* map : layer_collection.get_map_layers()) {
-            for(TileInstance& tile : map->get_clip(bounds)) {
+            map->ensure_decoded(bounds);
+            map->for_each_tile_collider(bounds, [&](const TileCollider& tile) {
                 if(separate(tile,my_hitboxes,other_hitboxes,notify)) {
                     moved = true;
                 }
-            }
+            });
         }
     }
     if(target == Collidees::actor || target == Collidees::tile_and_actor) {
@@ -301,17 +318,18 @@ bool Actor::unstuck(Collidees target, const std::vector<std::string>& my_hitboxe
     return moved;
 }
 
-bool Actor::unstuck_along_path(float x, float y,Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::unstuck_along_path(float x, float y,Collidees target, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
     LayerCollection& layer_collection = get_map().get_layer_collection();
     Rect bounds = m_transform.to_bounding_box();
     bool moved = false;
     if(target == Collidees::tile || target == Collidees::tile_and_actor) {
         for(MapLayer* map : layer_collection.get_map_layers()) {
-            for(TileInstance& tile : map->get_clip(bounds)) {
+            map->ensure_decoded(bounds);
+            map->for_each_tile_collider(bounds, [&](const TileCollider& tile) {
                 if(separate_along_path(x,y,tile,my_hitboxes,other_hitboxes,notify)) {
                     moved = true;
                 }
-            }
+            });
         }
     }
     if(target == Collidees::actor || target == Collidees::tile_and_actor) {
@@ -428,23 +446,23 @@ bool Actor::valid_anim_state(std::string anim, Direction dir) const {
 
 /**
  * @brief Returns the active hitbox of the supplied type
- * @param type The supplied type
+ * @param id The interned name of the hitbox type
  * @return @c Rect The hitbox
  * @note If there is no valid hitbox an empty one gets returned
  *
  * First the actor checks if the active animation has the hitbox with the name
  * and returns it instead.
  */
-Rect Actor::get_hitbox(std::string type) const {
+Rect Actor::get_hitbox(HitboxId id) const {
 
 
     Rect current_hitbox = {0,0,0,0};
     // Try extracting hitbox from currenty active animated tile
     if(m_anim_state != AnimationType::none && valid_anim_state()) {
-        current_hitbox = m_animations.at(m_anim_state).at(m_direction).get_hitbox(type);
+        current_hitbox = m_animations.at(m_anim_state).at(m_direction).get_hitbox(id);
     }
     // If that failed, extract hitbox from base actor tile
-    if(current_hitbox.empty()) {current_hitbox = m_base_tile.get_hitbox(type);}
+    if(current_hitbox.empty()) {current_hitbox = m_base_tile.get_hitbox(id);}
     // If that also failed just return the empty hitbox
     if(current_hitbox.empty()) {return current_hitbox;}
 
@@ -460,18 +478,16 @@ Rect Actor::get_hitbox(std::string type) const {
  * To the hitboxes of the actor tile, possible hitboxes of the active
  * animation and its animation frame are added. Specific ones may override general ones.
  */
-const std::map<std::string, Rect> Actor::get_hitboxes() const {
+HitboxSet Actor::get_hitboxes() const {
     // Get all hitboxes from base tile
-    std::map<std::string, Rect> hitboxes = m_base_tile.get_hitboxes();
+    HitboxSet hitboxes = m_base_tile.get_hitboxes();
     // If there is a valid animation tile, load those "ontop" of the other hitboxes
     if(m_anim_state != AnimationType::none && valid_anim_state()) {
-        for(const auto& hitbox_pair: m_animations.at(m_anim_state).at(m_direction).get_hitboxes()) {
-            hitboxes[hitbox_pair.first] = hitbox_pair.second;
-        }
+        hitboxes.merge(m_animations.at(m_anim_state).at(m_direction).get_hitboxes());
     }
     // Adjust each hitbox position and return
-    for(auto& hitbox_pair : hitboxes) {
-        m_transform.transform_hitbox(hitbox_pair.second);
+    for(HitboxSet::Entry& hitbox : hitboxes) {
+        m_transform.transform_hitbox(hitbox.rect);
     }
     return hitboxes;
 }
@@ -481,7 +497,7 @@ const std::map<std::string, Rect> Actor::get_hitboxes() const {
  * @param dir The direction of gravity
  * @return @c bool which is True if the actor is on ground
  */
-bool Actor::on_ground(Collidees target, std::string my_hitbox, const std::vector<std::string>& other_hitboxes, Direction dir, int tolerance) const {
+bool Actor::on_ground(Collidees target, HitboxId my_hitbox, const std::vector<HitboxId>& other_hitboxes, Direction dir, int tolerance) const {
     Rect pos = get_hitbox(my_hitbox);
     if(pos.empty()) {return false;}
     Rect temp;
@@ -515,18 +531,18 @@ bool Actor::on_ground(Collidees target, std::string my_hitbox, const std::vector
     return m_map->get_layer_collection().check_collision(temp, target,other_hitboxes);
 }
 
-bool Actor::separate(TileInstance& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::separate(const TileCollider& tile, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
     bool moved = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(HitboxId first_hitbox_id : my_hitboxes) {
+        Rect first_hitbox = get_hitbox(first_hitbox_id);
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = tile.get_hitbox(second_hitbox_name);
+        for(HitboxId second_hitbox_id : other_hitboxes) {
+            Rect second_hitbox = tile.get_hitbox(second_hitbox_id);
             if(second_hitbox.empty()) {continue;}
             if(separate(first_hitbox, second_hitbox)) {
                 moved = true;
                 if(notify) {
-                    add_collision({tile,first_hitbox_name,second_hitbox_name});
+                    add_collision({tile.get_instance(),first_hitbox_id,second_hitbox_id});
                 }
             }
         }
@@ -534,20 +550,20 @@ bool Actor::separate(TileInstance& tile, const std::vector<std::string>& my_hitb
     return moved;
 }
 
-bool Actor::separate(Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::separate(Actor& actor, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
     if(&actor == this) {return false;}
     bool moved = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(HitboxId first_hitbox_id : my_hitboxes) {
+        Rect first_hitbox = get_hitbox(first_hitbox_id);
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = actor.get_hitbox(second_hitbox_name);
+        for(HitboxId second_hitbox_id : other_hitboxes) {
+            Rect second_hitbox = actor.get_hitbox(second_hitbox_id);
             if(second_hitbox.empty()) {continue;}
             if(separate(first_hitbox, second_hitbox)) {
                 moved = true;
                 if(notify) {
-                    add_collision({&actor,first_hitbox_name,second_hitbox_name});
-                    actor.add_collision({this,second_hitbox_name,first_hitbox_name});
+                    add_collision({&actor,first_hitbox_id,second_hitbox_id});
+                    actor.add_collision({this,second_hitbox_id,first_hitbox_id});
                 }
             }
         }
@@ -586,18 +602,18 @@ bool Actor::separate(const Rect& first, const Rect& second) {
     return true;
 }
 
-bool Actor::separate_along_path(float x, float y,TileInstance& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::separate_along_path(float x, float y,const TileCollider& tile, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
     bool moved = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(HitboxId first_hitbox_id : my_hitboxes) {
+        Rect first_hitbox = get_hitbox(first_hitbox_id);
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = tile.get_hitbox(second_hitbox_name);
+        for(HitboxId second_hitbox_id : other_hitboxes) {
+            Rect second_hitbox = tile.get_hitbox(second_hitbox_id);
             if(second_hitbox.empty()) {continue;}
             if(separate_along_path(x, y,first_hitbox, second_hitbox)) {
                 moved = true;
                 if(notify) {
-                    add_collision({tile,first_hitbox_name,second_hitbox_name});
+                    add_collision({tile.get_instance(),first_hitbox_id,second_hitbox_id});
                 }
             }
         }
@@ -605,20 +621,20 @@ bool Actor::separate_along_path(float x, float y,TileInstance& tile, const std::
     return moved;
 }
 
-bool Actor::separate_along_path(float x, float y,Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::separate_along_path(float x, float y,Actor& actor, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
     if(&actor == this) {return false;}
     bool moved = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(HitboxId first_hitbox_id : my_hitboxes) {
+        Rect first_hitbox = get_hitbox(first_hitbox_id);
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = actor.get_hitbox(second_hitbox_name);
+        for(HitboxId second_hitbox_id : other_hitboxes) {
+            Rect second_hitbox = actor.get_hitbox(second_hitbox_id);
             if(second_hitbox.empty()) {continue;}
             if(separate_along_path(x, y,first_hitbox, second_hitbox)) {
                 moved = true;
                 if(notify) {
-                    add_collision({&actor,first_hitbox_name,second_hitbox_name});
-                    actor.add_collision({this,second_hitbox_name,first_hitbox_name});
+                    add_collision({&actor,first_hitbox_id,second_hitbox_id});
+                    actor.add_collision({this,second_hitbox_id,first_hitbox_id});
                 }
             }
         }
@@ -728,7 +744,7 @@ bool Actor::separate_along_path(float x, float y,const Rect& first, const Rect&
     return true;
 }
 
-bool Actor::separate_along_path(float x1, float y1, float x2, float y2, Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes) {
+bool Actor::separate_along_path(float x1, float y1, float x2, float y2, Actor& actor, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes) {
     if(&actor == this) {return false;}
     auto old_pos = m_transform.get_relative(0.0,1.0);
     float old_x = old_pos.x;
@@ -774,80 +790,38 @@ bool Actor::separate_along_path(float x1, float y1, float x2, float y2, Actor& a
 }
 
 
+/// Check collision of all hitboxes of both actors
 bool Actor::check_collision(Actor& other, bool notify) {
-    bool collided = false;
-    for(auto first_hitbox : get_hitboxes()) {
-        Rect& first = first_hitbox.second;
-        if(first.empty()) {continue;}
-        for(auto second_hitbox : other.get_hitboxes()) {
-            Rect& second = second_hitbox.second;
-            if(second.empty()) {continue;}
-            if(first.has_intersection(second)) {
-                collided = true;
-                if(notify) {
-                    add_collision({&other,first_hitbox.first,second_hitbox.first});
-                    other.add_collision({this,second_hitbox.first,first_hitbox.first});
-                }
-            }
+    return intersect_hitboxes(get_hitboxes(), other.get_hitboxes(), [&](HitboxId my_hitbox, HitboxId other_hitbox) {
+        if(notify) {
+            add_collision({&other,my_hitbox,other_hitbox});
+            other.add_collision({this,other_hitbox,my_hitbox});
         }
-    }
-    return collided;
+    });
 }
-bool Actor::check_collision(Actor& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
-    bool collided = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
-        if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = other.get_hitbox(second_hitbox_name);
-            if(second_hitbox.empty()) {continue;}
-            if(first_hitbox.has_intersection(second_hitbox)) {
-                collided = true;
-                if(notify) {
-                    add_collision({&other,first_hitbox_name,second_hitbox_name});
-                    other.add_collision({this,second_hitbox_name,first_hitbox_name});
-                }
-            }
-        }
-    }
-    return collided;
+bool Actor::check_collision(Actor& other, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
+    return intersect_hitboxes(my_hitboxes, [this](HitboxId id) {return HitboxSet::Entry{id, get_hitbox(id)};},
+                              other_hitboxes, [&other](HitboxId id) {return HitboxSet::Entry{id, other.get_hitbox(id)};},
+                              [&](HitboxId my_hitbox, HitboxId other_hitbox) {
+        if(notify) {
+            add_collision({&other,my_hitbox,other_hitbox});
+            other.add_collision({this,other_hitbox,my_hitbox});
+        }
+    });
 }
 
-bool Actor::check_collision(TileInstance& other, bool notify) {
-    bool collided = false;
-    for(auto first_hitbox : get_hitboxes()) {
-        Rect& first = first_hitbox.second;
-        if(first.empty()) {continue;}
-        for(auto second_hitbox : other.get_hitboxes()) {
-            Rect& second = second_hitbox.second;
-            if(second.empty()) {continue;}
-            if(first.has_intersection(second)) {
-                collided = true;
-                if(notify) {
-                    add_collision({other,first_hitbox.first,second_hitbox.first});
-                }
-            }
-        }
-    }
-    return collided;
+/// Check collision of all hitboxes of the tile with all hitboxes of this actor
+bool Actor::check_collision(const TileCollider& other, bool notify) {
+    return intersect_hitboxes(get_hitboxes(), other, [&](HitboxId my_hitbox, HitboxId other_hitbox) {
+        if(notify) {add_collision({other.get_instance(),my_hitbox,other_hitbox});}
+    });
 }
-bool Actor::check_collision(TileInstance& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
-    bool collided = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
-        if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = other.get_hitbox(second_hitbox_name);
-            if(second_hitbox.empty()) {continue;}
-            if(first_hitbox.has_intersection(second_hitbox)) {
-                collided = true;
-                if(notify) {
-                    add_collision({other,first_hitbox_name,second_hitbox_name});
-                }
-            }
-        }
-    }
-    return collided;
+bool Actor::check_collision(const TileCollider& other, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify) {
+    return intersect_hitboxes(my_hitboxes, [this](HitboxId id) {return HitboxSet::Entry{id, get_hitbox(id)};},
+                              other_hitboxes, [&other](HitboxId id) {return HitboxSet::Entry{id, other.get_hitbox(id)};},
+                              [&](HitboxId my_hitbox, HitboxId other_hitbox) {
+        if(notify) {add_collision({other.get_instance(),my_hitbox,other_hitbox});}
+    });
 }
 
 }} // namespace salmon::internal
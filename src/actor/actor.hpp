@@ -26,9 +26,12 @@
 
 #include "transform.hpp"
 #include "actor/collision.hpp"
+#include "actor/collision_filter.hpp"
 #include "actor/data_block.hpp"
 #include "map/tile.hpp"
+#include "util/element_tree.hpp"
 #include "util/game_types.hpp"
+#include "util/hitbox.hpp"
 
 namespace salmon { namespace internal {
 
@@ -44,8 +47,8 @@ class Actor{
         Actor(MapData* map);
 
         // Core functions
-        tinyxml2::XMLError parse_base(tinyxml2::XMLElement* source);
-        tinyxml2::XMLError parse_properties(tinyxml2::XMLElement* source);
+        tinyxml2::XMLError parse_base(const Element* source);
+        tinyxml2::XMLError parse_properties(const Element* source);
 
         bool animate(std::string anim = AnimationType::current, Direction dir = Direction::current, float speed = 1.0);
         bool set_animation(std::string anim = AnimationType::current, Direction dir = Direction::current, int frame = 0);
@@ -57,38 +60,38 @@ class Actor{
         bool move(float x_factor, float y_factor, bool absolute = false);
 
         // Move with collision
-        bool move_relative(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
-        bool move_absolute(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool move_relative(float x, float y, Collidees target, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
+        bool move_absolute(float x, float y, Collidees target, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
         // Move without collision
         void move_relative(float x, float y);
         void move_absolute(float x, float y);
 
-        bool unstuck(Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool unstuck(Collidees target, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
 
-        bool unstuck_along_path(float x, float y,Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool unstuck_along_path(float x, float y,Collidees target, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
 
         bool check_collision(Actor& other, bool notify);
-        bool check_collision(Actor& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool check_collision(Actor& other, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
 
-        bool check_collision(TileInstance& other, bool notify);
-        bool check_collision(TileInstance& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool check_collision(const TileCollider& other, bool notify);
+        bool check_collision(const TileCollider& other, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
 
         // DEPRECATED! Use more granular overload instead
-        bool on_ground(Direction dir = Direction::down, int tolerance = 0) const {return on_ground(Collidees::tile, DEFAULT_HITBOX, {DEFAULT_HITBOX},dir,tolerance);}
-        bool on_ground(Collidees target, std::string my_hitbox, const std::vector<std::string>& other_hitboxes, Direction dir = Direction::down, int tolerance = 0) const;
+        bool on_ground(Direction dir = Direction::down, int tolerance = 0) const {return on_ground(Collidees::tile, HitboxNames::DEFAULT, {HitboxNames::DEFAULT},dir,tolerance);}
+        bool on_ground(Collidees target, HitboxId my_hitbox, const std::vector<HitboxId>& other_hitboxes, Direction dir = Direction::down, int tolerance = 0) const;
 
         // Seperate hitboxes after collision
-        bool separate(TileInstance& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
-        bool separate(Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool separate(const TileCollider& tile, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
+        bool separate(Actor& actor, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
         bool separate(const Rect& first, const Rect& second);
 
         // Separate hitboxes after collision restricted to one direction given in x y values
-        bool separate_along_path(float x, float y,TileInstance& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
-        bool separate_along_path(float x, float y,Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool separate_along_path(float x, float y,const TileCollider& tile, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
+        bool separate_along_path(float x, float y,Actor& actor, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes, bool notify);
         bool separate_along_path(float x, float y,const Rect& first, const Rect& second);
 
         // Separate this and another actor by supplied vectors each
-        bool separate_along_path(float x1, float y1, float x2, float y2, Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes);
+        bool separate_along_path(float x1, float y1, float x2, float y2, Actor& actor, const std::vector<HitboxId>& my_hitboxes, const std::vector<HitboxId>& other_hitboxes);
 
         Transform& get_transform() {return m_transform;}
         const Transform& get_transform() const {return m_transform;}
@@ -126,8 +129,12 @@ class Actor{
         bool get_resize_hitbox() const {return m_resize_hitbox;}
         void set_resize_hitbox(bool mode) {m_resize_hitbox = mode;}
 
-        Rect get_hitbox(std::string type = DEFAULT_HITBOX) const;
-        const std::map<std::string, Rect> get_hitboxes() const;
+        Rect get_hitbox(HitboxId id = HitboxNames::DEFAULT) const;
+        Rect get_hitbox(const std::string& name) const {return get_hitbox(HitboxNames::find(name));}
+        HitboxSet get_hitboxes() const;
+
+        const CollisionFilter& get_collision_filter() const {return m_collision_filter;}
+        void set_collision_filter(const CollisionFilter& filter) {m_collision_filter = filter;}
 
         void add_collision(Collision c) {if(m_register_collisions) {m_collisions.push_back(c);}}
         std::vector<Collision>& get_collisions() {return m_collisions;}
@@ -152,6 +159,7 @@ class Actor{
 
         std::vector<Collision> m_collisions;
         bool m_register_collisions = true;
+        CollisionFilter m_collision_filter; ///< Decides with which actors and map layers collisions get checked
 
         unsigned m_id = 0;
 
@@ -31,30 +31,30 @@ Collision::Collision() :
 }
 
 // Constructor for tile
-Collision::Collision(TileInstance tile, std::string my_hitbox, std::string other_hitbox) :
+Collision::Collision(TileInstance tile, HitboxId my_hitbox, HitboxId other_hitbox) :
  type{CollisionType::tile}, transform{tile.get_transform()}
 {
     data.tile = tile.get_tile();
-    my_hitbox_name = my_hitbox;
-    other_hitbox_name = other_hitbox;
+    my_hitbox_id = my_hitbox;
+    other_hitbox_id = other_hitbox;
 
 }
 
 // Constructor for actor
-Collision::Collision(Actor* actor, std::string my_hitbox, std::string other_hitbox) :
+Collision::Collision(Actor* actor, HitboxId my_hitbox, HitboxId other_hitbox) :
  type{CollisionType::actor}, transform{actor->get_transform()}
 {
     data.actor = actor;
-    my_hitbox_name = my_hitbox;
-    other_hitbox_name = other_hitbox;
+    my_hitbox_id = my_hitbox;
+    other_hitbox_id = other_hitbox;
     actor_id = actor->get_id();
 }
 
 // Constructor for mouse
-Collision::Collision(std::string my_hitbox) :
+Collision::Collision(HitboxId my_hitbox) :
  type{CollisionType::mouse}
 {
-    my_hitbox_name = my_hitbox;
+    my_hitbox_id = my_hitbox;
 }
 
 unsigned Collision::get_actor_id() const {return actor_id;}
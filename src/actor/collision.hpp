@@ -23,6 +23,7 @@
 
 #include "transform.hpp"
 #include "util/game_types.hpp"
+#include "util/hitbox.hpp"
 
 namespace salmon { namespace internal {
 
@@ -45,9 +46,9 @@ class Collision{
 
     public:
         Collision();
-        Collision(std::string my_hitbox);
-        Collision(TileInstance tile, std::string my_hitbox, std::string other_hitbox);
-        Collision(Actor* actor, std::string my_hitbox, std::string other_hitbox);
+        Collision(HitboxId my_hitbox);
+        Collision(TileInstance tile, HitboxId my_hitbox, HitboxId other_hitbox);
+        Collision(Actor* actor, HitboxId my_hitbox, HitboxId other_hitbox);
 
         // Checks against tile types
         bool tile() const {return type == CollisionType::tile;}
@@ -55,8 +56,10 @@ class Collision{
         bool mouse() const {return type == CollisionType::mouse;}
         bool none() const {return type == CollisionType::none;}
 
-        std::string my_hitbox() const {return my_hitbox_name;}
-        std::string other_hitbox() const {return other_hitbox_name;}
+        std::string my_hitbox() const {return HitboxNames::get_name(my_hitbox_id);}
+        std::string other_hitbox() const {return HitboxNames::get_name(other_hitbox_id);}
+        HitboxId get_my_hitbox_id() const {return my_hitbox_id;}
+        HitboxId get_other_hitbox_id() const {return other_hitbox_id;}
 
         // Return cause objects
         Actor* get_actor() const {return type == CollisionType::actor ? data.actor : nullptr;}
@@ -76,8 +79,8 @@ class Collision{
 
         Transform transform;
 
-        std::string my_hitbox_name = "";
-        std::string other_hitbox_name = "";
+        HitboxId my_hitbox_id = HitboxNames::INVALID;
+        HitboxId other_hitbox_id = HitboxNames::INVALID;
 
         unsigned actor_id = 0;
 
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COLLISION_FILTER_HPP_INCLUDED
+#define COLLISION_FILTER_HPP_INCLUDED
+
+#include <SDL.h>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Category and mask bits which decide if two actors or an actor and a map layer may collide at all
+ *
+ * Like in Box2D a pair gets tested only if the category of each side shares a bit with the mask
+ * of the other side. By default everything is in the first category and collides with everything.
+ */
+struct CollisionFilter {
+    static constexpr Uint32 DEFAULT_CATEGORY = 0x00000001;
+    static constexpr Uint32 DEFAULT_MASK = 0xFFFFFFFF;
+
+    Uint32 category = DEFAULT_CATEGORY;
+    Uint32 mask = DEFAULT_MASK;
+
+    /// Returns true if this and other may collide
+    bool accepts(const CollisionFilter& other) const {
+        return (category & other.mask) != 0 && (other.category & mask) != 0;
+    }
+
+    bool operator==(const CollisionFilter& other) const {return category == other.category && mask == other.mask;}
+    bool operator!=(const CollisionFilter& other) const {return !(*this == other);}
+};
+
+}} // namespace salmon::internal
+
+#endif // COLLISION_FILTER_HPP_INCLUDED
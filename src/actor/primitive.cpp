@@ -32,7 +32,7 @@ namespace salmon { namespace internal {
 Primitive::Primitive(MapData& mapdata, std::string name)
                     : m_renderer{mapdata.get_renderer()}, m_name{name} {}
 
-Primitive* Primitive::parse(tinyxml2::XMLElement* source, MapData& base_map) {
+Primitive* Primitive::parse(const Element* source, MapData& base_map) {
     if(source->FirstChildElement("text") != nullptr) {
         return PrimitiveText::parse(source, base_map);
     }
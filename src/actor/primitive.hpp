@@ -25,6 +25,7 @@
 #include "tinyxml2.h"
 
 #include "transform.hpp"
+#include "util/element_tree.hpp"
 
 namespace salmon { namespace internal {
 
@@ -56,7 +57,7 @@ class Primitive {
         bool get_hidden() const {return m_hidden;}
         void set_hidden(bool mode) {m_hidden = mode;}
 
-        static Primitive* parse(tinyxml2::XMLElement* source, MapData& base_map);
+        static Primitive* parse(const Element* source, MapData& base_map);
     protected:
         Transform m_transform;
         SDL_Renderer* m_renderer;
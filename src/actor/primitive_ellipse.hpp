@@ -31,7 +31,7 @@ class PrimitiveEllipse : public Primitive {
         // Covariant return type!
         PrimitiveEllipse* clone() const override {return new PrimitiveEllipse(*this);}
 
-        static Primitive* parse(tinyxml2::XMLElement* source, MapData& base_map);
+        static Primitive* parse(const Element* source, MapData& base_map);
     private:
 
 };
@@ -31,7 +31,7 @@ class PrimitiveLine : public Primitive {
         // Covariant return type!
         PrimitiveLine* clone() const override {return new PrimitiveLine(*this);}
 
-        static PrimitiveLine* parse(tinyxml2::XMLElement* source, MapData& base_map);
+        static PrimitiveLine* parse(const Element* source, MapData& base_map);
     private:
 
 };
@@ -31,7 +31,7 @@ class PrimitivePoint : public Primitive {
         // Covariant return type!
         PrimitivePoint* clone() const override {return new PrimitivePoint(*this);}
 
-        static PrimitivePoint* parse(tinyxml2::XMLElement* source, MapData& base_map);
+        static PrimitivePoint* parse(const Element* source, MapData& base_map);
     private:
 
 };
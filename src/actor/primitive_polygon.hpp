@@ -31,7 +31,7 @@ class PrimitivePolygon : public Primitive {
         // Covariant return type!
         PrimitivePolygon* clone() const override {return new PrimitivePolygon(*this);}
 
-        static PrimitivePolygon* parse(tinyxml2::XMLElement* source, MapData& base_map);
+        static PrimitivePolygon* parse(const Element* source, MapData& base_map);
     private:
 
 };
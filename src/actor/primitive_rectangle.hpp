@@ -36,7 +36,7 @@ class PrimitiveRectangle : public Primitive {
         // Covariant return type!
         PrimitiveRectangle* clone() const override {return new PrimitiveRectangle(*this);}
 
-        static PrimitiveRectangle* parse(tinyxml2::XMLElement* source, MapData& base_map);
+        static PrimitiveRectangle* parse(const Element* source, MapData& base_map);
     private:
 };
 }} // namespace salmon::internal
@@ -50,7 +50,7 @@ bool PrimitiveText::render(float x_cam, float y_cam) const {
     return true;
 }
 
-PrimitiveText* PrimitiveText::parse(tinyxml2::XMLElement* source, MapData& base_map) {
+PrimitiveText* PrimitiveText::parse(const Element* source, MapData& base_map) {
     using namespace tinyxml2;
     XMLError eResult;
     AttributeParser parser;
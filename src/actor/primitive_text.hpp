@@ -52,7 +52,7 @@ class PrimitiveText : public Primitive {
 
         bool generate_texture();
 
-        static PrimitiveText* parse(tinyxml2::XMLElement* source, MapData& base_map);
+        static PrimitiveText* parse(const Element* source, MapData& base_map);
     private:
         MapData* m_mapdata;
         Texture m_texture;
@@ -31,7 +31,7 @@ class PrimitiveTile : public Primitive {
         // Covariant return type!
         PrimitiveTile* clone() const override {return new PrimitiveTile(*this);}
 
-        static PrimitiveTile* parse(tinyxml2::XMLElement* source, MapData& base_map);
+        static PrimitiveTile* parse(const Element* source, MapData& base_map);
     private:
 
 };
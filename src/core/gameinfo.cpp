@@ -29,6 +29,8 @@
 #include "actor/actor.hpp"
 #include "map/tileset.hpp"
 #include "map/layer.hpp"
+#include "map/layer_collection.hpp"
+#include "map/map_layer.hpp"
 #include "util/logger.hpp"
 
 #include <experimental/filesystem>
@@ -244,6 +246,15 @@ bool GameInfo::poll_input_events() {
                 // Close game by aborting update
                 return false;
             }
+            // The content of all target textures got lost
+            case SDL_RENDER_TARGETS_RESET : {
+                for(MapData& map : m_maps) {
+                    for(MapLayer* layer : map.get_layer_collection().get_map_layers()) {
+                        layer->invalidate_cache();
+                    }
+                }
+                break;
+            }
             //User presses a key
             case SDL_KEYDOWN : {
                 if(m_key_repeat == true || e.key.repeat == false) {
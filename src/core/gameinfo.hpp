@@ -30,6 +30,7 @@
 #include "core/font_manager.hpp"
 #include "graphics/texture_cache.hpp"
 #include "util/preloader.hpp"
+#include "util/thread_pool.hpp"
 
 namespace salmon { namespace internal {
 
@@ -68,6 +69,7 @@ public:
     AudioManager& get_audio_manager() {return m_audio_manager;}
     FontManager& get_font_manager() {return m_font_manager;}
     InputCache& get_input_cache() {return m_input_cache;}
+    ThreadPool& get_thread_pool() {return m_thread_pool;}
 
 private:
     bool init();
@@ -105,6 +107,8 @@ private:
 
     std::string m_current_path = ""; ///< Path to the directory of the currently active mapfile
 
+    ThreadPool m_thread_pool; ///< Worker threads for map loading and collision checks, outlives the maps
+
     std::vector<MapData> m_maps; ///< Stores the currently active game map
 };
 }} // namespace salmon::internal
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "graphics/cooked_image.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <experimental/filesystem>
+#include <fstream>
+
+#include "util/logger.hpp"
+#include "util/mapped_file.hpp"
+
+namespace fs = std::experimental::filesystem;
+
+namespace salmon { namespace internal {
+
+const char* const CookedImage::EXTENSION = ".cooked";
+/// Increase whenever the layout of cooked images changes
+const Uint32 CookedImage::VERSION = 1;
+
+namespace {
+    const char MAGIC[8] = {'S','A','L','M','I','M','G','\0'};
+    const Uint32 BYTE_ORDER_MARK = 0x01020304;
+
+    /// The fixed size header of each cooked image, followed by the tightly packed pixels
+    struct Header {
+        char magic[8];
+        Uint32 version;
+        Uint32 byte_order;
+        Sint64 time; ///< Modification time of the image file
+        Uint64 size; ///< Size of the image file
+        Uint32 w;
+        Uint32 h;
+    };
+
+    /// Reads the modification time and size of a file
+    bool stat_file(const std::string& path, Sint64& time, Uint64& size) {
+        std::error_code error;
+        auto file_time = fs::last_write_time(fs::path(path), error);
+        if(error) {return false;}
+        auto file_size = fs::file_size(fs::path(path), error);
+        if(error) {return false;}
+        time = static_cast<Sint64>(file_time.time_since_epoch().count());
+        size = static_cast<Uint64>(file_size);
+        return true;
+    }
+
+    /// Reads the header of a cooked image and checks if it's up to date
+    bool read_header(const MappedFile& file, const std::string& image_path, Header& header) {
+        if(file.get_size() < sizeof(Header)) {return false;}
+        std::memcpy(&header, file.get_data(), sizeof(Header));
+
+        Sint64 time;
+        Uint64 size;
+        return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == CookedImage::VERSION &&
+               header.byte_order == BYTE_ORDER_MARK && stat_file(image_path, time, size) &&
+               header.time == time && header.size == size;
+    }
+}
+
+/// Checks if the image file has an up to date cooked image
+bool CookedImage::is_current(std::string image_path) {
+    MappedFile file;
+    Header header;
+    return file.open(image_path + EXTENSION) && read_header(file, image_path, header);
+}
+
+/**
+ * @brief Loads the cooked image of an image file
+ * @param image_path The path of the image file
+ * @return The surface which has to be freed by the caller, or @c nullptr if there is no up to date cooked image
+ */
+SDL_Surface* CookedImage::load(std::string image_path) {
+    MappedFile file;
+    if(!file.open(image_path + EXTENSION)) {return nullptr;}
+
+    Header header;
+    if(!read_header(file, image_path, header)) {return nullptr;}
+
+    const size_t row_size = static_cast<size_t>(header.w) * 4;
+    if((file.get_size() - sizeof(Header)) / 4 < static_cast<size_t>(header.w) * header.h) {
+        Logger(Logger::warning) << "Ignoring truncated cooked image " << image_path + EXTENSION;
+        return nullptr;
+    }
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, header.w, header.h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if(surface == nullptr) {return nullptr;}
+
+    const Uint8* pixels = file.get_data() + sizeof(Header);
+    for(Uint32 i_y = 0; i_y < header.h; i_y++) {
+        std::memcpy(static_cast<Uint8*>(surface->pixels) + static_cast<size_t>(i_y) * surface->pitch,
+                    pixels + i_y * row_size, row_size);
+    }
+    return surface;
+}
+
+/**
+ * @brief Writes the cooked image of an image file
+ * @param image_path The path of the image file, which gets recorded for detecting outdated cooked images
+ * @param surface The decoded image file
+ * @return @c bool which indicates success or failure
+ */
+bool CookedImage::write(std::string image_path, SDL_Surface* surface) {
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    if(!stat_file(image_path, header.time, header.size)) {
+        Logger(Logger::error) << "Can't find image file at: " << image_path;
+        return false;
+    }
+
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if(converted == nullptr) {
+        Logger(Logger::error) << "Unable to convert image " << image_path << "! SDL Error: " << SDL_GetError();
+        return false;
+    }
+    header.w = converted->w;
+    header.h = converted->h;
+
+    // Write to a temporary file first, so a running game never maps a half written image
+    std::string cooked_path = image_path + EXTENSION;
+    std::string temp_path = cooked_path + ".tmp";
+    bool success;
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+        if(SDL_MUSTLOCK(converted)) {SDL_LockSurface(converted);}
+        const size_t row_size = static_cast<size_t>(converted->w) * 4;
+        for(int i_y = 0; i_y < converted->h; i_y++) {
+            file.write(static_cast<const char*>(converted->pixels) + static_cast<size_t>(i_y) * converted->pitch, row_size);
+        }
+        if(SDL_MUSTLOCK(converted)) {SDL_UnlockSurface(converted);}
+
+        success = static_cast<bool>(file);
+    }
+    SDL_FreeSurface(converted);
+
+    if(!success) {
+        Logger(Logger::error) << "Failed writing cooked image " << temp_path;
+        return false;
+    }
+    std::remove(cooked_path.c_str());
+    if(std::rename(temp_path.c_str(), cooked_path.c_str()) != 0) {
+        Logger(Logger::error) << "Failed renaming " << temp_path << " to " << cooked_path;
+        return false;
+    }
+    return true;
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COOKED_IMAGE_HPP_INCLUDED
+#define COOKED_IMAGE_HPP_INCLUDED
+
+#include <string>
+#include <SDL.h>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Read and write cooked images, which hold the decoded pixels of an image file
+ *
+ * A cooked image lies next to its image file, named like it plus ".cooked". It stores
+ * 32 bit ARGB pixels and the modification time and size of the image file, so outdated
+ * cooked images get ignored. Cooked images are only valid for the byte order they got cooked on.
+ */
+class CookedImage {
+    public:
+        static const char* const EXTENSION;
+        static const Uint32 VERSION;
+
+        static SDL_Surface* load(std::string image_path);
+        static bool is_current(std::string image_path);
+        static bool write(std::string image_path, SDL_Surface* surface);
+};
+
+}} // namespace salmon::internal
+
+#endif // COOKED_IMAGE_HPP_INCLUDED
@@ -22,6 +22,7 @@
 #include <SDL_image.h>
 #include <iostream>
 
+#include "graphics/cooked_image.hpp"
 #include "util/logger.hpp"
 
 namespace salmon { namespace internal {
@@ -53,12 +54,8 @@ bool Texture::loadFromFile( SDL_Renderer* renderer, std::string path )
 	SDL_Texture* newTexture = nullptr;
 
 	//Load image at specified path
-	SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
-	if( loadedSurface == nullptr )
-	{
-		Logger(Logger::error) << "Unable to load image " << path.c_str() << "! SDL_image Error: " << IMG_GetError();
-	}
-	else
+	SDL_Surface* loadedSurface = load_surface( path );
+	if( loadedSurface != nullptr )
 	{
 		//Color key image
 		//SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
@@ -103,12 +100,8 @@ bool Texture::loadFromFile(SDL_Renderer* renderer, std::string path , SDL_Color
 	SDL_Texture* newTexture = nullptr;
 
 	//Load image at specified path
-	SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
-	if( loadedSurface == nullptr )
-	{
-		Logger(Logger::error) << "Unable to load image " << path.c_str() << "! SDL_image Error: " << IMG_GetError();
-	}
-	else
+	SDL_Surface* loadedSurface = load_surface( path );
+	if( loadedSurface != nullptr )
 	{
 		//Color key image
 		SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, color.r, color.g, color.b ) );
@@ -136,6 +129,72 @@ bool Texture::loadFromFile(SDL_Renderer* renderer, std::string path , SDL_Color
 	return mTexture.get() != nullptr;
 }
 
+/**
+ * @brief Creates a SDL2 texture from an already decoded image
+ * @param renderer Supplied renderer to use
+ * @param surface The decoded image, which still has to be freed by the caller
+ * @return @c bool which indicates success or failure
+ */
+bool Texture::loadFromSurface(SDL_Renderer* renderer, SDL_Surface* surface) {
+    //Get rid of preexisting texture
+    free();
+
+    mRenderer = renderer;
+
+    SDL_Texture* newTexture = SDL_CreateTextureFromSurface( renderer, surface );
+    if( newTexture == nullptr )
+    {
+        Logger(Logger::error) << "Unable to create texture from surface! SDL Error: " << SDL_GetError();
+    }
+    else
+    {
+        mWidth = surface->w;
+        mHeight = surface->h;
+    }
+
+    mTexture = std::shared_ptr<SDL_Texture>(newTexture, Texture::Deleter());
+
+    return mTexture.get() != nullptr;
+}
+
+/**
+ * @brief Decodes the supplied image file to a SDL2 surface
+ * @param path Path to the image file
+ * @return The surface which has to be freed by the caller, or @c nullptr on failure
+ *
+ * An up to date cooked image next to the file gets used instead, see CookedImage
+ */
+SDL_Surface* Texture::load_surface(std::string path) {
+    // Prefer an up to date decoded copy made by salmon-cook
+    SDL_Surface* loadedSurface = CookedImage::load( path );
+    if( loadedSurface != nullptr )
+    {
+        return loadedSurface;
+    }
+
+    loadedSurface = IMG_Load( path.c_str() );
+    if( loadedSurface == nullptr )
+    {
+        Logger(Logger::error) << "Unable to load image " << path.c_str() << "! SDL_image Error: " << IMG_GetError();
+    }
+    return loadedSurface;
+}
+
+/**
+ * @brief Decodes the supplied image file to a color keyed SDL2 surface
+ * @param path Path to the image file
+ * @param color The color key of the image which will be transparent when rendered
+ * @return The surface which has to be freed by the caller, or @c nullptr on failure
+ */
+SDL_Surface* Texture::load_surface(std::string path, SDL_Color color) {
+    SDL_Surface* loadedSurface = load_surface(path);
+    if( loadedSurface != nullptr )
+    {
+        SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, color.r, color.g, color.b ) );
+    }
+    return loadedSurface;
+}
+
 /**
  * @brief Creates a texture from a text
  * @param renderer Supplied renderer to use
@@ -187,6 +246,38 @@ bool Texture::loadFromRenderedText( SDL_Renderer* renderer, std::string textureT
 	return mTexture.get() != nullptr;
 }
 
+/**
+ * @brief Creates a transparent texture which can be set as render target
+ * @param renderer Supplied renderer to use
+ * @param w, h The dimensions of the texture in pixels
+ * @return @c bool which indicates success or failure
+ */
+bool Texture::create_target(SDL_Renderer* renderer, int w, int h)
+{
+	//Get rid of preexisting texture
+	free();
+
+	mRenderer = renderer;
+
+	SDL_Texture* newTexture = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h );
+	if( newTexture == nullptr )
+	{
+		Logger(Logger::error) << "Unable to create target texture of size " << w << "x" << h << "! SDL Error: " << SDL_GetError();
+	}
+	else
+	{
+		//Keep transparent areas transparent when rendering the texture
+		SDL_SetTextureBlendMode( newTexture, SDL_BLENDMODE_BLEND );
+		mWidth = w;
+		mHeight = h;
+	}
+
+	mTexture = std::shared_ptr<SDL_Texture>(newTexture, Texture::Deleter());
+
+	//Return success
+	return mTexture.get() != nullptr;
+}
+
 /// Cleans up the hardware texture
 void Texture::free()
 {
@@ -266,6 +357,17 @@ void Texture::render_extra(int x, int y, const SDL_Rect* clip, double angle, boo
     SDL_RenderCopyEx(mRenderer, mTexture.get(), clip, &renderQuad, angle, center, flip);
 }
 
+/// Same as render_extra but with the flip already supplied as SDL flag
+void Texture::render_extra(int x, int y, const SDL_Rect* clip, double angle, SDL_RendererFlip flip, SDL_Point* center) const {
+	SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+	if( clip != nullptr )
+	{
+		renderQuad.w = clip->w;
+		renderQuad.h = clip->h;
+	}
+    SDL_RenderCopyEx(mRenderer, mTexture.get(), clip, &renderQuad, angle, center, flip);
+}
+
 /// @todo Add documentation
 void Texture::render_extra_resize(const SDL_Rect* clip, const SDL_Rect* dest, double angle, bool x_flip, bool y_flip, SDL_Point* center) const {
 	SDL_RendererFlip flip = SDL_FLIP_NONE;
@@ -45,9 +45,19 @@ class Texture
 		// Loads color keyed image at specified path
 		bool loadFromFile(SDL_Renderer* renderer, std::string path , SDL_Color color);
 
+		//Uploads an already decoded image, doesn't take ownership of the surface
+		bool loadFromSurface(SDL_Renderer* renderer, SDL_Surface* surface);
+
+		//Decodes image at specified path without a renderer, safe to call from worker threads
+		static SDL_Surface* load_surface(std::string path);
+		static SDL_Surface* load_surface(std::string path, SDL_Color color);
+
 		//Creates image from font string
 		bool loadFromRenderedText( SDL_Renderer* renderer, std::string textureText, SDL_Color textColor, TTF_Font *font, Uint32 wrap = 0);
 
+		//Creates blank texture which can be used as render target
+		bool create_target(SDL_Renderer* renderer, int w, int h);
+
 		//Set color modulation
 		void setColor( Uint8 red, Uint8 green, Uint8 blue );
 
@@ -61,12 +71,16 @@ class Texture
 		void render(int x, int y, const SDL_Rect* clip = nullptr) const;
 		void render_resize(const SDL_Rect* clip, const SDL_Rect* dest) const;
 		void render_extra(int x, int y, const SDL_Rect* clip, double angle, bool x_flip = false, bool y_flip = false, SDL_Point* center = nullptr) const;
+		void render_extra(int x, int y, const SDL_Rect* clip, double angle, SDL_RendererFlip flip, SDL_Point* center = nullptr) const;
 		void render_extra_resize(const SDL_Rect* clip, const SDL_Rect* dest, double angle, bool x_flip = false, bool y_flip = false, SDL_Point* center = nullptr) const;
 
 		//Gets image dimensions
 		int getWidth() const;
 		int getHeight() const;
 
+		//Gets the underlying SDL texture
+		SDL_Texture* get_sdl_texture() const {return mTexture.get();}
+
         struct Deleter {
             void operator()(SDL_Texture* p) {
                 if(p != nullptr) {SDL_DestroyTexture(p);}
@@ -60,6 +60,22 @@ bool TextureCache::load(std::string full_path, SDL_Color color_key) {
     else {return false;}
 }
 
+Texture TextureCache::get(std::string full_path, SDL_Surface* surface) {
+    make_path_absolute(full_path);
+    if(!load(full_path, surface)) {return m_empty_texture;}
+    else {return m_textures.at(full_path);}
+}
+bool TextureCache::load(std::string full_path, SDL_Surface* surface) {
+    make_path_absolute(full_path);
+
+    Texture temp;
+    if(temp.loadFromSurface(m_renderer,surface)) {
+        m_textures[full_path] = temp;
+        return true;
+    }
+    else {return false;}
+}
+
 bool TextureCache::has(std::string full_path) {
     return (m_textures.find(full_path) != m_textures.end());
 }
@@ -41,6 +41,11 @@ class TextureCache {
         Texture get(std::string full_path, SDL_Color color_key);
         bool load(std::string full_path, SDL_Color color_key);
 
+        /// Uploads an image which got already decoded, for example on a worker thread.
+        /// Like the color key variant this replaces a texture of the same path.
+        Texture get(std::string full_path, SDL_Surface* surface);
+        bool load(std::string full_path, SDL_Surface* surface);
+
         bool has(std::string full_path);
 
     private:
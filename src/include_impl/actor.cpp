@@ -19,6 +19,7 @@
 #include "actor.hpp"
 
 #include "actor/actor.hpp"
+#include "util/hitbox.hpp"
 
 namespace salmon {
 
@@ -37,33 +38,69 @@ std::string Actor::get_template_name() const {return m_impl->get_type();}
 unsigned Actor::get_id() const {return m_impl->get_id();}
 bool Actor::valid_anim_state(std::string anim, Direction dir) const {return m_impl->valid_anim_state(anim,dir);}
 
-bool Actor::move_relative(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {return m_impl->move_relative(x,y,target,my_hitboxes,other_hitboxes,notify);}
-bool Actor::move_absolute(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {return m_impl->move_absolute(x,y,target,my_hitboxes,other_hitboxes,notify);}
+bool Actor::move_relative(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+    return m_impl->move_relative(x,y,target,internal::HitboxNames::find(my_hitboxes),internal::HitboxNames::find(other_hitboxes),notify);
+}
+bool Actor::move_relative(float x, float y, const CollisionQuery& query, bool notify) {
+    return m_impl->move_relative(x,y,query.get_target(),query.get_my_hitboxes(),query.get_other_hitboxes(),notify);
+}
+bool Actor::move_absolute(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+    return m_impl->move_absolute(x,y,target,internal::HitboxNames::find(my_hitboxes),internal::HitboxNames::find(other_hitboxes),notify);
+}
+bool Actor::move_absolute(float x, float y, const CollisionQuery& query, bool notify) {
+    return m_impl->move_absolute(x,y,query.get_target(),query.get_my_hitboxes(),query.get_other_hitboxes(),notify);
+}
 void Actor::move_relative(float x, float y) {m_impl->move_relative(x,y);}
 void Actor::move_absolute(float x, float y) {m_impl->move_absolute(x,y);}
 
 bool Actor::unstuck(Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
-    return m_impl->unstuck(target,my_hitboxes,other_hitboxes,notify);
+    return m_impl->unstuck(target,internal::HitboxNames::find(my_hitboxes),internal::HitboxNames::find(other_hitboxes),notify);
+}
+bool Actor::unstuck(const CollisionQuery& query, bool notify) {
+    return m_impl->unstuck(query.get_target(),query.get_my_hitboxes(),query.get_other_hitboxes(),notify);
 }
 bool Actor::unstuck_along_path(float x, float y,Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
-    return m_impl->unstuck_along_path(x,y,target,my_hitboxes,other_hitboxes,notify);
+    return m_impl->unstuck_along_path(x,y,target,internal::HitboxNames::find(my_hitboxes),internal::HitboxNames::find(other_hitboxes),notify);
+}
+bool Actor::unstuck_along_path(float x, float y, const CollisionQuery& query, bool notify) {
+    return m_impl->unstuck_along_path(x,y,query.get_target(),query.get_my_hitboxes(),query.get_other_hitboxes(),notify);
 }
 
 bool Actor::check_collision(Actor other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
-    return m_impl->check_collision(*other.m_impl,my_hitboxes,other_hitboxes,notify);
+    return m_impl->check_collision(*other.m_impl,internal::HitboxNames::find(my_hitboxes),internal::HitboxNames::find(other_hitboxes),notify);
+}
+bool Actor::check_collision(Actor other, const CollisionQuery& query, bool notify) {
+    return m_impl->check_collision(*other.m_impl,query.get_my_hitboxes(),query.get_other_hitboxes(),notify);
 }
 
 bool Actor::separate(Actor actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes) {
-    return m_impl->separate(*actor.m_impl,my_hitboxes,other_hitboxes,false);
+    return m_impl->separate(*actor.m_impl,internal::HitboxNames::find(my_hitboxes),internal::HitboxNames::find(other_hitboxes),false);
+}
+bool Actor::separate(Actor actor, const CollisionQuery& query) {
+    return m_impl->separate(*actor.m_impl,query.get_my_hitboxes(),query.get_other_hitboxes(),false);
 }
 bool Actor::separate(float x, float y, Actor actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes) {
-    return m_impl->separate_along_path(x,y,*actor.m_impl,my_hitboxes,other_hitboxes,false);
+    return m_impl->separate_along_path(x,y,*actor.m_impl,internal::HitboxNames::find(my_hitboxes),internal::HitboxNames::find(other_hitboxes),false);
+}
+bool Actor::separate(float x, float y, Actor actor, const CollisionQuery& query) {
+    return m_impl->separate_along_path(x,y,*actor.m_impl,query.get_my_hitboxes(),query.get_other_hitboxes(),false);
 }
 bool Actor::separate(float x1, float y1, float x2, float y2, Actor actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes) {
-    return m_impl->separate_along_path(x1,y1,x2,y2,*actor.m_impl,my_hitboxes,other_hitboxes);
+    return m_impl->separate_along_path(x1,y1,x2,y2,*actor.m_impl,internal::HitboxNames::find(my_hitboxes),internal::HitboxNames::find(other_hitboxes));
+}
+bool Actor::separate(float x1, float y1, float x2, float y2, Actor actor, const CollisionQuery& query) {
+    return m_impl->separate_along_path(x1,y1,x2,y2,*actor.m_impl,query.get_my_hitboxes(),query.get_other_hitboxes());
 }
 
-bool Actor::on_ground(Collidees target, std::string my_hitbox, const std::vector<std::string>& other_hitboxes, Direction dir, int tolerance) const {return m_impl->on_ground(target,my_hitbox,other_hitboxes,dir,tolerance);}
+bool Actor::on_ground(Collidees target, std::string my_hitbox, const std::vector<std::string>& other_hitboxes, Direction dir, int tolerance) const {
+    return m_impl->on_ground(target,internal::HitboxNames::find(my_hitbox),internal::HitboxNames::find(other_hitboxes),dir,tolerance);
+}
+bool Actor::on_ground(const CollisionQuery& query, Direction dir, int tolerance) const {
+    for(unsigned my_hitbox : query.get_my_hitboxes()) {
+        if(m_impl->on_ground(query.get_target(),my_hitbox,query.get_other_hitboxes(),dir,tolerance)) {return true;}
+    }
+    return false;
+}
 
 std::vector<Collision> Actor::get_collisions() {
     std::vector<internal::Collision>& temp = m_impl->get_collisions();
@@ -76,6 +113,19 @@ std::vector<Collision> Actor::get_collisions() {
 void Actor::clear_collisions() {m_impl->clear_collisions();}
 void Actor::register_collisions(bool r) {m_impl->register_collisions(r);}
 
+void Actor::set_collision_category(unsigned category) {
+    internal::CollisionFilter filter = m_impl->get_collision_filter();
+    filter.category = category;
+    m_impl->set_collision_filter(filter);
+}
+unsigned Actor::get_collision_category() const {return m_impl->get_collision_filter().category;}
+void Actor::set_collision_mask(unsigned mask) {
+    internal::CollisionFilter filter = m_impl->get_collision_filter();
+    filter.mask = mask;
+    m_impl->set_collision_filter(filter);
+}
+unsigned Actor::get_collision_mask() const {return m_impl->get_collision_filter().mask;}
+
 bool Actor::get_hidden() const {return m_impl->get_hidden();}
 void Actor::set_hidden(bool mode) {m_impl->set_hidden(mode);}
 
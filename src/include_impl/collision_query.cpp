@@ -0,0 +1,44 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "collision_query.hpp"
+
+#include <type_traits>
+
+#include "util/hitbox.hpp"
+
+namespace salmon {
+
+static_assert(std::is_same<unsigned, internal::HitboxId>::value, "CollisionQuery must store internal hitbox ids");
+
+CollisionQuery::CollisionQuery(Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes) :
+m_target{target}
+{
+    // Interning keeps queries valid which are built before the map defining the hitboxes is loaded,
+    // names which are already known get resolved without locking and new ones only once per query
+    m_my_hitboxes.reserve(my_hitboxes.size());
+    for(const std::string& name : my_hitboxes) {
+        m_my_hitboxes.push_back(internal::HitboxNames::intern(name));
+    }
+    m_other_hitboxes.reserve(other_hitboxes.size());
+    for(const std::string& name : other_hitboxes) {
+        m_other_hitboxes.push_back(internal::HitboxNames::intern(name));
+    }
+}
+
+} // namespace salmon
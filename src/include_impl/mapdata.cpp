@@ -18,6 +18,7 @@
  */
 #include "mapdata.hpp"
 
+#include <cmath>
 #include <iostream>
 
 #include "actor/actor.hpp"
@@ -26,6 +27,8 @@
 #include "map/mapdata.hpp"
 #include "map/layer_collection.hpp"
 #include "map/object_layer.hpp"
+#include "map/raycast.hpp"
+#include "util/hitbox.hpp"
 
 namespace salmon {
 
@@ -143,6 +146,35 @@ PixelDimensions MapData::get_dimensions() const {return m_impl->get_dimensions()
 float MapData::get_delta_time() const {return m_impl->get_delta_time();}
 std::string MapData::get_path() const {return m_impl->get_full_path();}
 DataBlock MapData::get_data() {return m_impl->get_data();}
+
+void MapData::set_broad_phase(BroadPhase strategy) {m_impl->get_layer_collection().set_broad_phase(strategy);}
+BroadPhase MapData::get_broad_phase() const {return m_impl->get_layer_collection().get_broad_phase();}
 salmon::Transform* MapData::get_layer_transform(std::string layer_name) {return m_impl->get_layer_transform(layer_name);}
 
+RaycastHit MapData::raycast(Point origin, Point direction, float max_distance, Collidees target, const std::vector<std::string>& hitboxes, unsigned mask) {
+    internal::Ray ray(origin, direction, max_distance);
+    std::vector<internal::RaycastHit> hits = m_impl->get_layer_collection().raycast(ray, target, internal::HitboxNames::find(hitboxes), mask, false);
+    if(hits.empty()) {return RaycastHit();}
+    return RaycastHit(hits.front());
+}
+
+std::vector<RaycastHit> MapData::raycast_all(Point origin, Point direction, float max_distance, Collidees target, const std::vector<std::string>& hitboxes, unsigned mask) {
+    std::vector<RaycastHit> hits;
+    internal::Ray ray(origin, direction, max_distance);
+    for(const internal::RaycastHit& hit : m_impl->get_layer_collection().raycast(ray, target, internal::HitboxNames::find(hitboxes), mask, true)) {
+        hits.push_back(RaycastHit(hit));
+    }
+    return hits;
+}
+
+RaycastHit MapData::segment_cast(Point from, Point to, Collidees target, const std::vector<std::string>& hitboxes, unsigned mask) {
+    Point direction = to - from;
+    return raycast(from, direction, std::sqrt(direction.x * direction.x + direction.y * direction.y), target, hitboxes, mask);
+}
+
+std::vector<RaycastHit> MapData::segment_cast_all(Point from, Point to, Collidees target, const std::vector<std::string>& hitboxes, unsigned mask) {
+    Point direction = to - from;
+    return raycast_all(from, direction, std::sqrt(direction.x * direction.x + direction.y * direction.y), target, hitboxes, mask);
+}
+
 } // namespace salmon
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "raycast_hit.hpp"
+
+#include "actor/actor.hpp"
+#include "map/raycast.hpp"
+#include "map/tile.hpp"
+
+namespace salmon {
+
+/// Everything of an internal hit by value, the collider of a tile points into the tables of the tileset collection
+struct RaycastHit::Data {
+    Point point;
+    Point normal;
+    float distance;
+    internal::HitboxId hitbox;
+    internal::Actor* actor;
+    internal::TileInstance tile;
+};
+
+RaycastHit::RaycastHit() {}
+RaycastHit::RaycastHit(internal::RaycastHit hit) :
+m_impl{std::make_shared<const Data>(Data{hit.point, hit.normal, hit.distance, hit.hitbox, hit.actor,
+                                         hit.actor == nullptr ? hit.tile.get_instance() : internal::TileInstance(nullptr, Transform())})} {}
+
+bool RaycastHit::hit() const {return m_impl != nullptr;}
+bool RaycastHit::tile() const {return hit() && m_impl->actor == nullptr;}
+bool RaycastHit::actor() const {return hit() && m_impl->actor != nullptr;}
+
+Point RaycastHit::get_point() const {return hit() ? m_impl->point : Point{};}
+Point RaycastHit::get_normal() const {return hit() ? m_impl->normal : Point{};}
+float RaycastHit::get_distance() const {return hit() ? m_impl->distance : 0.0f;}
+std::string RaycastHit::get_hitbox() const {return hit() ? internal::HitboxNames::get_name(m_impl->hitbox) : "";}
+
+Actor RaycastHit::get_actor() const {return Actor(actor() ? m_impl->actor : nullptr);}
+unsigned RaycastHit::get_actor_id() const {return actor() ? m_impl->actor->get_id() : 0;}
+TileInstance RaycastHit::get_tile() const {
+    if(!tile()) {return TileInstance(internal::TileInstance(nullptr, Transform()));}
+    return TileInstance(m_impl->tile);
+}
+
+} // namespace salmon
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/cooked_map.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <experimental/filesystem>
+#include <fstream>
+
+#include "util/logger.hpp"
+
+namespace fs = std::experimental::filesystem;
+
+namespace salmon { namespace internal {
+
+const char* const CookedMap::EXTENSION = ".cooked";
+/// Increase whenever the layout of cooked maps or the map parsers change
+const Uint32 CookedMap::VERSION = 2;
+
+namespace {
+    const char MAGIC[8] = {'S','A','L','M','C','O','O','K'};
+    const Uint32 BYTE_ORDER_MARK = 0x01020304;
+
+    /// Reads plain values from a memory buffer with bounds checks
+    class Reader {
+        public:
+            Reader(const Uint8* data, size_t size) : m_data{data}, m_size{size} {}
+
+            template<class T>
+            bool read(T& value) {
+                if(m_size - m_pos < sizeof(T)) {return false;}
+                std::memcpy(&value, m_data + m_pos, sizeof(T));
+                m_pos += sizeof(T);
+                return true;
+            }
+            const Uint8* skip(size_t bytes) {
+                if(m_size - m_pos < bytes) {return nullptr;}
+                const Uint8* data = m_data + m_pos;
+                m_pos += bytes;
+                return data;
+            }
+            void align(size_t alignment) {m_pos = std::min(m_size, (m_pos + alignment - 1) / alignment * alignment);}
+            size_t get_pos() const {return m_pos;}
+
+        private:
+            const Uint8* m_data;
+            size_t m_size;
+            size_t m_pos = 0;
+    };
+
+    template<class T>
+    void write_value(std::vector<char>& buffer, T value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void align(std::vector<char>& buffer, size_t alignment) {
+        buffer.resize((buffer.size() + alignment - 1) / alignment * alignment, 0);
+    }
+}
+
+/**
+ * @brief Maps a cooked map and checks if it's still up to date
+ * @param cooked_path The path of the cooked map
+ * @param base_path The directory of the map which the source paths are relative to
+ * @return @c bool which indicates if the cooked map can be used
+ */
+bool CookedMap::open(std::string cooked_path, std::string base_path) {
+    close();
+    if(!m_file.open(cooked_path)) {return false;}
+
+    Reader reader(m_file.get_data(), m_file.get_size());
+    char magic[8];
+    Uint32 version, byte_order, source_count, block_count;
+    Uint64 elements_size;
+    if(!reader.read(magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+       !reader.read(version) || !reader.read(byte_order) || !reader.read(source_count) ||
+       !reader.read(block_count) || !reader.read(elements_size)) {
+        Logger(Logger::warning) << "Ignoring invalid cooked map " << cooked_path;
+        close();
+        return false;
+    }
+    if(version != VERSION || byte_order != BYTE_ORDER_MARK) {
+        Logger(Logger::info) << "Cooked map " << cooked_path << " was made by another engine version or platform, loading the source files instead";
+        close();
+        return false;
+    }
+
+    // Check the source files for modifications
+    for(Uint32 i = 0; i < source_count; i++) {
+        Source recorded;
+        Uint32 path_size;
+        const Uint8* path;
+        if(!reader.read(recorded.time) || !reader.read(recorded.size) ||
+           !reader.read(path_size) || (path = reader.skip(path_size)) == nullptr) {
+            Logger(Logger::warning) << "Ignoring invalid cooked map " << cooked_path;
+            close();
+            return false;
+        }
+        recorded.path.assign(reinterpret_cast<const char*>(path), path_size);
+
+        Source current;
+        if(!stat_source(base_path, recorded.path, current) || current.time != recorded.time || current.size != recorded.size) {
+            Logger(Logger::info) << "Cooked map " << cooked_path << " is outdated by " << recorded.path << ", loading the source files instead";
+            close();
+            return false;
+        }
+        m_sources.push_back(recorded);
+    }
+
+    // The elements get checked once they're loaded, see get_elements()
+    const Uint8* elements = reader.skip(elements_size);
+    reader.align(8);
+    const Uint8* block_table = reader.skip(static_cast<size_t>(block_count) * 2 * sizeof(Uint64));
+    if(elements == nullptr || block_table == nullptr) {
+        Logger(Logger::warning) << "Ignoring invalid cooked map " << cooked_path;
+        close();
+        return false;
+    }
+
+    m_elements = elements;
+    m_elements_size = elements_size;
+    m_block_table = block_table;
+    m_block_count = block_count;
+    return true;
+}
+
+/// Unmaps the cooked map
+void CookedMap::close() {
+    m_file.close();
+    m_sources.clear();
+    m_elements = nullptr;
+    m_elements_size = 0;
+    m_block_table = nullptr;
+    m_block_count = 0;
+}
+
+/**
+ * @brief Returns a block of decoded tile ids
+ * @param index The index of the block as referenced by the map elements
+ * @param tiles Returns a pointer to the tile ids which stays valid until the map gets closed
+ * @param count Returns the number of tile ids
+ * @return @c bool which indicates if the block exists
+ */
+bool CookedMap::get_block(unsigned index, const Uint32*& tiles, size_t& count) const {
+    if(index >= m_block_count) {return false;}
+
+    Uint64 offset, size;
+    std::memcpy(&offset, m_block_table + index * 2 * sizeof(Uint64), sizeof(Uint64));
+    std::memcpy(&size, m_block_table + index * 2 * sizeof(Uint64) + sizeof(Uint64), sizeof(Uint64));
+    if(offset % sizeof(Uint32) != 0 || offset > m_file.get_size() || (m_file.get_size() - offset) / sizeof(Uint32) < size) {
+        return false;
+    }
+
+    tiles = reinterpret_cast<const Uint32*>(m_file.get_data() + offset);
+    count = size;
+    return true;
+}
+
+/**
+ * @brief Reads the modification time and size of a source file
+ * @param base_path The directory of the map
+ * @param path The path of the file relative to @p base_path
+ * @param source Returns the file info
+ * @return @c bool which indicates if the file exists
+ */
+bool CookedMap::stat_source(std::string base_path, std::string path, Source& source) {
+    std::error_code error;
+    fs::path full_path(base_path + path);
+    auto time = fs::last_write_time(full_path, error);
+    if(error) {return false;}
+    auto size = fs::file_size(full_path, error);
+    if(error) {return false;}
+
+    source.path = path;
+    source.time = static_cast<Sint64>(time.time_since_epoch().count());
+    source.size = static_cast<Uint64>(size);
+    return true;
+}
+
+/**
+ * @brief Writes a cooked map
+ * @param cooked_path The path of the cooked map, an existing file gets replaced
+ * @param sources The files the map got built from
+ * @param elements The elements of the map, which reference the blocks
+ * @param blocks The decoded tile ids of the map layers
+ * @return @c bool which indicates success or failure
+ */
+bool CookedMap::write(std::string cooked_path, const std::vector<Source>& sources, const ElementTree& elements,
+                      const std::vector<std::vector<Uint32>>& blocks) {
+    std::vector<char> buffer(MAGIC, MAGIC + sizeof(MAGIC));
+    write_value(buffer, VERSION);
+    write_value(buffer, BYTE_ORDER_MARK);
+    write_value(buffer, static_cast<Uint32>(sources.size()));
+    write_value(buffer, static_cast<Uint32>(blocks.size()));
+    std::vector<char> element_tables;
+    elements.write(element_tables);
+    write_value(buffer, static_cast<Uint64>(element_tables.size()));
+
+    for(const Source& source : sources) {
+        write_value(buffer, source.time);
+        write_value(buffer, source.size);
+        write_value(buffer, static_cast<Uint32>(source.path.size()));
+        buffer.insert(buffer.end(), source.path.begin(), source.path.end());
+    }
+
+    buffer.insert(buffer.end(), element_tables.begin(), element_tables.end());
+    align(buffer, 8);
+
+    // The block table is followed by the blocks themselves
+    Uint64 offset = buffer.size() + blocks.size() * 2 * sizeof(Uint64);
+    for(const std::vector<Uint32>& block : blocks) {
+        write_value(buffer, offset);
+        write_value(buffer, static_cast<Uint64>(block.size()));
+        offset += (block.size() * sizeof(Uint32) + 7) / 8 * 8;
+    }
+    for(const std::vector<Uint32>& block : blocks) {
+        const char* bytes = reinterpret_cast<const char*>(block.data());
+        buffer.insert(buffer.end(), bytes, bytes + block.size() * sizeof(Uint32));
+        align(buffer, 8);
+    }
+
+    // Write to a temporary file first, so a running game never maps a half written map
+    std::string temp_path = cooked_path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if(!file.write(buffer.data(), buffer.size())) {
+            Logger(Logger::error) << "Failed writing cooked map " << temp_path;
+            return false;
+        }
+    }
+    std::remove(cooked_path.c_str());
+    if(std::rename(temp_path.c_str(), cooked_path.c_str()) != 0) {
+        Logger(Logger::error) << "Failed renaming " << temp_path << " to " << cooked_path;
+        return false;
+    }
+    return true;
+}
+
+}} // namespace salmon::internal
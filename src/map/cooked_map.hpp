@@ -0,0 +1,78 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COOKED_MAP_HPP_INCLUDED
+#define COOKED_MAP_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <SDL.h>
+
+#include "util/element_tree.hpp"
+#include "util/mapped_file.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Read and write cooked maps, which are .tmx files prepared for fast loading
+ *
+ * A cooked map is a binary file next to its .tmx file, named like it plus ".cooked".
+ * It holds the elements of the map with all external tilesets inlined as binary tables,
+ * see ElementTree, and the tile data of each map layer replaced by a reference to a block
+ * of decoded tile ids. Elements and blocks get used straight from the memory mapped file,
+ * so loading a cooked map neither reads XML nor the .tsx files. See MapCooker for its creation.
+ *
+ * The modification times and sizes of the source files are recorded, so outdated
+ * cooked maps get ignored. Cooked maps are only valid for the byte order they got cooked on.
+ */
+class CookedMap {
+    public:
+        static const char* const EXTENSION;
+        static const Uint32 VERSION;
+
+        /// A file the cooked map got built from
+        struct Source {
+            std::string path; ///< Relative to the directory of the map
+            Sint64 time = 0; ///< Last modification time
+            Uint64 size = 0;
+        };
+
+        bool open(std::string cooked_path, std::string base_path);
+        void close();
+
+        bool is_open() const {return m_file.is_open();}
+        bool get_elements(ElementTree& elements) const {return elements.load(m_elements, m_elements_size);}
+        bool get_block(unsigned index, const Uint32*& tiles, size_t& count) const;
+        const std::vector<Source>& get_sources() const {return m_sources;}
+
+        static bool stat_source(std::string base_path, std::string path, Source& source);
+        static bool write(std::string cooked_path, const std::vector<Source>& sources, const ElementTree& elements,
+                          const std::vector<std::vector<Uint32>>& blocks);
+
+    private:
+        MappedFile m_file;
+        std::vector<Source> m_sources;
+        const Uint8* m_elements = nullptr;
+        size_t m_elements_size = 0;
+        const Uint8* m_block_table = nullptr;
+        Uint32 m_block_count = 0;
+};
+
+}} // namespace salmon::internal
+
+#endif // COOKED_MAP_HPP_INCLUDED
@@ -28,21 +28,21 @@
 namespace salmon { namespace internal {
 
 /// Factory function which retrieves a pointer owning the image layer
-ImageLayer* ImageLayer::parse(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) {
+ImageLayer* ImageLayer::parse(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) {
     return new ImageLayer(source, name, layer_collection, eresult);
 }
 
 /// Constructor which only may be used internally
-ImageLayer::ImageLayer(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) : Layer(name, layer_collection) {
+ImageLayer::ImageLayer(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) : Layer(name, layer_collection) {
     eresult = init(source);
 }
 
 /**
  * @brief Initialize the layer by parsing info from source
- * @param source The @c XMLElement from which information is parsed
+ * @param source The @c Element from which information is parsed
  * @return @c XMLError which indicates failure or sucess of parsing
  */
-tinyxml2::XMLError ImageLayer::init(tinyxml2::XMLElement* source) {
+tinyxml2::XMLError ImageLayer::init(const Element* source) {
     using namespace tinyxml2;
     XMLError eResult;
 
@@ -62,7 +62,7 @@ tinyxml2::XMLError ImageLayer::init(tinyxml2::XMLElement* source) {
     if(eResult == XML_SUCCESS) m_opacity = opacity;
 
     // Parse image file path
-    XMLElement* p_image = source->FirstChildElement("image");
+    const Element* p_image = source->FirstChildElement("image");
     if(p_image == nullptr) return XML_ERROR_PARSING_ELEMENT;
     const char* p_source = p_image->Attribute("source");
     if(p_source == nullptr) return XML_ERROR_PARSING_ATTRIBUTE;
@@ -91,9 +91,9 @@ tinyxml2::XMLError ImageLayer::init(tinyxml2::XMLElement* source) {
     m_transform = salmon::Transform(offset_x,offset_y, m_img.getWidth(),m_img.getHeight(),0,0);
 
     // Parse image properties (only blend mode right now)
-    XMLElement* p_properties = source->FirstChildElement("properties");
+    const Element* p_properties = source->FirstChildElement("properties");
     if(p_properties != nullptr) {
-        XMLElement* p_property = p_properties->FirstChildElement("property");
+        const Element* p_property = p_properties->FirstChildElement("property");
         while(p_property != nullptr) {
             const char* p_name;
             p_name = p_property->Attribute("name");
@@ -38,7 +38,7 @@ class ImageLayer : public Layer{
 
         LayerType get_type() override {return LayerType::image;}
 
-        static ImageLayer* parse(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
+        static ImageLayer* parse(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
 
         ImageLayer(const ImageLayer& other) = delete;
         ImageLayer& operator=(const ImageLayer& other) = delete;
@@ -47,10 +47,10 @@ class ImageLayer : public Layer{
         ImageLayer& operator=(ImageLayer&& other) = default;
 
     protected:
-        ImageLayer(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
+        ImageLayer(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
 
     private:
-        tinyxml2::XMLError init(tinyxml2::XMLElement* source);
+        tinyxml2::XMLError init(const Element* source);
 
         std::string m_img_src;
         Texture m_img;
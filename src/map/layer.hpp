@@ -25,6 +25,7 @@
 #include <tinyxml2.h>
 
 #include "transform.hpp"
+#include "util/element_tree.hpp"
 
 namespace salmon {
 
@@ -71,7 +72,7 @@ class Layer {
 
         Transform& get_transform() {return m_transform;}
 
-        static Layer* parse(tinyxml2::XMLElement* source, LayerCollection* layer_collection, tinyxml2::XMLError& eResult);
+        static Layer* parse(const Element* source, LayerCollection* layer_collection, tinyxml2::XMLError& eResult);
 
     protected:
         LayerCollection* m_layer_collection;
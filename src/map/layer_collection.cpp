@@ -16,7 +16,9 @@
  * You should have received a copy of the GNU General Public License
  * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <iostream>
+#include <future>
 
 #include "actor/actor.hpp"
 #include "map/layer.hpp"
@@ -28,22 +30,29 @@
 #include "map/tile.hpp"
 #include "core/gameinfo.hpp"
 #include "util/logger.hpp"
+#include "util/thread_pool.hpp"
 
 namespace salmon { namespace internal {
 
+constexpr size_t LayerCollection::MIN_TASK_PAIRS;
+
 /**
  * @brief Parses each layer and stores in vector member
- * @param source The @c XMLElement which stores the layer info
+ * @param source The @c Element which stores the layer info
  * @param base_map The map which we belong to
+ * @param pool Worker threads which decode the tile data of map layers
  * @return an @c XMLError object which indicates success or error type
+ *
+ * The tile data of each map layer gets decoded on the worker threads while the
+ * following layers get parsed. Errors are reported in layer order like in a sequential load.
  */
- tinyxml2::XMLError LayerCollection::init(tinyxml2::XMLElement* source, MapData& base_map) {
+ tinyxml2::XMLError LayerCollection::init(const Element* source, MapData& base_map, ThreadPool& pool) {
 
     using namespace tinyxml2;
     m_base_map = &base_map;
 
     // Collect all layers to a vector of pointers
-    std::vector<XMLElement*> p_layers;
+    std::vector<const Element*> p_layers;
     if (source == nullptr) {
         // std::cerr << "Mapfile has no layers\n";
         /// @note Empty layer_collection is okay now
@@ -61,12 +70,26 @@ namespace salmon { namespace internal {
     m_layers.reserve(p_layers.size());
 
     // Actually parse each layer of the vector of pointers
+    std::vector<std::future<XMLError>> decoded(p_layers.size());
+    std::vector<XMLError> results(p_layers.size(), XML_SUCCESS);
+    for(unsigned i_layer = 0; i_layer < p_layers.size(); i_layer++) {
+        m_layers.emplace_back(Layer::parse(p_layers[i_layer], this, results[i_layer]));
+        if(results[i_layer] != XML_SUCCESS) {break;}
+
+        if(m_layers.back()->get_type() == Layer::map) {
+            MapLayer* layer = static_cast<MapLayer*>(m_layers.back().get());
+            decoded[i_layer] = pool.submit([layer](){return layer->load_data();});
+        }
+    }
+
+    // Wait for all map layers, the first failing layer gets reported
     for(unsigned i_layer = 0; i_layer < p_layers.size(); i_layer++) {
-        XMLError eResult = XML_SUCCESS;
-        m_layers.emplace_back(Layer::parse(p_layers[i_layer], this, eResult));
-        if(eResult != XML_SUCCESS) {
+        if(decoded[i_layer].valid()) {results[i_layer] = decoded[i_layer].get();}
+    }
+    for(unsigned i_layer = 0; i_layer < p_layers.size(); i_layer++) {
+        if(results[i_layer] != XML_SUCCESS) {
             Logger(Logger::error) << "Failed at parsing layer: " << i_layer;
-            return eResult;
+            return results[i_layer];
         }
     }
     return XML_SUCCESS;
@@ -92,11 +115,20 @@ bool LayerCollection::render(const Camera& camera) const{
 /**
  * @brief Updates each object layer state
  *
- * First poll possible actor - actor, actor - tile and actor - mouse intersections
+ * First decode the chunks of infinite maps near the camera
+ * Then poll possible actor - actor, actor - tile and actor - mouse intersections
  * Then call update for each object layer (Establishes correct render order for actors)
  * @note Doesn't poll collisions on late updates
  */
 void LayerCollection::update() {
+    // Rendering can't decode the chunks of infinite maps, so decode those which the camera may show.
+    // Half a screen of padding covers scrolling between this update and the next render.
+    Rect view = m_base_map->get_camera().get_transform().to_rect();
+    view = Rect{view.x - view.w / 2, view.y - view.h / 2, view.w * 2, view.h * 2};
+    for(MapLayer* map : get_map_layers()) {
+        map->ensure_decoded(view);
+    }
+
     // Add possible collisions to actors
     collision_check();
     mouse_collision();
@@ -183,25 +215,218 @@ std::vector<ObjectLayer*> LayerCollection::get_object_layers() {
 
 /**
  * @brief Adds collisions for actor -- actor and actor -- tile hitbox intersections
+ *
+ * Pairs of actors and map layers whose collision filters don't accept each other are skipped.
+ * Actors whose hitboxes, filter and bounding box didn't change since the last frame replay
+ * their tile contacts from the cache while the map layers don't change either, in the same
+ * order as testing them again would yield. Pairs of actors always get tested again, since
+ * intersecting a few hitboxes costs no more than looking up their last result.
  */
 void LayerCollection::collision_check() {
     // Iterate over the hitboxes of all actors
     std::vector<Actor*> actors = get_actors();
+    m_frame_actors = actors;
     if(actors.empty()) {return;}
-    for(unsigned i = 0; i < actors.size()-1; i++) {
-        for(unsigned j = i + 1; j < actors.size(); j++) {
-            actors[i]->check_collision(*actors[j],true);
+    m_collision_frame++;
+
+    m_actor_hitboxes.resize(actors.size());
+    m_actor_bounds.resize(actors.size());
+    m_actor_filters.resize(actors.size());
+    m_actor_caches.resize(actors.size());
+    m_actor_unchanged.resize(actors.size());
+    for(unsigned i = 0; i < actors.size(); i++) {
+        m_actor_hitboxes[i] = actors[i]->get_hitboxes();
+        m_actor_bounds[i] = m_actor_hitboxes[i].get_bounds();
+        m_actor_filters[i] = actors[i]->get_collision_filter();
+
+        // Moving, scaling or animating the actor shows in its hitboxes
+        auto found = m_contact_cache.find(actors[i]);
+        const bool known = found != m_contact_cache.end();
+        if(!known) {found = m_contact_cache.emplace(actors[i], ContactCache()).first;}
+        ContactCache& cache = found->second;
+        m_actor_unchanged[i] = known && cache.frame + 1 == m_collision_frame
+                            && cache.actor_id == actors[i]->get_id()
+                            && cache.hitboxes == m_actor_hitboxes[i]
+                            && cache.filter == m_actor_filters[i];
+        if(!m_actor_unchanged[i]) {
+            cache.actor_id = actors[i]->get_id();
+            cache.hitboxes = m_actor_hitboxes[i];
+            cache.filter = m_actor_filters[i];
         }
+        cache.frame = m_collision_frame;
+        m_actor_caches[i] = &cache;
+    }
+    // Forget actors which are gone
+    for(auto it = m_contact_cache.begin(); it != m_contact_cache.end();) {
+        if(it->second.frame != m_collision_frame) {it = m_contact_cache.erase(it);}
+        else {++it;}
     }
 
-    for(Actor* actor : actors) {
+    // Broad phase: only pairs sharing a grid cell can collide
+    const std::vector<std::pair<unsigned, unsigned>>* pairs;
+    if(m_broad_phase == BroadPhase::sweep_and_prune) {
+        pairs = &sweep_and_prune(actors);
+    }
+    else {
+        m_spatial_hash.build(m_actor_bounds, m_actor_filters);
+        m_spatial_hash_frame = m_collision_frame;
+        pairs = &m_spatial_hash.get_pairs();
+    }
+
+    run_narrow_phase(actors, *pairs);
+
+    std::vector<MapLayer*> map_layers = get_map_layers();
+    const bool tiles_unchanged = update_tile_state(map_layers);
+    for(unsigned i = 0; i < actors.size(); i++) {
+        Actor* actor = actors[i];
+        ContactCache& cache = *m_actor_caches[i];
         Rect bounds = actor->get_transform().to_bounding_box();
-        for(MapLayer* layer : get_map_layers()) {
-            for(auto tile : layer->get_clip(bounds)) {
-                actor->check_collision(tile,true);
-            }
+        if(m_tile_cache && m_actor_unchanged[i] && tiles_unchanged && cache.tiles_valid
+           && bounds.x == cache.tile_bounds.x && bounds.y == cache.tile_bounds.y
+           && bounds.w == cache.tile_bounds.w && bounds.h == cache.tile_bounds.h) {
+            for(const Collision& c : cache.tile_contacts) {actor->add_collision(c);}
+            continue;
+        }
+
+        cache.tile_bounds = bounds;
+        cache.tile_contacts.clear();
+        cache.tiles_valid = true;
+        for(MapLayer* layer : map_layers) {
+            if(!m_actor_filters[i].accepts(layer->get_collision_filter())) {continue;}
+            layer->ensure_decoded(bounds);
+            layer->for_each_tile_collider(bounds, [&](const TileCollider& tile) {
+                // The hitboxes of animated tiles may change without any other change
+                if(tile.get_tile()->is_animated()) {cache.tiles_valid = false;}
+                intersect_hitboxes(m_actor_hitboxes[i], tile, [&](HitboxId my_hitbox, HitboxId other_hitbox) {
+                    cache.tile_contacts.emplace_back(tile.get_instance(), my_hitbox, other_hitbox);
+                    actor->add_collision(cache.tile_contacts.back());
+                });
+            });
+        }
+    }
+}
+
+/**
+ * @brief Test the candidate pairs and add the resulting collisions to the actors
+ *
+ * Large pair lists get split into consecutive ranges which are tested on the worker threads.
+ * Each task only writes to its own buffer. The buffers get merged in range order, so the
+ * collisions are added in the same order as when testing all pairs on one thread.
+ */
+void LayerCollection::run_narrow_phase(const std::vector<Actor*>& actors, const std::vector<std::pair<unsigned, unsigned>>& pairs) {
+    ThreadPool& pool = m_base_map->get_game().get_thread_pool();
+    // The calling thread takes the last range itself
+    size_t tasks = std::min<size_t>(pool.get_size() + 1, pairs.size() / MIN_TASK_PAIRS);
+    if(tasks < 1) {tasks = 1;}
+    if(m_narrow_phase_buffers.size() < tasks) {m_narrow_phase_buffers.resize(tasks);}
+
+    std::vector<std::future<void>> done;
+    for(size_t i_task = 0; i_task + 1 < tasks; i_task++) {
+        size_t begin = pairs.size() * i_task / tasks;
+        size_t end = pairs.size() * (i_task + 1) / tasks;
+        NarrowPhaseBuffer* buffer = &m_narrow_phase_buffers[i_task];
+        done.push_back(pool.submit([this, &pairs, begin, end, buffer](){collide_pairs(pairs, begin, end, *buffer);}));
+    }
+    collide_pairs(pairs, pairs.size() * (tasks - 1) / tasks, pairs.size(), m_narrow_phase_buffers[tasks - 1]);
+    for(std::future<void>& task : done) {task.get();}
+
+    for(size_t i_task = 0; i_task < tasks; i_task++) {
+        for(const PairContact& c : m_narrow_phase_buffers[i_task].contacts) {
+            actors[c.first]->add_collision({actors[c.second], c.first_hitbox, c.second_hitbox});
+            actors[c.second]->add_collision({actors[c.first], c.second_hitbox, c.first_hitbox});
+        }
+    }
+}
+
+/**
+ * @brief Test a range of candidate pairs and store their collisions in a buffer
+ *
+ * Only reads the state of the collision check, so ranges can be tested concurrently.
+ */
+void LayerCollection::collide_pairs(const std::vector<std::pair<unsigned, unsigned>>& pairs, size_t begin, size_t end, NarrowPhaseBuffer& buffer) const {
+    buffer.contacts.clear();
+    for(size_t i_pair = begin; i_pair < end; i_pair++) {
+        const unsigned first = pairs[i_pair].first;
+        const unsigned second = pairs[i_pair].second;
+        intersect_hitboxes(m_actor_hitboxes[first], m_actor_hitboxes[second], [&](HitboxId first_hitbox, HitboxId second_hitbox) {
+            buffer.contacts.push_back(PairContact{first, second, first_hitbox, second_hitbox});
+        });
+    }
+}
+
+/**
+ * @brief Store the state of all map layers which cached tile contacts depend on
+ * @return True if no layer changed since the last call
+ */
+bool LayerCollection::update_tile_state(std::vector<MapLayer*>& map_layers) {
+    bool unchanged = map_layers.size() == m_tile_state.size();
+    m_tile_state.resize(map_layers.size());
+    for(unsigned i = 0; i < map_layers.size(); i++) {
+        MapLayer* layer = map_layers[i];
+        TileState& state = m_tile_state[i];
+        Point offset = layer->get_transform().get_relative(0,0);
+        if(state.layer != layer || state.revision != layer->get_revision()
+           || state.offset.x != offset.x || state.offset.y != offset.y
+           || state.filter != layer->get_collision_filter()) {
+            unchanged = false;
+            state = TileState{layer, layer->get_revision(), offset, layer->get_collision_filter()};
+        }
+    }
+    return unchanged;
+}
+
+/**
+ * @brief Update the persistent sweep and prune state with the actor bounds of this frame
+ * @param actors The actors of this frame, m_actor_bounds and m_actor_filters must hold their bounds and filters
+ * @return The candidate pairs as actor indices, sorted like the pairs of the grid
+ *
+ * Actors keep their handle while they exist, so only their bounds get updated.
+ * Actors which vanished since the last frame get removed.
+ */
+const std::vector<std::pair<unsigned, unsigned>>& LayerCollection::sweep_and_prune(const std::vector<Actor*>& actors) {
+    const unsigned NO_ACTOR = static_cast<unsigned>(-1);
+    std::fill(m_proxy_actors.begin(), m_proxy_actors.end(), NO_ACTOR);
+    for(unsigned i = 0; i < actors.size(); i++) {
+        unsigned proxy;
+        auto found = m_actor_proxies.find(actors[i]);
+        if(found == m_actor_proxies.end()) {
+            proxy = m_sweep_and_prune.add(m_actor_bounds[i]);
+            m_actor_proxies.emplace(actors[i], proxy);
+        }
+        else {
+            proxy = found->second;
+            m_sweep_and_prune.move(proxy, m_actor_bounds[i]);
         }
+        if(proxy >= m_proxy_actors.size()) {m_proxy_actors.resize(proxy + 1, NO_ACTOR);}
+        m_proxy_actors[proxy] = i;
+    }
+    for(auto it = m_actor_proxies.begin(); it != m_actor_proxies.end();) {
+        if(m_proxy_actors[it->second] == NO_ACTOR) {
+            m_sweep_and_prune.remove(it->second);
+            it = m_actor_proxies.erase(it);
+        }
+        else {++it;}
+    }
+    m_sweep_and_prune.update();
+
+    m_candidate_pairs.clear();
+    for(const SweepAndPrune::Pair& pair : m_sweep_and_prune.get_pairs()) {
+        unsigned first = m_proxy_actors[pair.first];
+        unsigned second = m_proxy_actors[pair.second];
+        if(!m_actor_filters[first].accepts(m_actor_filters[second])) {continue;}
+        m_candidate_pairs.emplace_back(std::min(first, second), std::max(first, second));
     }
+    std::sort(m_candidate_pairs.begin(), m_candidate_pairs.end());
+    return m_candidate_pairs;
+}
+
+/// Select the broad phase of actor collisions, the state of the previous one gets dropped
+void LayerCollection::set_broad_phase(BroadPhase strategy) {
+    if(strategy == m_broad_phase) {return;}
+    m_broad_phase = strategy;
+    m_sweep_and_prune.clear();
+    m_actor_proxies.clear();
+    m_proxy_actors.clear();
 }
 
 /// Returns true if the given actor exists
@@ -222,6 +447,11 @@ bool LayerCollection::erase_actor(Actor* pointer) {
     return false;
 }
 
+/// Drop the actor from the state of the last collision check, called by object layers before erasing it
+void LayerCollection::forget_actor(Actor* actor) {
+    std::replace(m_frame_actors.begin(), m_frame_actors.end(), actor, static_cast<Actor*>(nullptr));
+}
+
 /// Erase the actor from object layer
 bool LayerCollection::erase_actor(std::string name) {
     for(ObjectLayer* l : get_object_layers()) {
@@ -261,12 +491,12 @@ void LayerCollection::mouse_collision() {
 
     // Check all hitboxes of each actor if they intersect with the mouse cursor
     for(Actor* a : actors) {
-        for(std::pair<std::string, Rect> hitbox : a->get_hitboxes()) {
-            PixelRect rect = hitbox.second;
+        for(const HitboxSet::Entry& hitbox : a->get_hitboxes()) {
+            PixelRect rect = hitbox.rect;
             if(rect.has_intersection(click)) {
                 // Trigger the OnMouse response
-                // a->respond(Response::on_mouse, Collision(hitbox.first));
-                a->add_collision(Collision(hitbox.first));
+                // a->respond(Response::on_mouse, Collision(hitbox.id));
+                a->add_collision(Collision(hitbox.id));
             }
         }
     }
@@ -279,23 +509,24 @@ void LayerCollection::mouse_collision() {
  * @param other_hitboxes A vector of hitbox names to check against collision
  * @return true if there is any collision and false if there is none
  */
-bool LayerCollection::check_collision(Rect rect, Collidees target, const std::vector<std::string>& other_hitboxes) {
+bool LayerCollection::check_collision(Rect rect, Collidees target, const std::vector<HitboxId>& other_hitboxes) {
     bool collided = false;
     if(target == Collidees::tile || target == Collidees::tile_and_actor) {
         for(MapLayer* map : get_map_layers()) {
-            for(TileInstance& tile : map->get_clip(rect)) {
-                for(std::string hitbox_name : other_hitboxes) {
-                    Rect other_rect = tile.get_hitbox(hitbox_name);
+            map->ensure_decoded(rect);
+            map->for_each_tile_collider(rect, [&](const TileCollider& tile) {
+                for(HitboxId hitbox_id : other_hitboxes) {
+                    Rect other_rect = tile.get_hitbox(hitbox_id);
                     if(rect.has_intersection(other_rect)) {collided = true;}
                 }
-            }
+            });
         }
     }
     if(target == Collidees::actor || target == Collidees::tile_and_actor) {
         for(ObjectLayer* obj : get_object_layers()) {
             for(Actor* actor : obj->get_clip(rect)) {
-                for(std::string hitbox_name : other_hitboxes) {
-                    Rect other_rect = actor->get_hitbox(hitbox_name);
+                for(HitboxId hitbox_id : other_hitboxes) {
+                    Rect other_rect = actor->get_hitbox(hitbox_id);
                     if(rect.has_intersection(other_rect)) {collided = true;}
                 }
             }
@@ -304,4 +535,76 @@ bool LayerCollection::check_collision(Rect rect, Collidees target, const std::ve
     return collided;
 }
 
+/**
+ * @brief Find the hitboxes of tiles and actors which the ray hits
+ * @param ray The ray in world coordinates
+ * @param target Determines if actors, or tiles, or both can be hit
+ * @param hitboxes The ids of the hitboxes which can be hit
+ * @param mask Only map layers and actors whose collision category shares a bit with the mask can be hit
+ * @param all If false only the closest hit gets returned
+ * @return The hits sorted by distance
+ *
+ * Tiles get hit as they are now. Actors get hit with their hitboxes of the last collision check,
+ * so their cells in the grid of the broad phase can be walked along the ray.
+ */
+std::vector<RaycastHit> LayerCollection::raycast(const Ray& ray, Collidees target, const std::vector<HitboxId>& hitboxes, Uint32 mask, bool all) {
+    std::vector<RaycastHit> hits;
+    if(!ray.valid()) {return hits;}
+
+    if(target == Collidees::tile || target == Collidees::tile_and_actor) {
+        for(MapLayer* map : get_map_layers()) {
+            if((map->get_collision_filter().category & mask) == 0) {continue;}
+            map->raycast(ray, hitboxes, all, hits);
+        }
+    }
+    if((target == Collidees::actor || target == Collidees::tile_and_actor) && !m_frame_actors.empty()) {
+        // The sweep and prune broad phase doesn't need the grid, so it gets built on the first raycast of a frame
+        if(m_spatial_hash_frame != m_collision_frame) {
+            m_spatial_hash.build(m_actor_bounds, m_actor_filters);
+            m_spatial_hash_frame = m_collision_frame;
+        }
+
+        // Actors registered in several cells get tested once, the stamps of the last query are reused
+        if(++m_ray_stamp == 0) {
+            std::fill(m_ray_stamps.begin(), m_ray_stamps.end(), 0);
+            m_ray_stamp = 1;
+        }
+        m_ray_stamps.resize(m_frame_actors.size(), 0);
+
+        float closest = ray.get_length();
+        for(const RaycastHit& hit : hits) {closest = std::min(closest, hit.distance);}
+        auto hit_actor = [&](unsigned index) {
+            if(m_ray_stamps[index] == m_ray_stamp) {return;}
+            m_ray_stamps[index] = m_ray_stamp;
+            if(m_frame_actors[index] == nullptr || (m_actor_filters[index].category & mask) == 0) {return;}
+            for(HitboxId hitbox_id : hitboxes) {
+                const Rect* hitbox = m_actor_hitboxes[index].find(hitbox_id);
+                RaycastHit hit;
+                if(hitbox == nullptr || !ray.intersect(*hitbox, hit.distance, hit.normal)) {continue;}
+                hit.point = ray.at(hit.distance);
+                hit.hitbox = hitbox_id;
+                hit.actor = m_frame_actors[index];
+                hits.push_back(hit);
+                closest = std::min(closest, hit.distance);
+            }
+        };
+
+        // Walk the cells in the order the ray passes them, later cells can't hold a closer hit
+        for(unsigned index : m_spatial_hash.get_oversized()) {hit_actor(index);}
+        float from, to;
+        if(ray.clip(m_spatial_hash.get_bounds(), from, to)) {
+            const float cell_size = m_spatial_hash.get_cell_size();
+            GridWalk walk(ray, Point{0,0}, cell_size, cell_size, from, to);
+            do {
+                if(!all && walk.get_enter() > closest) {break;}
+                m_spatial_hash.for_each_in_cell(walk.get_x(), walk.get_y(), hit_actor);
+            } while(walk.next());
+        }
+    }
+
+    std::stable_sort(hits.begin(), hits.end());
+    if(!all && hits.size() > 1) {hits.resize(1);}
+    return hits;
+}
+
 }} // namespace salmon::internal
@@ -21,9 +21,17 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include <tinyxml2.h>
 
+#include "util/element_tree.hpp"
 #include "util/game_types.hpp"
+#include "map/raycast.hpp"
+#include "map/spatial_hash.hpp"
+#include "map/sweep_and_prune.hpp"
+#include "actor/collision.hpp"
+#include "actor/collision_filter.hpp"
+#include "util/hitbox.hpp"
 
 namespace salmon {
 
@@ -37,6 +45,7 @@ class MapData;
 class MapLayer;
 class ObjectLayer;
 class ImageLayer;
+class ThreadPool;
 
 /**
  * @brief Container for all possible map layers. Inits, updates, draws and deletes layers.
@@ -45,7 +54,7 @@ class LayerCollection {
     public:
         LayerCollection() = default;
 
-        tinyxml2::XMLError init(tinyxml2::XMLElement* source, MapData& base_map);
+        tinyxml2::XMLError init(const Element* source, MapData& base_map, ThreadPool& pool);
 
         bool render(const Camera& camera) const;
         void update();
@@ -56,8 +65,10 @@ class LayerCollection {
         bool check_actor(const Actor* actor);
         bool erase_actor(std::string name);
         bool erase_actor(Actor* pointer);
+        void forget_actor(Actor* actor);
 
-        bool check_collision(Rect rect, Collidees target, const std::vector<std::string>& other_hitboxes);
+        bool check_collision(Rect rect, Collidees target, const std::vector<HitboxId>& other_hitboxes);
+        std::vector<RaycastHit> raycast(const Ray& ray, Collidees target, const std::vector<HitboxId>& hitboxes, Uint32 mask, bool all);
 
         std::vector<MapLayer*> get_map_layers();
         std::vector<ImageLayer*> get_image_layers();
@@ -65,6 +76,12 @@ class LayerCollection {
 
         Layer* get_layer(std::string name);
 
+        void set_broad_phase(BroadPhase strategy);
+        BroadPhase get_broad_phase() const {return m_broad_phase;}
+        /// Replay the tile collisions of actors while neither they nor the map layers change, on by default
+        void set_tile_cache(bool enabled) {m_tile_cache = enabled;}
+        bool get_tile_cache() const {return m_tile_cache;}
+
         MapData& get_base_map() {return *m_base_map;}
 
         // Don't allow copy construction and assignment because our destructor would delete twice!
@@ -77,9 +94,67 @@ class LayerCollection {
     private:
         void mouse_collision();
         void collision_check();
+        const std::vector<std::pair<unsigned, unsigned>>& sweep_and_prune(const std::vector<Actor*>& actors);
+        bool update_tile_state(std::vector<MapLayer*>& map_layers);
+        void run_narrow_phase(const std::vector<Actor*>& actors, const std::vector<std::pair<unsigned, unsigned>>& pairs);
 
         MapData* m_base_map;
         std::vector<std::unique_ptr<Layer>> m_layers;
+
+        // Broad phase state, kept to reuse its buffers each frame
+        BroadPhase m_broad_phase = BroadPhase::grid;
+        SpatialHash m_spatial_hash;
+        SweepAndPrune m_sweep_and_prune;
+        std::unordered_map<const Actor*, unsigned> m_actor_proxies; ///< Handle of each actor in m_sweep_and_prune
+        std::vector<unsigned> m_proxy_actors; ///< Index of the actor of each handle in the current frame
+        std::vector<std::pair<unsigned, unsigned>> m_candidate_pairs;
+        std::vector<HitboxSet> m_actor_hitboxes;
+        std::vector<Rect> m_actor_bounds;
+        std::vector<CollisionFilter> m_actor_filters;
+
+        /// Tile collisions of an actor which get replayed while neither it nor the map layers change
+        struct ContactCache {
+            unsigned frame = 0; ///< Last frame the actor got checked in
+            unsigned actor_id = 0;
+            HitboxSet hitboxes;
+            Rect tile_bounds;
+            CollisionFilter filter;
+            std::vector<Collision> tile_contacts;
+            bool tiles_valid = false; ///< False if the tile contacts may change on their own, e.g. by animated tiles
+        };
+        /// The state of a map layer which tile contacts depend on
+        struct TileState {
+            const MapLayer* layer = nullptr;
+            unsigned revision = 0;
+            Point offset;
+            CollisionFilter filter;
+        };
+        /// A collision of a candidate pair found by the narrow phase, see collide_pairs()
+        struct PairContact {
+            unsigned first;
+            unsigned second;
+            HitboxId first_hitbox;
+            HitboxId second_hitbox;
+        };
+        /// Scratch buffer of one narrow phase task
+        struct NarrowPhaseBuffer {
+            std::vector<PairContact> contacts;
+        };
+        void collide_pairs(const std::vector<std::pair<unsigned, unsigned>>& pairs, size_t begin, size_t end, NarrowPhaseBuffer& buffer) const;
+
+        static constexpr size_t MIN_TASK_PAIRS = 1024; ///< Fewer pairs aren't worth handing to another thread
+
+        unsigned m_collision_frame = 0;
+        std::vector<Actor*> m_frame_actors; ///< The actors of the last collision check, nullptr once erased
+        unsigned m_spatial_hash_frame = 0;  ///< The collision frame which m_spatial_hash got built for
+        std::vector<unsigned> m_ray_stamps; ///< Per actor of the last frame, equals m_ray_stamp once raycast() tested it
+        unsigned m_ray_stamp = 0;
+        std::unordered_map<const Actor*, ContactCache> m_contact_cache;
+        std::vector<ContactCache*> m_actor_caches; ///< Cache of each actor in the current frame
+        std::vector<bool> m_actor_unchanged;        ///< True if the actor didn't change since the last frame
+        std::vector<NarrowPhaseBuffer> m_narrow_phase_buffers; ///< One per task, merged in order
+        std::vector<TileState> m_tile_state;
+        bool m_tile_cache = true;
 };
 }} // namespace salmon::internal
 
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/map_cooker.hpp"
+
+#include "util/logger.hpp"
+
+namespace salmon { namespace internal {
+
+/// Cooks the map at the given path into a cooked map next to it
+tinyxml2::XMLError MapCooker::cook(std::string map_path) {
+    return cook(map_path, map_path + CookedMap::EXTENSION);
+}
+
+/**
+ * @brief Cooks a .tmx file
+ * @param map_path The path of the .tmx file
+ * @param cooked_path The path of the resulting cooked map, which is only found by the engine next to the .tmx file
+ * @return @c XMLError which indicates success or failure
+ */
+tinyxml2::XMLError MapCooker::cook(std::string map_path, std::string cooked_path) {
+    using namespace tinyxml2;
+    XMLError eResult;
+
+    std::string base_path = map_path;
+    base_path.erase(base_path.find_last_of('/') + 1);
+
+    // Stat the sources before reading them, so changes while cooking make the cooked map outdated
+    std::vector<CookedMap::Source> sources(1);
+    if(!CookedMap::stat_source(base_path, map_path.substr(base_path.size()), sources[0])) {
+        Logger(Logger::error) << "Can't find file at: " << map_path;
+        return XML_ERROR_FILE_NOT_FOUND;
+    }
+
+    XMLDocument mapfile{true, COLLAPSE_WHITESPACE};
+    eResult = mapfile.LoadFile(map_path.c_str());
+    if(eResult != XML_SUCCESS) {
+        Logger(Logger::error) << "Failed loading map file: " << map_path;
+        return eResult;
+    }
+    XMLElement* pMap = mapfile.FirstChildElement("map");
+    if(pMap == nullptr) {
+        Logger(Logger::error) << "Missing base node \"map\" inside .tmx file!";
+        return XML_ERROR_PARSING_ELEMENT;
+    }
+
+    // Inline the external tilesets, they keep their source attribute for resolving relative paths
+    for(XMLElement* pTs = pMap->FirstChildElement("tileset"); pTs != nullptr; pTs = pTs->NextSiblingElement("tileset")) {
+        const char* p_source = pTs->Attribute("source");
+        if(p_source == nullptr) {continue;}
+
+        CookedMap::Source source;
+        if(!CookedMap::stat_source(base_path, p_source, source)) {
+            Logger(Logger::error) << "Can't find tileset at: " << base_path + p_source;
+            return XML_ERROR_FILE_NOT_FOUND;
+        }
+        XMLDocument tsx{true, COLLAPSE_WHITESPACE};
+        eResult = tsx.LoadFile((base_path + p_source).c_str());
+        if(eResult != XML_SUCCESS) {
+            Logger(Logger::error) << "Failed loading tileset file: " << base_path + p_source;
+            return eResult;
+        }
+        XMLElement* p_tileset = tsx.FirstChildElement("tileset");
+        if(p_tileset == nullptr) {
+            Logger(Logger::error) << "Missing base node \"tileset\" inside .tsx file: " << base_path + p_source;
+            return XML_ERROR_PARSING_ELEMENT;
+        }
+        pTs->InsertEndChild(p_tileset->DeepClone(&mapfile));
+        sources.push_back(source);
+    }
+
+    // Replace the tile data of the map layers by blocks of decoded tile ids
+    std::vector<std::vector<Uint32>> blocks;
+    for(XMLElement* pLa = pMap->FirstChildElement("layer"); pLa != nullptr; pLa = pLa->NextSiblingElement("layer")) {
+        const char* p_name = pLa->Attribute("name");
+        std::string name = p_name ? p_name : "";
+
+        XMLElement* p_data = pLa->FirstChildElement("data");
+        if(p_data == nullptr) {
+            Logger(Logger::error) << "Map layer " << name << " has no data";
+            return XML_ERROR_PARSING_ELEMENT;
+        }
+
+        MapLayer::Encoding encoding;
+        MapLayer::Compression compression;
+        eResult = MapLayer::parse_encoding(p_data->Attribute("encoding"), p_data->Attribute("compression"), encoding, compression);
+        if(eResult == XML_SUCCESS && encoding == MapLayer::Encoding::cooked) {
+            eResult = XML_ERROR_PARSING_ATTRIBUTE;
+        }
+        if(eResult != XML_SUCCESS) {
+            Logger(Logger::error) << "Unsupported data format in map layer " << name;
+            return eResult;
+        }
+
+        if(p_data->FirstChildElement("chunk") != nullptr) {
+            for(XMLElement* p_chunk = p_data->FirstChildElement("chunk"); p_chunk != nullptr; p_chunk = p_chunk->NextSiblingElement("chunk")) {
+                unsigned w, h;
+                if(p_chunk->QueryUnsignedAttribute("width", &w) != XML_SUCCESS ||
+                   p_chunk->QueryUnsignedAttribute("height", &h) != XML_SUCCESS) {
+                    Logger(Logger::error) << "Chunk of map layer " << name << " lacks its dimensions";
+                    return XML_ERROR_PARSING_ATTRIBUTE;
+                }
+                if(w == 0 || h == 0) {continue;}
+                eResult = cook_tiles(p_chunk, w, h, encoding, compression, blocks);
+                if(eResult != XML_SUCCESS) {
+                    Logger(Logger::error) << "Failed cooking chunk of map layer " << name;
+                    return eResult;
+                }
+            }
+        }
+        else {
+            unsigned w, h;
+            if(pLa->QueryUnsignedAttribute("width", &w) != XML_SUCCESS ||
+               pLa->QueryUnsignedAttribute("height", &h) != XML_SUCCESS) {
+                Logger(Logger::error) << "Map layer " << name << " lacks its dimensions";
+                return XML_ERROR_PARSING_ATTRIBUTE;
+            }
+            eResult = cook_tiles(p_data, w, h, encoding, compression, blocks);
+            if(eResult != XML_SUCCESS) {
+                Logger(Logger::error) << "Failed cooking map layer " << name;
+                return eResult;
+            }
+        }
+
+        p_data->SetAttribute("encoding", "cooked");
+        p_data->DeleteAttribute("compression");
+    }
+
+    ElementTree elements;
+    elements.parse(pMap);
+    if(!CookedMap::write(cooked_path, sources, elements, blocks)) {
+        return XML_ERROR_FILE_COULD_NOT_BE_OPENED;
+    }
+    return XML_SUCCESS;
+}
+
+/**
+ * @brief Decodes the tile data of an element into a new block and references it from the element
+ * @param source The element holding the tile data, either a chunk or the data element of a layer
+ * @param w, h The dimensions of the tile data measured in tiles
+ * @param encoding, compression The format of the tile data
+ * @param blocks The blocks of the cooked map
+ * @return @c XMLError which indicates success or failure
+ */
+tinyxml2::XMLError MapCooker::cook_tiles(tinyxml2::XMLElement* source, unsigned w, unsigned h, MapLayer::Encoding encoding,
+                                         MapLayer::Compression compression, std::vector<std::vector<Uint32>>& blocks) {
+    std::vector<Uint32> tiles(static_cast<size_t>(w) * h);
+    tinyxml2::XMLError eResult = MapLayer::decode_data(source->GetText(), encoding, compression, w, tiles);
+    if(eResult != tinyxml2::XML_SUCCESS) {return eResult;}
+
+    source->DeleteChildren();
+    source->SetAttribute("block", static_cast<unsigned>(blocks.size()));
+    blocks.push_back(std::move(tiles));
+    return tinyxml2::XML_SUCCESS;
+}
+
+}} // namespace salmon::internal
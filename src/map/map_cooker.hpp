@@ -0,0 +1,48 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MAP_COOKER_HPP_INCLUDED
+#define MAP_COOKER_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <tinyxml2.h>
+
+#include "map/cooked_map.hpp"
+#include "map/map_layer.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Creates cooked maps from .tmx files, see CookedMap
+ *
+ * Cooking only works on the map elements and tile data, so it needs neither a window nor a renderer.
+ */
+class MapCooker {
+    public:
+        static tinyxml2::XMLError cook(std::string map_path);
+        static tinyxml2::XMLError cook(std::string map_path, std::string cooked_path);
+
+    private:
+        static tinyxml2::XMLError cook_tiles(tinyxml2::XMLElement* source, unsigned w, unsigned h, MapLayer::Encoding encoding,
+                                             MapLayer::Compression compression, std::vector<std::vector<Uint32>>& blocks);
+};
+
+}} // namespace salmon::internal
+
+#endif // MAP_COOKER_HPP_INCLUDED
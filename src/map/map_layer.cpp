@@ -19,38 +19,52 @@
 #include "map/map_layer.hpp"
 
 #include <algorithm>
+#include <climits>
+#include <cstring>
 #include <iostream>
 #include <math.h>
-#include <sstream>
 #include <zlib.h>
-#include <b64/decode.h>
+#ifdef SALMON_ZSTD
+#include <zstd.h>
+#endif
 
 #include "transform.hpp"
+#include "map/cooked_map.hpp"
 #include "map/mapdata.hpp"
 #include "map/layer_collection.hpp"
 #include "map/tile.hpp"
+#include "map/tile_flip.hpp"
 #include "map/tileset_collection.hpp"
+#include "util/base64.hpp"
 #include "util/game_types.hpp"
 #include "util/logger.hpp"
+#include "util/parse.hpp"
 
 namespace salmon { namespace internal {
 
+namespace {
+    inline bool is_digit(char c) {return static_cast<unsigned char>(c - '0') < 10;}
+    inline bool is_csv_space(char c) {return c == ' ' || c == '\n' || c == '\r' || c == '\t';}
+}
+
 /// Factory function which retrieves a pointer owning the map layer
-MapLayer* MapLayer::parse(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) {
+MapLayer* MapLayer::parse(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) {
     return new MapLayer(source, name, layer_collection, eresult);
 }
 
 /// Constructor which only may be used internally
-MapLayer::MapLayer(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) : Layer(name, layer_collection) {
+MapLayer::MapLayer(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) : Layer(name, layer_collection) {
     eresult = init(source);
 }
 
 /**
  * @brief Initialize the layer by parsing info from source
- * @param source The @c XMLElement from which information is parsed
+ * @param source The @c Element from which information is parsed
  * @return @c XMLError which indicates failure or sucess of parsing
+ *
+ * The tile data itself gets decoded afterwards by load_data()
  */
-tinyxml2::XMLError MapLayer::init(tinyxml2::XMLElement* source) {
+tinyxml2::XMLError MapLayer::init(const Element* source) {
     using namespace tinyxml2;
     XMLError eResult;
 
@@ -70,401 +84,842 @@ tinyxml2::XMLError MapLayer::init(tinyxml2::XMLElement* source) {
     if(eResult != XML_SUCCESS) offsety = 0;
 
     m_transform.set_pos(offsetx,offsety);
+
+    eResult = parse_properties(source);
+    if(eResult != XML_SUCCESS) return eResult;
+
     // Parse actual map data
-    XMLElement* p_data = source->FirstChildElement("data");
+    const Element* p_data = source->FirstChildElement("data");
     if(p_data == nullptr) return XML_ERROR_PARSING_ELEMENT;
 
-    // Check encoding of data
-    const char* p_encoding = p_data->Attribute("encoding");
+    eResult = parse_encoding(p_data->Attribute("encoding"), p_data->Attribute("compression"), m_encoding, m_compression);
+    if(eResult != XML_SUCCESS) {
+        Logger(Logger::error) << "Unsupported data format in map layer " << m_name;
+        return eResult;
+    }
+
+    mp_data = p_data;
 
-    if(std::string("base64") == p_encoding) {
+    return XML_SUCCESS;
+}
+
+/**
+ * @brief Decode the tile data of the layer
+ * @return @c XMLError which indicates failure or sucess of decoding
+ *
+ * This only touches the layer itself and its own elements, so the layers of a map may
+ * be loaded concurrently on worker threads. The elements of the map must outlive the call.
+ */
+tinyxml2::XMLError MapLayer::load_data() {
+    using namespace tinyxml2;
+    XMLError eResult;
 
-        // Store raw map data
-        std::string raw_map(p_data->GetText());
-        // Decode the raw map data
-        base64::decoder dec;
-        std::stringstream is(raw_map);
-        std::stringstream os;
-        dec.decode(is, os);
-        const std::string& tmp = os.str();
+    const Element* p_data = mp_data;
+    if(p_data == nullptr) return XML_ERROR_PARSING_ELEMENT;
+    mp_data = nullptr;
 
-        std::vector<Uint8> bytes(tmp.begin(), tmp.end());
+    // Infinite maps store their tiles in chunks
+    if(p_data->FirstChildElement("chunk") != nullptr) {
+        eResult = parse_chunks(p_data);
+        if(eResult != XML_SUCCESS) return eResult;
+    }
+    else {
+        // Clear map from old data
+        m_grid.resize(m_width, m_height);
+        eResult = decode_tiles(p_data, 0, 0, m_width, m_height);
+        if(eResult != XML_SUCCESS) return eResult;
+    }
 
-        const char* p_compression = p_data->Attribute("compression");
-        if(p_compression == nullptr) {;} // Skip decompress altogether
-        else if(std::string("zlib") == p_compression) {
-            uLongf decomp_size = m_height * m_width * 4;
-            std::vector<Uint8> decomp_bytes(decomp_size);
+    m_grid.optimize();
+    // The density of chunks which aren't decoded yet is unknown
+    if(!m_pending.empty()) {
+        m_grid.set_sparse(true);
+    }
 
-            int result = uncompress(decomp_bytes.data(), &decomp_size, bytes.data(), bytes.size());
-            if(result != Z_OK) {
-                Logger(Logger::error) << "Failed decompressing zlip map data! Error code: " << result;
-                return XML_ERROR_PARSING_TEXT;
-            }
-            bytes = decomp_bytes;
+    if(m_cache) {
+        if(m_layer_collection->get_base_map().get_tile_layout().orientation == MapData::Orientation::orthogonal) {
+            m_chunk_cache.resize(m_grid.get_chunks_w() * m_grid.get_chunks_h());
         }
-
         else {
-            Logger(Logger::error) << "Unsupported compression " << p_compression << " for base64 encoded map";
-            return XML_WRONG_ATTRIBUTE_TYPE;
+            Logger(Logger::warning) << "Map layer " << m_name << " can only be cached for orthogonal maps";
         }
+    }
 
-        // Clear map from old data
-        m_map_grid.resize(m_height);
-
-        unsigned counter = 0; ///< This stores the currently read byte
-
-        // Reassemble each tile id from 4 bytes and store in the 2d vector
-        for(unsigned i_y = 0; i_y < m_height; i_y++) {
-            for(unsigned i_x = 0; i_x < m_width; i_x++) {
-                Uint32 tile_id = 0;
-                Uint8 byte = bytes[counter];
-                tile_id += byte;
-                byte = bytes[counter + 1];
-                tile_id += byte * 256;
-                byte = bytes[counter + 2];
-                tile_id += byte * 256 * 256;
-                byte = bytes[counter + 3];
-                tile_id += byte * 256 * 256 * 256;
-                counter += 4;
-                m_map_grid[i_y].push_back(tile_id);
-            }
+    return XML_SUCCESS;
+}
+
+/**
+ * @brief Parse the chunks of an infinite map layer
+ * @param p_data The @c Element holding the chunks
+ * @return @c XMLError which indicates failure or sucess of parsing
+ *
+ * The grid gets sized to the bounding box of all chunks. Its origin is aligned
+ * to whole grid chunks, which also keeps the stagger parity of the tiles.
+ * Compressed chunks are only decoded from base64 and stay compressed until they
+ * get accessed for the first time, see decode_chunk().
+ */
+tinyxml2::XMLError MapLayer::parse_chunks(const Element* p_data) {
+    using namespace tinyxml2;
+
+    // Determine the bounds of all chunks
+    int x_min = INT_MAX;
+    int y_min = INT_MAX;
+    int x_max = INT_MIN;
+    int y_max = INT_MIN;
+    for(const Element* p_chunk = p_data->FirstChildElement("chunk"); p_chunk != nullptr; p_chunk = p_chunk->NextSiblingElement("chunk")) {
+        int x, y;
+        unsigned w, h;
+        if(p_chunk->QueryIntAttribute("x", &x) != XML_SUCCESS ||
+           p_chunk->QueryIntAttribute("y", &y) != XML_SUCCESS ||
+           p_chunk->QueryUnsignedAttribute("width", &w) != XML_SUCCESS ||
+           p_chunk->QueryUnsignedAttribute("height", &h) != XML_SUCCESS) {
+            Logger(Logger::error) << "Chunk of map layer " << m_name << " lacks its position or dimensions";
+            return XML_ERROR_PARSING_ATTRIBUTE;
         }
+        x_min = std::min(x_min, x);
+        y_min = std::min(y_min, y);
+        x_max = std::max(x_max, x + static_cast<int>(w));
+        y_max = std::max(y_max, y + static_cast<int>(h));
     }
 
-    else if(std::string("csv") == p_encoding) {
-        std::stringstream ss(p_data->GetText());
-        // Clear map from old data
-        m_map_grid.resize(m_height);
-        for(unsigned i_y = 0; i_y < m_height; i_y++) {
-            for(unsigned i_x = 0; i_x < m_width; i_x++) {
-                if(ss.good()){
-                    std::string tile_id_str;
-                    getline( ss, tile_id_str, ',' );
-                    Uint32 tile_id = static_cast<Uint32>(std::stoul(tile_id_str));
-                    m_map_grid[i_y].push_back(tile_id);
-                }
-                else {
-                    Logger(Logger::error) << "Tile ids ended prematurely at x: " << i_x << " y: " << i_y;
-                    return XML_ERROR_PARSING_TEXT;
-                }
+    const int chunk_size = static_cast<int>(TileGrid::CHUNK_SIZE);
+    m_origin_x = (x_min >= 0 ? x_min : x_min - chunk_size + 1) / chunk_size * chunk_size;
+    m_origin_y = (y_min >= 0 ? y_min : y_min - chunk_size + 1) / chunk_size * chunk_size;
+    m_width = x_max - m_origin_x;
+    m_height = y_max - m_origin_y;
+    m_grid.resize(m_width, m_height);
+
+    for(const Element* p_chunk = p_data->FirstChildElement("chunk"); p_chunk != nullptr; p_chunk = p_chunk->NextSiblingElement("chunk")) {
+        int x = p_chunk->IntAttribute("x") - m_origin_x;
+        int y = p_chunk->IntAttribute("y") - m_origin_y;
+        unsigned w = p_chunk->UnsignedAttribute("width");
+        unsigned h = p_chunk->UnsignedAttribute("height");
+        if(w == 0 || h == 0) {continue;}
+
+        if(m_compression == Compression::none) {
+            XMLError eResult = decode_tiles(p_chunk, x, y, w, h);
+            if(eResult != XML_SUCCESS) return eResult;
+            continue;
+        }
+
+        // Defer the decompression until the chunk gets accessed
+        PendingChunk pending;
+        pending.x = x;
+        pending.y = y;
+        pending.w = w;
+        pending.h = h;
+        if(!base64::decode(p_chunk->GetText(), pending.bytes)) {
+            Logger(Logger::error) << "Missing or invalid tile data in chunk at x: " << x + m_origin_x << " y: " << y + m_origin_y;
+            return XML_ERROR_PARSING_TEXT;
+        }
+
+        const unsigned index = m_pending.size();
+        m_pending.push_back(std::move(pending));
+        for(unsigned i_y = y >> TileGrid::CHUNK_SHIFT; i_y <= (y + h - 1) >> TileGrid::CHUNK_SHIFT; i_y++) {
+            for(unsigned i_x = x >> TileGrid::CHUNK_SHIFT; i_x <= (x + w - 1) >> TileGrid::CHUNK_SHIFT; i_x++) {
+                m_pending_chunks[i_y * m_grid.get_chunks_w() + i_x].push_back(index);
             }
         }
     }
+    return XML_SUCCESS;
+}
+
+/**
+ * @brief Parse the encoding and compression of map layer data
+ * @param p_encoding, p_compression The attributes "encoding" and "compression" of the layer data, may be @c nullptr
+ * @param encoding Returns the encoding of the data
+ * @param compression Returns the compression of the data
+ * @return @c XMLError which indicates failure or sucess of parsing
+ */
+tinyxml2::XMLError MapLayer::parse_encoding(const char* p_encoding, const char* p_compression, Encoding& encoding, Compression& compression) {
+    using namespace tinyxml2;
 
+    if(p_encoding != nullptr && std::string("base64") == p_encoding) {encoding = Encoding::base64;}
+    else if(p_encoding != nullptr && std::string("csv") == p_encoding) {encoding = Encoding::csv;}
+    else if(p_encoding != nullptr && std::string("cooked") == p_encoding) {encoding = Encoding::cooked;}
     else {
-        Logger(Logger::error) << "Encoding type: " << p_encoding << " is not supported !";
+        Logger(Logger::error) << "Encoding type: " << (p_encoding ? p_encoding : "xml") << " is not supported !";
         return XML_ERROR_PARSING_ATTRIBUTE;
     }
 
+    if(p_compression == nullptr) {compression = Compression::none;}
+    else if(encoding != Encoding::base64) {
+        Logger(Logger::error) << "Compression " << p_compression << " requires base64 encoding";
+        return XML_WRONG_ATTRIBUTE_TYPE;
+    }
+    else if(std::string("zlib") == p_compression) {compression = Compression::zlib;}
+    else if(std::string("gzip") == p_compression) {compression = Compression::gzip;}
+    else if(std::string("zstd") == p_compression) {
+        #ifdef SALMON_ZSTD
+            compression = Compression::zstd;
+        #else
+            Logger(Logger::error) << "Map data uses zstd compression, but the engine was built without zstd support";
+            return XML_WRONG_ATTRIBUTE_TYPE;
+        #endif
+    }
+    else {
+        Logger(Logger::error) << "Unsupported compression " << p_compression << " for base64 encoded map";
+        return XML_WRONG_ATTRIBUTE_TYPE;
+    }
     return XML_SUCCESS;
 }
 
 /**
- * @brief Renders the map layer to screen according to camera
- * @param camera Our active camera
- * @return @c bool which indicates sucess
+ * @brief Decodes tile data
+ * @param text The tile data
+ * @param encoding, compression The format of @p text, cooked data has no text
+ * @param width The width of the decoded rect measured in tiles, used for error reports
+ * @param tiles Returns the row major tile ids, must be sized to the expected tile count
+ * @return @c XMLError which indicates failure or sucess of decoding
  */
-bool MapLayer::render(const Camera& camera) const {
-    if(m_hidden) {return true;}
-    bool success = true;
-    for(auto& t : clip(camera.get_transform().to_rect())) {
-        if(!m_ts_collection->render(std::get<0>(t),std::get<1>(t),std::get<2>(t))) {
-            success = false;
+tinyxml2::XMLError MapLayer::decode_data(const char* text, Encoding encoding, Compression compression, unsigned width, std::vector<Uint32>& tiles) {
+    using namespace tinyxml2;
+    if(text == nullptr || encoding == Encoding::cooked) {
+        Logger(Logger::error) << "Missing tile data";
+        return XML_ERROR_PARSING_TEXT;
+    }
+
+    if(encoding == Encoding::base64) {
+        if(compression != Compression::none) {
+            std::vector<Uint8> bytes;
+            if(!base64::decode(text, bytes)) {
+                Logger(Logger::error) << "Invalid base64 tile data";
+                return XML_ERROR_PARSING_TEXT;
+            }
+            return inflate_data(bytes, compression, tiles);
+        }
+
+        // Uncompressed data gets decoded straight into the tile buffer
+        size_t size = 0;
+        if(!base64::decode(text, std::strlen(text), reinterpret_cast<Uint8*>(tiles.data()), tiles.size() * 4, size)) {
+            Logger(Logger::error) << "Invalid base64 tile data or too many tiles";
+            return XML_ERROR_PARSING_TEXT;
         }
+        if(size != tiles.size() * 4) {
+            Logger(Logger::error) << "Tile data holds " << size / 4 << " tiles instead of " << tiles.size();
+            return XML_ERROR_PARSING_TEXT;
+        }
+        swap_tiles(tiles);
+        return XML_SUCCESS;
     }
-    return success;
+
+    // Scan the csv text in place
+    const char* p = text;
+    for(size_t i = 0; i < tiles.size(); i++) {
+        while(is_csv_space(*p)) {p++;}
+        if(*p == '\0') {
+            Logger(Logger::error) << "Tile ids ended prematurely at x: " << i % width << " y: " << i / width;
+            return XML_ERROR_PARSING_TEXT;
+        }
+        if(!is_digit(*p)) {
+            Logger(Logger::error) << "Invalid character '" << *p << "' in tile ids at x: " << i % width << " y: " << i / width;
+            return XML_ERROR_PARSING_TEXT;
+        }
+
+        Uint64 tile_id = 0;
+        do {
+            tile_id = tile_id * 10 + (*p - '0');
+            p++;
+        } while(is_digit(*p) && tile_id <= 0xFFFFFFFF);
+        if(tile_id > 0xFFFFFFFF) {
+            Logger(Logger::error) << "Tile id out of range at x: " << i % width << " y: " << i / width;
+            return XML_ERROR_PARSING_TEXT;
+        }
+        tiles[i] = static_cast<Uint32>(tile_id);
+
+        while(is_csv_space(*p)) {p++;}
+        if(*p == ',') {p++;}
+    }
+    return XML_SUCCESS;
 }
 
 /**
- * @brief Fetch and return all tiles which are possibly bounding with the given rect
- * @param A rect which is usually a camera or the bounding box of a collider
- * @return A vector of 3-tuples consisting of the tile id and xy-coords relative to the rect origin!
+ * @brief Decompresses base64 decoded tile data
+ * @param bytes The compressed tile ids
+ * @param compression The compression of @p bytes
+ * @param tiles Returns the row major tile ids, must be sized to the expected tile count
+ * @return @c XMLError which indicates failure or sucess of decoding
  */
-std::vector< std::tuple<Uint32, int, int> > MapLayer::clip(Rect rect) const {
-    const MapData::TileLayout layout = m_layer_collection->get_base_map().get_tile_layout();
-    std::vector< std::tuple<Uint32, int, int> > tiles;
-    if(layout.orientation == "orthogonal") {
-        tiles = clip_ortho(rect);
-    }
-    else if(layout.stagger_axis_y) {
-        tiles = clip_y_stagger(rect);
+tinyxml2::XMLError MapLayer::inflate_data(const std::vector<Uint8>& bytes, Compression compression, std::vector<Uint32>& tiles) {
+    using namespace tinyxml2;
+
+    // Decompress straight into the tile buffer
+    size_t decomp_size = 0;
+
+    if(compression == Compression::zlib || compression == Compression::gzip) {
+        z_stream stream = {};
+        stream.next_in = const_cast<Bytef*>(bytes.data());
+        stream.avail_in = bytes.size();
+        stream.next_out = reinterpret_cast<Bytef*>(tiles.data());
+        stream.avail_out = tiles.size() * 4;
+
+        // Adding 16 to the window bits expects a gzip instead of a zlib header, mislabeled data gets rejected
+        int result = inflateInit2(&stream, compression == Compression::gzip ? 15 + 16 : 15);
+        if(result == Z_OK) {
+            result = inflate(&stream, Z_FINISH);
+            decomp_size = stream.total_out;
+            inflateEnd(&stream);
+        }
+        if(result != Z_STREAM_END) {
+            Logger(Logger::error) << "Failed decompressing " << (compression == Compression::gzip ? "gzip" : "zlib")
+                                  << " map data! Error code: " << result;
+            return XML_ERROR_PARSING_TEXT;
+        }
     }
-    else {
-        tiles = clip_x_stagger(rect);
+    #ifdef SALMON_ZSTD
+    else if(compression == Compression::zstd) {
+        decomp_size = ZSTD_decompress(tiles.data(), tiles.size() * 4, bytes.data(), bytes.size());
+        if(ZSTD_isError(decomp_size)) {
+            Logger(Logger::error) << "Failed decompressing zstd map data! Error: " << ZSTD_getErrorName(decomp_size);
+            return XML_ERROR_PARSING_TEXT;
+        }
     }
-    if(layout.render_order == "left-up" || layout.render_order == "right-up") {
-        std::reverse(tiles.begin(), tiles.end());
+    #endif
+
+    if(decomp_size != tiles.size() * 4) {
+        Logger(Logger::error) << "Tile data holds " << decomp_size / 4 << " tiles instead of " << tiles.size();
+        return XML_ERROR_PARSING_TEXT;
     }
-    return tiles;
+    swap_tiles(tiles);
+    return XML_SUCCESS;
+}
+
+/// Converts tile ids read from a map file, which are little endian, to the native byte order
+void MapLayer::swap_tiles(std::vector<Uint32>& tiles) {
+    #if SDL_BYTEORDER == SDL_BIG_ENDIAN
+        for(Uint32& tile_id : tiles) {
+            tile_id = SDL_SwapLE32(tile_id);
+        }
+    #else
+        (void) tiles;
+    #endif
 }
 
 /**
- * @brief Fetch and return all tiles which are possibly bounding with the given rect
- * @param A rect which is usually the bounding box of a collider
- * @return A vector of TileInstance objects holding a pointer to the tile and xy-coords relative to the world origin!
+ * @brief Decodes tile data and stores it into a rect of the grid
+ * @param source The @c Element holding the tile data, a chunk or the data element itself
+ * @param x, y, w, h The rect of the grid which gets filled, measured in tiles
+ * @return @c XMLError which indicates failure or sucess of decoding
  */
-std::vector<TileInstance> MapLayer::get_clip(Rect rect) const {
-    std::vector< std::tuple<Uint32, int, int> > old = clip(rect);
-    std::vector<TileInstance> tiles;
-    // Get missing decimals back which were eliminated due to rounding when clipping
-    Point p = m_transform.get_relative(0,0);
-    float x_decimals = round(rect.x - p.x) - (rect.x - p.x);
-    float y_decimals = round(rect.y - p.y) - (rect.y - p.y);
-
-    const Uint32 FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
-    const Uint32 FLIPPED_VERTICALLY_FLAG   = 0x40000000;
-    const Uint32 FLIPPED_DIAGONALLY_FLAG   = 0x20000000;
-
-    for(std::tuple<Uint32, int, int> tile : old) {
-        Uint32 tile_id = std::get<0>(tile);
-        Tile* tile_p = m_ts_collection->get_tile(tile_id);
-
-        Transform trans = {x_decimals + std::get<1>(tile)+rect.x,
-                           y_decimals + std::get<2>(tile)+rect.y,
-                           static_cast<float>(tile_p->get_w()),
-                           static_cast<float>(tile_p->get_h()),
-                           0,0};
-        trans.set_rotation_center(0.5,0.5);
-        if(tile_id >= FLIPPED_DIAGONALLY_FLAG) {
-            // Read out flags
-            bool flipped_horizontally = (tile_id & FLIPPED_HORIZONTALLY_FLAG);
-            bool flipped_vertically = (tile_id & FLIPPED_VERTICALLY_FLAG);
-            bool flipped_diagonally = (tile_id & FLIPPED_DIAGONALLY_FLAG);
-            double angle = 0;
-            // This snippet was determined via trial and error
-            // I have no idea why this even works, but it does
-            if(flipped_diagonally) {
-                angle = 270;
-                if(flipped_horizontally == flipped_vertically) {
-                    angle = 90;
-                }
-                flipped_vertically = !flipped_vertically;
-            }
-            trans.set_h_flip(flipped_horizontally);
-            trans.set_v_flip(flipped_vertically);
-            trans.set_rotation(angle);
+tinyxml2::XMLError MapLayer::decode_tiles(const Element* source, unsigned x, unsigned y, unsigned w, unsigned h) {
+    using namespace tinyxml2;
+
+    // Cooked tiles are stored decoded in a block of the cooked map file
+    if(m_encoding == Encoding::cooked) {
+        const CookedMap* cooked = m_layer_collection->get_base_map().get_cooked_map();
+        unsigned block;
+        const Uint32* tiles = nullptr;
+        size_t count = 0;
+        if(cooked == nullptr || source->QueryUnsignedAttribute("block", &block) != XML_SUCCESS ||
+           !cooked->get_block(block, tiles, count) || count != static_cast<size_t>(w) * h) {
+            Logger(Logger::error) << "Missing or invalid cooked tile block in map layer " << m_name;
+            return XML_ERROR_PARSING_ATTRIBUTE;
         }
+        store_tiles(tiles, x, y, w, h);
+        return XML_SUCCESS;
+    }
 
-        tiles.push_back({tile_p,trans});
+    std::vector<Uint32> tiles(static_cast<size_t>(w) * h);
+    XMLError eResult = decode_data(source->GetText(), m_encoding, m_compression, w, tiles);
+    if(eResult != XML_SUCCESS) {
+        Logger(Logger::error) << "Failed decoding " << get_codec() << " tile data of map layer " << m_name;
+        return eResult;
     }
-    return tiles;
+    store_tiles(tiles.data(), x, y, w, h);
+    return XML_SUCCESS;
 }
 
 /**
- * @brief Generates a vector of tiles information for tiles possibly bounding with a rect
- * @param rect The rectangular space which the tiles are bounding with
- * @return A vector of TileId, x-coord(relative to recto origin), y-coord(relative to rect origin), tuples
+ * @brief Decompresses base64 decoded tile data and stores it into a rect of the grid
+ * @param bytes The tile ids compressed like stated by the layer
+ * @param x, y, w, h The rect of the grid which gets filled, measured in tiles
+ * @return @c XMLError which indicates failure or sucess of decoding
  */
-std::vector< std::tuple<Uint32, int, int> > MapLayer::clip_ortho(Rect rect) const {
-
-    const MapData::TileLayout layout = m_layer_collection->get_base_map().get_tile_layout();
-
-    int tile_w = static_cast<int>(m_ts_collection->get_tile_w());
-    int tile_h = static_cast<int>(m_ts_collection->get_tile_h());
-
-    int x_tile_from, x_tile_to, y_tile_from, y_tile_to, x_start, y_start;
-    calc_tile_range(rect, tile_w, tile_h, x_tile_from, x_tile_to, y_tile_from, y_tile_to, x_start, y_start);
+tinyxml2::XMLError MapLayer::inflate_tiles(const std::vector<Uint8>& bytes, unsigned x, unsigned y, unsigned w, unsigned h) {
+    std::vector<Uint32> tiles(static_cast<size_t>(w) * h);
+    tinyxml2::XMLError eResult = inflate_data(bytes, m_compression, tiles);
+    if(eResult != tinyxml2::XML_SUCCESS) {return eResult;}
+    store_tiles(tiles.data(), x, y, w, h);
+    return tinyxml2::XML_SUCCESS;
+}
 
-    std::vector< std::tuple<Uint32, int, int> > tiles;
-    tiles.reserve((y_tile_to - y_tile_from + 1) * (x_tile_to - x_tile_from + 1));
+/**
+ * @brief Stores row major tile ids into a rect of the grid
+ * @param tiles The tile ids in native byte order
+ * @param x, y, w, h The rect of the grid which gets filled, measured in tiles
+ */
+void MapLayer::store_tiles(const Uint32* tiles, unsigned x, unsigned y, unsigned w, unsigned h) {
+    for(unsigned i_y = 0; i_y < h; i_y++) {
+        m_grid.set_span(x, y + i_y, w, tiles + static_cast<size_t>(i_y) * w);
+    }
+}
 
-    int y = y_start;
-    // Iterates through vertical rows tile by tile
-    for(int i_y_tile = y_tile_from; i_y_tile <= y_tile_to; i_y_tile++) {
-        // Reset horizontal tile position
-        int x = x_start;
-        // Skips vertical rows if position is off map/layer
-        if(i_y_tile >= 0 && i_y_tile < static_cast<int>(m_height)) {
+/**
+ * @brief Decodes all pending chunks of an infinite map which overlap the given grid chunk
+ * @param chunk_x, chunk_y The grid chunk measured in chunks
+ */
+void MapLayer::decode_chunk(unsigned chunk_x, unsigned chunk_y) {
+    auto it = m_pending_chunks.find(chunk_y * m_grid.get_chunks_w() + chunk_x);
+    if(it == m_pending_chunks.end()) {return;}
+
+    for(unsigned index : it->second) {
+        PendingChunk& pending = m_pending[index];
+        // Chunks overlapping multiple grid chunks may already be decoded
+        if(pending.bytes.empty()) {continue;}
+        if(inflate_tiles(pending.bytes, pending.x, pending.y, pending.w, pending.h) != tinyxml2::XML_SUCCESS) {
+            Logger(Logger::error) << "Failed decoding chunk at x: " << pending.x + m_origin_x << " y: " << pending.y + m_origin_y
+                                  << " of map layer " << m_name;
+        }
+        std::vector<Uint8>().swap(pending.bytes);
+    }
+    m_pending_chunks.erase(it);
+}
 
-            std::vector< std::tuple<Uint32, int, int> > x_tiles;
-            x_tiles.reserve(x_tile_to - x_tile_from + 1);
+/// Decodes all pending chunks of an infinite map which are touched by the tile range
+void MapLayer::decode_range(const TileRange& r) {
+    if(m_pending_chunks.empty()) {return;}
+    const int x_lo = std::max(r.x_from, 0);
+    const int x_hi = std::min(r.x_to, static_cast<int>(m_width) - 1);
+    const int y_lo = std::max(r.y_from, 0);
+    const int y_hi = std::min(r.y_to, static_cast<int>(m_height) - 1);
+    if(x_lo > x_hi || y_lo > y_hi) {return;}
+
+    for(int i_y = y_lo >> TileGrid::CHUNK_SHIFT; i_y <= y_hi >> TileGrid::CHUNK_SHIFT; i_y++) {
+        for(int i_x = x_lo >> TileGrid::CHUNK_SHIFT; i_x <= x_hi >> TileGrid::CHUNK_SHIFT; i_x++) {
+            decode_chunk(i_x, i_y);
+        }
+    }
+}
 
-            // Iterates through horizontal rows tile by tile
-            for(int i_x_tile = x_tile_from; i_x_tile <= x_tile_to; i_x_tile++) {
+/**
+ * @brief Decodes all pending chunks of an infinite map which hold tiles possibly bounding with rect
+ * @param rect The rect which is going to be walked, e.g. by for_each_tile_collider()
+ */
+void MapLayer::ensure_decoded(Rect rect) {
+    if(m_pending_chunks.empty()) {return;}
+    decode_range(make_tile_range(rect));
+}
 
-                // Skips horizontal rows if position is off map/layer
-                if(i_x_tile >= 0 && i_x_tile < static_cast<int>(m_width)) {
+/**
+ * @brief Parse user specified properties of the map layer (CACHE and the collision filter)
+ * @param source The @c Element of the layer
+ * @return @c XMLError which indicates failure or sucess of parsing
+ */
+tinyxml2::XMLError MapLayer::parse_properties(const Element* source) {
+    using namespace tinyxml2;
+    XMLError eResult;
 
-                    // Get tile id from map layer data and draw at current position if tile_id is not 0
-                    Uint32 tile_id = m_map_grid[i_y_tile][i_x_tile];
-                    // Scrap empty tiles!
-                    if(tile_id != 0) {
-                        x_tiles.emplace_back(tile_id, x, y);
-                    }
+    const Element* p_properties = source->FirstChildElement("properties");
+    if(p_properties != nullptr) {
+        const Element* p_property = p_properties->FirstChildElement("property");
+        while(p_property != nullptr) {
+            const char* p_name;
+            p_name = p_property->Attribute("name");
+            if(p_name == nullptr) return XML_ERROR_PARSING_ATTRIBUTE;
+            std::string name(p_name);
+            if(name == "CACHE") {
+                eResult = p_property->QueryBoolAttribute("value", &m_cache);
+                if(eResult != XML_SUCCESS) {
+                    Logger(Logger::error) << "Failed parsing CACHE attribute of map layer " << m_name;
+                    return eResult;
                 }
-                // Move to next horizontal tile position
-                x += tile_w;
             }
-
-            if(layout.render_order == "left-down" || layout.render_order == "right-up") {
-                std::reverse(x_tiles.begin(), x_tiles.end());
+            else if(name == "COLLISION_CATEGORY") {
+                eResult = parse::collision_bits(p_property, m_collision_filter.category);
+                if(eResult != XML_SUCCESS) {
+                    Logger(Logger::error) << "Failed parsing COLLISION_CATEGORY attribute of map layer " << m_name;
+                    return eResult;
+                }
             }
-            tiles.insert(tiles.end(),x_tiles.begin(),x_tiles.end());
-
+            else if(name == "COLLISION_MASK") {
+                eResult = parse::collision_bits(p_property, m_collision_filter.mask);
+                if(eResult != XML_SUCCESS) {
+                    Logger(Logger::error) << "Failed parsing COLLISION_MASK attribute of map layer " << m_name;
+                    return eResult;
+                }
+            }
+            // Map layer properties used to be ignored, so don't fail on unknown ones
+            else {
+                Logger(Logger::warning) << "Unknown map layer property \"" << p_name << "\" specified";
+            }
+            p_property = p_property->NextSiblingElement("property");
         }
-        // Move to next vertical tile position
-        y += tile_h;
     }
-    return tiles;
+    return XML_SUCCESS;
 }
 
 /**
- * @brief Generates a vector of tiles information for tiles possibly bounding with a rect
- * @param rect The rectangular space which the tiles are bounding with
- * @return A vector of TileId, x-coord(relative to rect origin), y-coord(relative to rect origin), tuples
+ * @brief Renders the map layer to screen according to camera
+ * @param camera Our active camera
+ * @return @c bool which indicates sucess
  */
-std::vector< std::tuple<Uint32, int, int> > MapLayer::clip_y_stagger(Rect rect) const {
-
-    const MapData::TileLayout layout = m_layer_collection->get_base_map().get_tile_layout();
-
-    int tile_w = static_cast<int>(m_ts_collection->get_tile_w());
-    int tile_h = static_cast<int>(m_ts_collection->get_tile_h());
-
-    // Conform to y_stagger
-    tile_h /= 2;
-    tile_h += layout.hexsidelength / 2;
-
-    int x_tile_from, x_tile_to, y_tile_from, y_tile_to, x_start, y_start;
-    calc_tile_range(rect, tile_w, tile_h, x_tile_from, x_tile_to, y_tile_from, y_tile_to, x_start, y_start);
-
-    std::vector< std::tuple<Uint32, int, int> > tiles;
-    tiles.reserve((y_tile_to - y_tile_from + 1) * (x_tile_to - x_tile_from + 1));
-
-    int y = y_start;
-    // Iterates through vertical rows tile by tile
-    for(int i_y_tile = y_tile_from; i_y_tile <= y_tile_to; i_y_tile++) {
-        // Reset horizontal tile position
-        int x = x_start;
-        if((!layout.stagger_index_odd && i_y_tile % 2 == 0) || (layout.stagger_index_odd && i_y_tile % 2 != 0)) {
-            x = x_start + (tile_w / 2);
+bool MapLayer::render(const Camera& camera) const {
+    if(m_hidden) {return true;}
+    if(!m_chunk_cache.empty()) {return render_cached(camera);}
+    bool success = true;
+    for_each_visible_tile(camera.get_transform().to_rect(), [&](Uint32 tile_id, int x, int y) {
+        if(!m_ts_collection->render(tile_id, x, y)) {
+            success = false;
         }
+    });
+    return success;
+}
 
-        // Skips vertical rows if position is off map/layer
-        if(i_y_tile >= 0 && i_y_tile < static_cast<int>(m_height)) {
+/**
+ * @brief Renders the map layer chunk by chunk from pre rendered textures
+ * @param camera Our active camera
+ * @return @c bool which indicates sucess
+ *
+ * Chunks get baked lazily when they become visible. They are baked in layer
+ * coordinates, so moving the layer just shifts where they are drawn. Chunks
+ * holding animated tiles are drawn tile by tile.
+ *
+ * @note Oversized tiles which overlap a chunk border get drawn in chunk order
+ *       instead of strict tile order.
+ */
+bool MapLayer::render_cached(const Camera& camera) const {
+    SDL_Renderer* renderer = m_layer_collection->get_base_map().get_renderer();
+    if(!SDL_RenderTargetSupported(renderer)) {
+        Logger(Logger::warning) << "Render targets are unsupported, map layer " << m_name << " gets drawn without cache";
+        m_chunk_cache.clear();
+        return render(camera);
+    }
 
-            std::vector< std::tuple<Uint32, int, int> > x_tiles;
-            x_tiles.reserve(x_tile_to - x_tile_from + 1);
+    const TileRange view = make_tile_range(camera.get_transform().to_rect());
+    const int x_lo = std::max(view.x_from, 0);
+    const int x_hi = std::min(view.x_to, static_cast<int>(m_width) - 1);
+    const int y_lo = std::max(view.y_from, 0);
+    const int y_hi = std::min(view.y_to, static_cast<int>(m_height) - 1);
+    if(x_lo > x_hi || y_lo > y_hi) {return true;}
+
+    // Pixel position of the tile at index 0
+    const int x_origin = view.x_start - view.x_from * view.tile_w;
+    const int y_origin = view.y_start - view.y_from * view.tile_h;
+    const int chunk_w = TileGrid::CHUNK_SIZE * view.tile_w;
+    const int chunk_h = TileGrid::CHUNK_SIZE * view.tile_h;
+    // The overhang of the opposite side gives the padding of the chunk textures
+    const int pad_left = m_ts_collection->get_overhang(Direction::right);
+    const int pad_up = m_ts_collection->get_overhang(Direction::down);
+
+    const int cx_lo = x_lo >> TileGrid::CHUNK_SHIFT;
+    const int cx_hi = x_hi >> TileGrid::CHUNK_SHIFT;
+    const int cy_lo = y_lo >> TileGrid::CHUNK_SHIFT;
+    const int cy_hi = y_hi >> TileGrid::CHUNK_SHIFT;
 
-            // Iterates through horizontal rows tile by tile
-            for(int i_x_tile = x_tile_from; i_x_tile <= x_tile_to; i_x_tile++) {
+    bool success = true;
+    auto draw = [&](Uint32 tile_id, int x, int y) {
+        if(!m_ts_collection->render(tile_id, x, y)) {
+            success = false;
+        }
+    };
 
-                // Skips horizontal rows if position is off map/layer
-                if(i_x_tile >= 0 && i_x_tile < static_cast<int>(m_width)) {
+    for(int i_row = 0; i_row <= cy_hi - cy_lo; i_row++) {
+        const int chunk_y = view.reverse_y ? cy_hi - i_row : cy_lo + i_row;
+        for(int i_col = 0; i_col <= cx_hi - cx_lo; i_col++) {
+            const int chunk_x = view.reverse_x ? cx_hi - i_col : cx_lo + i_col;
+            const ChunkCache& chunk = m_chunk_cache[chunk_y * m_grid.get_chunks_w() + chunk_x];
 
-                    // Get tile id from map layer data and draw at current position if tile_id is not 0
-                    Uint32 tile_id = m_map_grid[i_y_tile][i_x_tile];
-                    // Scrap empty tiles!
-                    if(tile_id != 0) {
-                        x_tiles.emplace_back(tile_id, x, y);
-                    }
-                }
-                // Move to next horizontal tile position
-                x += tile_w;
+            if(chunk.dirty && !bake_chunk(chunk_x, chunk_y)) {
+                success = false;
             }
 
-            if(layout.render_order == "left-down" || layout.render_order == "right-up") {
-                std::reverse(x_tiles.begin(), x_tiles.end());
+            if(chunk.tiled) {
+                // Only walk the part of the chunk which is in view
+                TileRange range = make_chunk_range(chunk_x, chunk_y, x_origin, y_origin);
+                range.x_from = std::max(range.x_from, x_lo);
+                range.x_to = std::min(range.x_to, x_hi);
+                range.y_from = std::max(range.y_from, y_lo);
+                range.y_to = std::min(range.y_to, y_hi);
+                range.x_start = x_origin + range.x_from * range.tile_w;
+                range.y_start = y_origin + range.y_from * range.tile_h;
+                dispatch_render_order<TileRange::ortho>(range, draw);
+            }
+            else if(chunk.texture.valid()) {
+                chunk.texture.render(x_origin + chunk_x * chunk_w - pad_left, y_origin + chunk_y * chunk_h - pad_up);
             }
-            tiles.insert(tiles.end(),x_tiles.begin(),x_tiles.end());
-
         }
-        // Move to next vertical tile position
-        y += tile_h;
     }
-    return tiles;
+    return success;
 }
 
 /**
- * @brief Generates a vector of tiles information for tiles possibly bounding with a rect
- * @param rect The rectangular space which the tiles are bounding with
- * @return A vector of TileId, x-coord(relative to recto origin), y-coord(relative to rect origin), tuples
+ * @brief Renders all tiles of a chunk into its cache texture
+ * @param chunk_x, chunk_y The position of the chunk measured in chunks
+ * @return @c bool which indicates sucess
+ *
+ * Empty chunks get no texture and chunks holding animated tiles are marked to be drawn tile by tile.
  */
-std::vector< std::tuple<Uint32, int, int> > MapLayer::clip_x_stagger(Rect rect) const {
+bool MapLayer::bake_chunk(unsigned chunk_x, unsigned chunk_y) const {
+    ChunkCache& chunk = m_chunk_cache[chunk_y * m_grid.get_chunks_w() + chunk_x];
+    chunk.dirty = false;
+    chunk.tiled = false;
+
+    const unsigned x_from = chunk_x << TileGrid::CHUNK_SHIFT;
+    const unsigned y_from = chunk_y << TileGrid::CHUNK_SHIFT;
+    const unsigned x_to = std::min(x_from + TileGrid::CHUNK_SIZE, m_width);
+    const unsigned y_to = std::min(y_from + TileGrid::CHUNK_SIZE, m_height);
+
+    if(m_grid.is_chunk_empty(chunk_x, chunk_y)) {
+        chunk.texture.free();
+        return true;
+    }
+    for(unsigned i_y = y_from; i_y < y_to; i_y++) {
+        for(unsigned i_x = x_from; i_x < x_to; i_x++) {
+            Uint32 tile_id = m_grid.get(i_x, i_y);
+            if(tile_id == 0) {continue;}
+            Tile* tile = m_ts_collection->get_tile(tile_id);
+            if(tile != nullptr && tile->is_animated()) {
+                chunk.tiled = true;
+                chunk.texture.free();
+                return true;
+            }
+        }
+    }
 
-    const MapData::TileLayout layout = m_layer_collection->get_base_map().get_tile_layout();
+    const int tile_w = static_cast<int>(m_ts_collection->get_tile_w());
+    const int tile_h = static_cast<int>(m_ts_collection->get_tile_h());
+    const int pad_left = m_ts_collection->get_overhang(Direction::right);
+    const int pad_right = m_ts_collection->get_overhang(Direction::left);
+    const int pad_up = m_ts_collection->get_overhang(Direction::down);
+    const int pad_down = m_ts_collection->get_overhang(Direction::up);
+
+    SDL_Renderer* renderer = m_layer_collection->get_base_map().get_renderer();
+    if(!chunk.texture.valid()) {
+        int w = (x_to - x_from) * tile_w + pad_left + pad_right;
+        int h = (y_to - y_from) * tile_h + pad_up + pad_down;
+        if(!chunk.texture.create_target(renderer, w, h)) {
+            chunk.tiled = true;
+            return false;
+        }
+    }
 
-    int tile_w = static_cast<int>(m_ts_collection->get_tile_w());
-    int tile_h = static_cast<int>(m_ts_collection->get_tile_h());
+    SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+    if(SDL_SetRenderTarget(renderer, chunk.texture.get_sdl_texture()) != 0) {
+        Logger(Logger::error) << "Failed to bake chunk of map layer " << m_name << "! SDL Error: " << SDL_GetError();
+        chunk.texture.free();
+        chunk.tiled = true;
+        return false;
+    }
 
-    // Conform to x stagger
-    tile_w /= 2;
-    tile_w += layout.hexsidelength / 2;
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
 
-    int x_tile_from, x_tile_to, y_tile_from, y_tile_to, x_start, y_start;
-    calc_tile_range(rect, tile_w, tile_h, x_tile_from, x_tile_to, y_tile_from, y_tile_to, x_start, y_start);
+    bool success = true;
+    auto draw = [&](Uint32 tile_id, int x, int y) {
+        if(!m_ts_collection->render(tile_id, x, y)) {
+            success = false;
+        }
+    };
+    TileRange range = make_chunk_range(chunk_x, chunk_y,
+                                       pad_left - static_cast<int>(x_from) * tile_w,
+                                       pad_up - static_cast<int>(y_from) * tile_h);
+    dispatch_render_order<TileRange::ortho>(range, draw);
 
-    // Per row fetch every second tile
-    int x_step = tile_w * 2;
-    // Split each row into two
-    int y_step = tile_h / 2;
+    SDL_SetRenderTarget(renderer, previous_target);
+    return success;
+}
 
-    std::vector< std::tuple<Uint32, int, int> > tiles;
-    tiles.reserve((y_tile_to - y_tile_from + 1) * (x_tile_to - x_tile_from + 1));
+/**
+ * @brief Returns the tile range covering a whole chunk
+ * @param chunk_x, chunk_y The position of the chunk measured in chunks
+ * @param x_origin, y_origin The pixel position of the tile at index 0
+ */
+MapLayer::TileRange MapLayer::make_chunk_range(unsigned chunk_x, unsigned chunk_y, int x_origin, int y_origin) const {
+    const MapData::TileLayout& layout = m_layer_collection->get_base_map().get_tile_layout();
+
+    TileRange r;
+    r.mode = TileRange::ortho;
+    r.tile_w = static_cast<int>(m_ts_collection->get_tile_w());
+    r.tile_h = static_cast<int>(m_ts_collection->get_tile_h());
+    r.x_from = chunk_x << TileGrid::CHUNK_SHIFT;
+    r.y_from = chunk_y << TileGrid::CHUNK_SHIFT;
+    r.x_to = r.x_from + TileGrid::CHUNK_SIZE - 1;
+    r.y_to = r.y_from + TileGrid::CHUNK_SIZE - 1;
+    r.x_start = x_origin + r.x_from * r.tile_w;
+    r.y_start = y_origin + r.y_from * r.tile_h;
+    r.reverse_x = (layout.render_order == MapData::RenderOrder::left_down || layout.render_order == MapData::RenderOrder::left_up);
+    r.reverse_y = (layout.render_order == MapData::RenderOrder::left_up || layout.render_order == MapData::RenderOrder::right_up);
+    r.stagger_index_odd = layout.stagger_index_odd;
+    return r;
+}
 
-    // Determine if first half row starts odd or even
-    int odd_even = 0;
-    if((!layout.stagger_index_odd && x_tile_from % 2 == 0) || (layout.stagger_index_odd && x_tile_from % 2 != 0)) {
-        odd_even = 1;
+/// Returns the encoding and compression of the layer data like "base64+zlib" or "csv"
+std::string MapLayer::get_codec() const {
+    if(m_encoding == Encoding::csv) {return "csv";}
+    if(m_encoding == Encoding::cooked) {return "cooked";}
+    switch(m_compression) {
+        case Compression::none: return "base64";
+        case Compression::zlib: return "base64+zlib";
+        case Compression::gzip: return "base64+gzip";
+        case Compression::zstd: return "base64+zstd";
     }
+    return "base64";
+}
+
+/// Returns the tile id at the given tile position or 0 if it is off the layer
+Uint32 MapLayer::get_tile_id(unsigned x, unsigned y) {
+    if(x >= m_width || y >= m_height) {return 0;}
+    decode_chunk(x >> TileGrid::CHUNK_SHIFT, y >> TileGrid::CHUNK_SHIFT);
+    return m_grid.get(x, y);
+}
 
-    int y = y_start;
-    // Iterates through vertical rows tile by tile
-    for(int i_y_tile = y_tile_from; i_y_tile <= y_tile_to; i_y_tile++) {
-        // Skips vertical rows if position is off map/layer
-        if(i_y_tile >= 0 && i_y_tile < static_cast<int>(m_height)) {
-            // Fetch row in two passes for correct rendering order
-            for(int i_odd_even = 0; i_odd_even < 2; i_odd_even++) {
+/**
+ * @brief Changes the tile at the given tile position
+ * @param x, y The tile position
+ * @param tile_id The new global tile id including flip flags, 0 clears the tile
+ * @return @c bool which indicates if the position is on the layer
+ */
+bool MapLayer::set_tile_id(unsigned x, unsigned y, Uint32 tile_id) {
+    if(x >= m_width || y >= m_height) {
+        Logger(Logger::error) << "Tile position " << x << " " << y << " is off map layer " << m_name;
+        return false;
+    }
+    // Decode first, otherwise the pending chunk would overwrite the new tile later on
+    decode_chunk(x >> TileGrid::CHUNK_SHIFT, y >> TileGrid::CHUNK_SHIFT);
+    m_grid.set(x, y, tile_id);
+    m_revision++;
+    if(!m_chunk_cache.empty()) {
+        m_chunk_cache[(y >> TileGrid::CHUNK_SHIFT) * m_grid.get_chunks_w() + (x >> TileGrid::CHUNK_SHIFT)].dirty = true;
+    }
+    return true;
+}
 
-                std::vector< std::tuple<Uint32, int, int> > x_tiles;
-                x_tiles.reserve((x_tile_to - x_tile_from + 1) / 2);
+/// Marks all cached chunks to be baked again, e.g. after the renderer lost its target textures
+void MapLayer::invalidate_cache() {
+    for(ChunkCache& chunk : m_chunk_cache) {
+        chunk.dirty = true;
+    }
+}
 
-                // Reset horizontal tile position
-                int x = x_start;
-                int x_offset = (i_odd_even + odd_even) % 2;
-                x += x_offset * tile_w;
+/**
+ * @brief Fetch and return all tiles which are possibly bounding with the given rect
+ * @param A rect which is usually the bounding box of a collider
+ * @return A vector of TileInstance objects holding a pointer to the tile and xy-coords relative to the world origin!
+ *
+ * Prefer for_each_tile_instance() on hot paths, since this allocates the returned vector
+ */
+std::vector<TileInstance> MapLayer::get_clip(Rect rect) const {
+    std::vector<TileInstance> tiles;
+    for_each_tile_instance(rect, [&](TileInstance& tile) {
+        tiles.push_back(tile);
+    });
+    return tiles;
+}
 
-                // Iterates through horizontal rows tile by tile
-                for(int i_x_tile = x_tile_from + x_offset; i_x_tile <= x_tile_to; i_x_tile += 2) {
+/**
+ * @brief Find the tile hitboxes which the ray hits
+ * @param ray The ray in world coordinates
+ * @param hitboxes The ids of the hitboxes which can be hit
+ * @param all If false stop at the first cell along the ray which holds a hit
+ * @param hits Receives the hits, each hitbox at most once
+ *
+ * Walks the tile grid along the ray, see GridWalk. Oversized tiles reach into neighbouring
+ * cells, so each cell gets queried via for_each_tile_collider() and a hit only counts for the
+ * cell containing its entry point. Thus no hit is found twice and no later cell can hold a closer one.
+ */
+void MapLayer::raycast(const Ray& ray, const std::vector<HitboxId>& hitboxes, bool all, std::vector<RaycastHit>& hits) {
+    // Only the distance between neighbouring tiles is of interest, which is half a tile on staggered maps
+    const TileRange r = make_tile_range(Rect{0,0,0,0});
+    const float cell_w = static_cast<float>(r.tile_w);
+    const float cell_h = static_cast<float>(r.tile_h);
 
-                    // Skips horizontal rows if position is off map/layer
-                    if(i_x_tile >= 0 && i_x_tile < static_cast<int>(m_width)) {
+    Point p = m_transform.get_relative(0,0);
+    const Point grid_origin{p.x + m_origin_x * cell_w, p.y + m_origin_y * cell_h};
+
+    // Skip the part of the ray which can't reach any tile
+    const float pad = std::max({m_ts_collection->get_overhang(Direction::left), m_ts_collection->get_overhang(Direction::right),
+                                m_ts_collection->get_overhang(Direction::up), m_ts_collection->get_overhang(Direction::down),
+                                m_ts_collection->get_tile_w(), m_ts_collection->get_tile_h()});
+    const Rect bounds{grid_origin.x - pad, grid_origin.y - pad, m_width * cell_w + 2 * pad, m_height * cell_h + 2 * pad};
+    float from, to;
+    if(!ray.clip(bounds, from, to)) {return;}
+
+    GridWalk walk(ray, grid_origin, cell_w, cell_h, from, to);
+    do {
+        const Rect cell{grid_origin.x + walk.get_x() * cell_w, grid_origin.y + walk.get_y() * cell_h, cell_w, cell_h};
+        const float enter = walk.get_enter();
+        const float exit = walk.get_exit();
+        bool found = false;
+        ensure_decoded(cell);
+        for_each_tile_collider(cell, [&](const TileCollider& tile) {
+            for(HitboxId hitbox_id : hitboxes) {
+                RaycastHit hit;
+                if(!ray.intersect(tile.get_hitbox(hitbox_id), hit.distance, hit.normal)) {continue;}
+                if(hit.distance < enter || hit.distance >= exit) {continue;}
+                hit.point = ray.at(hit.distance);
+                hit.hitbox = hitbox_id;
+                hit.tile = tile;
+                hits.push_back(hit);
+                found = true;
+            }
+        });
+        if(found && !all) {break;}
+    } while(walk.next());
+}
 
-                        // Get tile id from map layer data and draw at current position if tile_id is not 0
-                        Uint32 tile_id = m_map_grid[i_y_tile][i_x_tile];
-                        // Scrap empty tiles!
-                        if(tile_id != 0) {
-                            x_tiles.emplace_back(tile_id, x, y);
-                        }
-                    }
-                    // Move to next horizontal tile position
-                    x += x_step;
-                }
+/**
+ * @brief Determines the range of tiles bounding with a rect and the order to walk them in
+ * @param rect The rectangular space which the tiles are bounding with
+ * @return The @c TileRange used by for_each_visible_tile()
+ */
+MapLayer::TileRange MapLayer::make_tile_range(Rect rect) const {
+    const MapData::TileLayout& layout = m_layer_collection->get_base_map().get_tile_layout();
 
-                if(layout.render_order == "left-down" || layout.render_order == "right-up") {
-                    std::reverse(x_tiles.begin(), x_tiles.end());
-                }
-                tiles.insert(tiles.end(),x_tiles.begin(),x_tiles.end());
+    TileRange r;
+    r.tile_w = static_cast<int>(m_ts_collection->get_tile_w());
+    r.tile_h = static_cast<int>(m_ts_collection->get_tile_h());
+    r.stagger_index_odd = layout.stagger_index_odd;
 
-                // Move down half a row
-                y += y_step;
-            }
-            // Prevent stepping down twice
-            continue;
-        }
-        // Move down a full row
-        y += y_step * 2;
+    if(layout.orientation == MapData::Orientation::orthogonal) {
+        r.mode = TileRange::ortho;
     }
-    return tiles;
+    else if(layout.stagger_axis_y) {
+        r.mode = TileRange::y_stagger;
+        // Conform to y_stagger
+        r.tile_h /= 2;
+        r.tile_h += layout.hexsidelength / 2;
+    }
+    else {
+        r.mode = TileRange::x_stagger;
+        // Conform to x stagger
+        r.tile_w /= 2;
+        r.tile_w += layout.hexsidelength / 2;
+    }
+
+    calc_tile_range(rect, r.tile_w, r.tile_h, r.x_from, r.x_to, r.y_from, r.y_to, r.x_start, r.y_start);
+
+    r.reverse_x = (layout.render_order == MapData::RenderOrder::left_down || layout.render_order == MapData::RenderOrder::left_up);
+    r.reverse_y = (layout.render_order == MapData::RenderOrder::left_up || layout.render_order == MapData::RenderOrder::right_up);
+    return r;
+}
+
+/// Returns the decimals which get eliminated due to rounding when clipping the rect
+Point MapLayer::get_decimals(Rect rect) const {
+    Point p = m_transform.get_relative(0,0);
+    return Point(round(rect.x - p.x) - (rect.x - p.x),
+                 round(rect.y - p.y) - (rect.y - p.y));
+}
+
+/// Returns a TileInstance of the given gid with its flip flags applied at the world coords x and y
+TileInstance MapLayer::make_tile_instance(Uint32 tile_id, float x, float y) const {
+    return TileInstance::place(m_ts_collection->get_tile(tile_id), tile_id, x, y);
+}
+
+/// Returns the collider of a tile placed at the given world position
+TileCollider MapLayer::make_tile_collider(Uint32 tile_id, float x, float y) const {
+    return m_ts_collection->get_collider(tile_id, x, y);
 }
 
 /// Calculate the range of tiles bounding with rect
 void MapLayer::calc_tile_range(Rect src_rect, int tile_w, int tile_h, int& x_from, int& x_to, int& y_from, int& y_to, int& x_start, int& y_start) const {
 
-    // Apply the layer offset
+    // Apply the layer offset and the grid origin of infinite maps
     Point p = m_transform.get_relative(0,0);
-    src_rect.x -= p.x;
-    src_rect.y -= p.y;
+    src_rect.x -= p.x + m_origin_x * tile_w;
+    src_rect.y -= p.y + m_origin_y * tile_h;
 
     PixelRect rect = src_rect;
 
@@ -488,8 +943,8 @@ void MapLayer::calc_tile_range(Rect src_rect, int tile_w, int tile_h, int& x_fro
     float up_oh = m_ts_collection->get_overhang(Direction::up);
     float down_oh = m_ts_collection->get_overhang(Direction::down);
 
-    const MapData::TileLayout layout = m_layer_collection->get_base_map().get_tile_layout();
-    if(layout.orientation != "orthogonal") {
+    const MapData::TileLayout& layout = m_layer_collection->get_base_map().get_tile_layout();
+    if(layout.orientation != MapData::Orientation::orthogonal) {
         // Render half tile extra to show pointy tile borders
         left_oh += static_cast<int>(m_ts_collection->get_tile_w()) / 2;
         up_oh += static_cast<int>(m_ts_collection->get_tile_h()) / 2;
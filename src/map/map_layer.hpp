@@ -20,13 +20,18 @@
 #ifndef MAP_LAYER_HPP_INCLUDED
 #define MAP_LAYER_HPP_INCLUDED
 
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <string>
-#include <tuple>
+#include <unordered_map>
 
+#include "actor/collision_filter.hpp"
+#include "graphics/texture.hpp"
 #include "map/layer.hpp"
+#include "map/raycast.hpp"
 #include "map/tile.hpp"
+#include "map/tile_grid.hpp"
 
 namespace salmon { namespace internal {
 
@@ -40,12 +45,53 @@ class MapLayer : public Layer{
 
         bool render(const Camera& camera) const override;
 
-        std::vector< std::tuple<Uint32, int, int> > clip(Rect rect) const;
+        template<class Func>
+        void for_each_visible_tile(Rect rect, Func fn) const;
+        template<class Func>
+        void for_each_tile_instance(Rect rect, Func fn) const;
+        template<class Func>
+        void for_each_tile_collider(Rect rect, Func fn) const;
+
         std::vector<TileInstance> get_clip(Rect rect) const;
 
+        void ensure_decoded(Rect rect);
+
+        void raycast(const Ray& ray, const std::vector<HitboxId>& hitboxes, bool all, std::vector<RaycastHit>& hits);
+
+        Uint32 get_tile_id(unsigned x, unsigned y);
+        bool set_tile_id(unsigned x, unsigned y, Uint32 tile_id);
+
+        enum class Encoding {
+            csv,
+            base64,
+            cooked, ///< Decoded tiles stored in a cooked map file, see CookedMap
+        };
+        enum class Compression {
+            none,
+            zlib,
+            gzip,
+            zstd,
+        };
+        Encoding get_encoding() const {return m_encoding;}
+        Compression get_compression() const {return m_compression;}
+        std::string get_codec() const;
+
+        static tinyxml2::XMLError parse_encoding(const char* p_encoding, const char* p_compression, Encoding& encoding, Compression& compression);
+        static tinyxml2::XMLError decode_data(const char* text, Encoding encoding, Compression compression, unsigned width, std::vector<Uint32>& tiles);
+        static tinyxml2::XMLError inflate_data(const std::vector<Uint8>& bytes, Compression compression, std::vector<Uint32>& tiles);
+
+        tinyxml2::XMLError load_data();
+
+        bool get_cached() const {return !m_chunk_cache.empty();}
+
+        const CollisionFilter& get_collision_filter() const {return m_collision_filter;}
+        /// Returns a counter which changes whenever a tile of the layer gets replaced
+        unsigned get_revision() const {return m_revision;}
+        void invalidate_cache();
+
         LayerType get_type() override {return LayerType::map;}
 
-        static MapLayer* parse(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
+        static MapLayer* parse(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
 
         MapLayer(const MapLayer& other) = delete;
         MapLayer& operator=(const MapLayer& other) = delete;
@@ -54,22 +100,283 @@ class MapLayer : public Layer{
         MapLayer& operator=(MapLayer&& other) = default;
 
     protected:
-        MapLayer(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
+        MapLayer(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
 
     private:
-        tinyxml2::XMLError init(tinyxml2::XMLElement* source);
+        /// The range of tiles bounding with a rect and how to walk them in render order
+        struct TileRange {
+            enum Mode {
+                ortho,
+                y_stagger,
+                x_stagger,
+            };
+            Mode mode;
+            int x_from, x_to, y_from, y_to; // Measured in tiles
+            int x_start, y_start; // Pixel position of the first tile relative to the rect origin
+            int tile_w, tile_h; // Pixel distance between neighbouring tiles
+            bool reverse_x; // Walk each row from right to left
+            bool reverse_y; // Walk the rows from bottom to top
+            bool stagger_index_odd;
+        };
+
+        /// A pre rendered chunk of static tiles, see render_cached()
+        struct ChunkCache {
+            Texture texture;
+            bool dirty = true; // Needs to be baked before its next use
+            bool tiled = false; // Holds animated tiles and therefore gets drawn tile by tile
+        };
+
+        /// Compressed tiles of an infinite map chunk which get decoded on first access
+        struct PendingChunk {
+            int x, y; // Position in the grid measured in tiles
+            unsigned w, h;
+            std::vector<Uint8> bytes; // Base64 decoded but still compressed, empty once decoded
+        };
+
+        tinyxml2::XMLError init(const Element* source);
+        tinyxml2::XMLError parse_properties(const Element* source);
+        tinyxml2::XMLError parse_chunks(const Element* p_data);
+        tinyxml2::XMLError decode_tiles(const Element* source, unsigned x, unsigned y, unsigned w, unsigned h);
+        tinyxml2::XMLError inflate_tiles(const std::vector<Uint8>& bytes, unsigned x, unsigned y, unsigned w, unsigned h);
+        void store_tiles(const Uint32* tiles, unsigned x, unsigned y, unsigned w, unsigned h);
+        static void swap_tiles(std::vector<Uint32>& tiles);
+        void decode_chunk(unsigned chunk_x, unsigned chunk_y);
+        void decode_range(const TileRange& r);
+
+        bool render_cached(const Camera& camera) const;
+        bool bake_chunk(unsigned chunk_x, unsigned chunk_y) const;
+        TileRange make_chunk_range(unsigned chunk_x, unsigned chunk_y, int x_origin, int y_origin) const;
 
-        std::vector< std::tuple<Uint32, int, int> > clip_ortho(Rect rect) const;
-        std::vector< std::tuple<Uint32, int, int> > clip_y_stagger(Rect rect) const;
-        std::vector< std::tuple<Uint32, int, int> > clip_x_stagger(Rect rect) const;
+        TileRange make_tile_range(Rect rect) const;
+        template<TileRange::Mode MODE, class Func>
+        void dispatch_render_order(const TileRange& r, Func& fn) const;
+        template<bool Y_STAGGER, bool REVERSE_X, bool REVERSE_Y, class Func>
+        void walk_rows(const TileRange& r, Func& fn) const;
+        template<bool REVERSE_X, bool REVERSE_Y, class Func>
+        void walk_half_rows(const TileRange& r, Func& fn) const;
+        template<bool REVERSE_X, class Func>
+        void walk_row(int i_y_tile, int x_lo, int x_hi, Uint32 pattern, Func fn) const;
         void calc_tile_range(Rect src_rect, int tile_w, int tile_h, int& x_from, int& x_to, int& y_from, int& y_to, int& x_start, int& y_start) const;
+        Point get_decimals(Rect rect) const;
+        TileInstance make_tile_instance(Uint32 tile_id, float x, float y) const;
+        TileCollider make_tile_collider(Uint32 tile_id, float x, float y) const;
 
         TilesetCollection* m_ts_collection;
         unsigned m_width;   // Measured in tiles
         unsigned m_height;
 
-        std::vector<std::vector<Uint32> > m_map_grid; ///< The actual map layer information
+        Encoding m_encoding = Encoding::csv;
+        Compression m_compression = Compression::none;
+
+        TileGrid m_grid; ///< The actual map layer information
+        const Element* mp_data = nullptr; ///< The layer data which still has to be loaded by load_data()
+
+        int m_origin_x = 0; ///< Map position of the grid origin measured in tiles, only non zero for infinite maps
+        int m_origin_y = 0;
+        std::vector<PendingChunk> m_pending; ///< Chunks of infinite maps which aren't decoded yet
+        std::unordered_map<unsigned, std::vector<unsigned>> m_pending_chunks; ///< Pending chunk indices by grid chunk
+
+        bool m_cache = false; ///< Set by the CACHE property of the layer
+        CollisionFilter m_collision_filter; ///< Set by the COLLISION_CATEGORY and COLLISION_MASK properties of the layer
+        unsigned m_revision = 0; ///< Incremented by set_tile_id()
+        mutable std::vector<ChunkCache> m_chunk_cache; ///< One entry per grid chunk, empty if the cache is off
 };
+
+/**
+ * @brief Calls fn(tile_id, x, y) for each non empty tile possibly bounding with the given rect
+ * @param rect A rect which is usually a camera or the bounding box of a collider
+ * @param fn Callable which receives the tile id and the xy-coords relative to the rect origin
+ *
+ * The tiles are visited in the render order of the map, no memory gets allocated.
+ * Chunks of infinite maps which aren't decoded yet read as empty, so queries call
+ * ensure_decoded() with the same rect first. Then walking is free of side effects.
+ */
+template<class Func>
+void MapLayer::for_each_visible_tile(Rect rect, Func fn) const {
+    const TileRange r = make_tile_range(rect);
+    // Pick the kernel once, so that no layout checks are left inside the loops
+    switch(r.mode) {
+        case TileRange::ortho:     dispatch_render_order<TileRange::ortho>(r, fn); break;
+        case TileRange::y_stagger: dispatch_render_order<TileRange::y_stagger>(r, fn); break;
+        case TileRange::x_stagger: dispatch_render_order<TileRange::x_stagger>(r, fn); break;
+    }
+}
+
+/// Selects the kernel specialized for the render order of the tile range
+template<MapLayer::TileRange::Mode MODE, class Func>
+void MapLayer::dispatch_render_order(const TileRange& r, Func& fn) const {
+    if(MODE == TileRange::x_stagger) {
+        if(r.reverse_x) {
+            if(r.reverse_y) {walk_half_rows<true, true>(r, fn);}
+            else            {walk_half_rows<true, false>(r, fn);}
+        }
+        else {
+            if(r.reverse_y) {walk_half_rows<false, true>(r, fn);}
+            else            {walk_half_rows<false, false>(r, fn);}
+        }
+    }
+    else {
+        const bool Y_STAGGER = (MODE == TileRange::y_stagger);
+        if(r.reverse_x) {
+            if(r.reverse_y) {walk_rows<Y_STAGGER, true, true>(r, fn);}
+            else            {walk_rows<Y_STAGGER, true, false>(r, fn);}
+        }
+        else {
+            if(r.reverse_y) {walk_rows<Y_STAGGER, false, true>(r, fn);}
+            else            {walk_rows<Y_STAGGER, false, false>(r, fn);}
+        }
+    }
+}
+
+/**
+ * @brief Walks an orthogonal or y-staggered tile range row by row in draw order
+ *
+ * The range gets clamped to the layer beforehand, so the loops need no bounds checks
+ */
+template<bool Y_STAGGER, bool REVERSE_X, bool REVERSE_Y, class Func>
+void MapLayer::walk_rows(const TileRange& r, Func& fn) const {
+    const int x_lo = std::max(r.x_from, 0);
+    const int x_hi = std::min(r.x_to, static_cast<int>(m_grid.get_width()) - 1);
+    const int y_lo = std::max(r.y_from, 0);
+    const int y_hi = std::min(r.y_to, static_cast<int>(m_grid.get_height()) - 1);
+    if(x_lo > x_hi || y_lo > y_hi) {return;}
+
+    // Pixel position of the tile at index 0
+    const int x_origin = r.x_start - r.x_from * r.tile_w;
+    const int y_origin = r.y_start - r.y_from * r.tile_h;
+
+    for(int i_row = 0; i_row <= y_hi - y_lo; i_row++) {
+        const int i_y_tile = REVERSE_Y ? y_hi - i_row : y_lo + i_row;
+        const int y = y_origin + i_y_tile * r.tile_h;
+        int x_row = x_origin;
+        if(Y_STAGGER && (i_y_tile % 2 != 0) == r.stagger_index_odd) {
+            x_row += r.tile_w / 2;
+        }
+
+        walk_row<REVERSE_X>(i_y_tile, x_lo, x_hi, 0xFFFFFFFF, [&](Uint32 tile_id, int i_x_tile) {
+            fn(tile_id, x_row + i_x_tile * r.tile_w, y);
+        });
+    }
+}
+
+/**
+ * @brief Walks a x-staggered tile range in draw order
+ *
+ * Each row is split into two half rows of every second tile, of which the
+ * one which isn't shifted down gets drawn first.
+ */
+template<bool REVERSE_X, bool REVERSE_Y, class Func>
+void MapLayer::walk_half_rows(const TileRange& r, Func& fn) const {
+    const int x_lo = std::max(r.x_from, 0);
+    const int x_hi = std::min(r.x_to, static_cast<int>(m_grid.get_width()) - 1);
+    const int y_lo = std::max(r.y_from, 0);
+    const int y_hi = std::min(r.y_to, static_cast<int>(m_grid.get_height()) - 1);
+    if(x_lo > x_hi || y_lo > y_hi) {return;}
+
+    const int y_step = r.tile_h / 2;
+    const int x_origin = r.x_start - r.x_from * r.tile_w;
+    const int y_origin = r.y_start - r.y_from * y_step * 2;
+    // Column parity of the first half row
+    const int first_parity = r.stagger_index_odd ? 0 : 1;
+
+    for(int i_row = 0; i_row <= y_hi - y_lo; i_row++) {
+        const int i_y_tile = REVERSE_Y ? y_hi - i_row : y_lo + i_row;
+
+        for(int i_pass = 0; i_pass < 2; i_pass++) {
+            const int half = REVERSE_Y ? 1 - i_pass : i_pass;
+            const int parity = (first_parity + half) & 1;
+            const int y = y_origin + i_y_tile * y_step * 2 + half * y_step;
+            // Chunks start at even columns, so the pattern picks the tiles of the right parity
+            const Uint32 pattern = parity ? 0xAAAAAAAA : 0x55555555;
+
+            walk_row<REVERSE_X>(i_y_tile, x_lo, x_hi, pattern, [&](Uint32 tile_id, int i_x_tile) {
+                fn(tile_id, x_origin + i_x_tile * r.tile_w, y);
+            });
+        }
+    }
+}
+
+/**
+ * @brief Calls fn(tile_id, i_x_tile) for each non empty tile of a row
+ * @param i_y_tile The row, which must be on the layer
+ * @param x_lo, x_hi The range of columns, which must be on the layer
+ * @param pattern Bit n selects the columns whose index modulo CHUNK_SIZE is n
+ *
+ * The row gets walked chunk by chunk, skipping empty chunks. On sparse layers
+ * the occupancy masks are used to jump straight to the occupied tiles.
+ */
+template<bool REVERSE_X, class Func>
+void MapLayer::walk_row(int i_y_tile, int x_lo, int x_hi, Uint32 pattern, Func fn) const {
+    const int cx_lo = x_lo >> TileGrid::CHUNK_SHIFT;
+    const int cx_hi = x_hi >> TileGrid::CHUNK_SHIFT;
+    const bool sparse = m_grid.is_sparse();
+    const int step = (pattern == 0xFFFFFFFF) ? 1 : 2;
+
+    for(int i_chunk = 0; i_chunk <= cx_hi - cx_lo; i_chunk++) {
+        const int chunk_x = REVERSE_X ? cx_hi - i_chunk : cx_lo + i_chunk;
+        const Uint32* segment = m_grid.get_row_segment(chunk_x, i_y_tile);
+        if(segment == nullptr) {continue;}
+
+        const int base = chunk_x << TileGrid::CHUNK_SHIFT;
+        int first = std::max(x_lo, base) - base;
+        int last = std::min(x_hi, base + static_cast<int>(TileGrid::CHUNK_MASK)) - base;
+
+        if(sparse) {
+            Uint32 bits = m_grid.get_row_mask(chunk_x, i_y_tile) & TileGrid::bit_range(first, last) & pattern;
+            while(bits != 0) {
+                const int bit = REVERSE_X ? TileGrid::highest_bit(bits) : TileGrid::lowest_bit(bits);
+                bits &= ~(1u << bit);
+                fn(segment[bit], base + bit);
+            }
+        }
+        else {
+            if(!((pattern >> first) & 1)) {first++;}
+            if(!((pattern >> last) & 1)) {last--;}
+            for(int i_col = 0; i_col <= (last - first) / step && first <= last; i_col++) {
+                const int local = REVERSE_X ? last - i_col * step : first + i_col * step;
+                const Uint32 tile_id = segment[local];
+                // Scrap empty tiles!
+                if(tile_id != 0) {
+                    fn(tile_id, base + local);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Calls fn(tile_instance) for each non empty tile possibly bounding with the given rect
+ * @param rect A rect which is usually the bounding box of a collider
+ * @param fn Callable which receives a @c TileInstance& positioned relative to the world origin
+ *
+ * Like for_each_visible_tile() this allocates no memory
+ */
+template<class Func>
+void MapLayer::for_each_tile_instance(Rect rect, Func fn) const {
+    // Get missing decimals back which were eliminated due to rounding when clipping
+    Point decimals = get_decimals(rect);
+    for_each_visible_tile(rect, [&](Uint32 tile_id, int x, int y) {
+        TileInstance tile = make_tile_instance(tile_id, decimals.x + x + rect.x, decimals.y + y + rect.y);
+        fn(tile);
+    });
+}
+
+/**
+ * @brief Calls fn(tile_collider) for each non empty tile possibly bounding with the given rect
+ * @param rect A rect which is usually the bounding box of a collider
+ * @param fn Callable which receives a @c const TileCollider& positioned relative to the world origin
+ *
+ * Prefer this over for_each_tile_instance() for collision queries, since the hitboxes
+ * are looked up ready transformed instead of building a Transform for each tile
+ */
+template<class Func>
+void MapLayer::for_each_tile_collider(Rect rect, Func fn) const {
+    Point decimals = get_decimals(rect);
+    for_each_visible_tile(rect, [&](Uint32 tile_id, int x, int y) {
+        const TileCollider tile = make_tile_collider(tile_id, decimals.x + x + rect.x, decimals.y + y + rect.y);
+        fn(tile);
+    });
+}
 }} // namespace salmon::internal
 
 #endif // MAP_LAYER_HPP_INCLUDED
@@ -25,12 +25,15 @@
 
 #include "transform.hpp"
 #include "actor/actor.hpp"
+#include "core/gameinfo.hpp"
 #include "map/tile.hpp"
 #include "map/tileset.hpp"
 #include "map/layer.hpp"
+#include "map/map_layer.hpp"
 #include "util/parse.hpp"
 #include "util/attribute_parser.hpp"
 #include "util/logger.hpp"
+#include "util/thread_pool.hpp"
 
 namespace salmon { namespace internal {
 
@@ -61,17 +64,32 @@ tinyxml2::XMLError MapData::init_map(std::string filename, SDL_Renderer** render
     m_base_path = filename;
     m_base_path = m_base_path.erase(m_base_path.find_last_of('/') + 1);
 
-    // Load the .tmx mapfile from disk
-    tinyxml2::XMLDocument mapfile{true, tinyxml2::COLLAPSE_WHITESPACE};
-    eResult = mapfile.LoadFile(filename.c_str());
-    if(eResult != XML_SUCCESS) {
-        Logger(Logger::error) << "Can't find file at: " << filename;
-        return eResult;
+    // Prefer an up to date cooked map, which holds the elements of the map and its tilesets and the decoded map layers
+    ElementTree elements;
+    mp_cooked.reset(new CookedMap);
+    if(mp_cooked->open(filename + CookedMap::EXTENSION, m_base_path)) {
+        if(!mp_cooked->get_elements(elements)) {
+            Logger(Logger::error) << "Invalid elements in cooked map: " << filename + CookedMap::EXTENSION;
+            return XML_ERROR_PARSING;
+        }
+    }
+    else {
+        mp_cooked.reset();
+
+        // Load the .tmx mapfile from disk
+        tinyxml2::XMLDocument mapfile{true, tinyxml2::COLLAPSE_WHITESPACE};
+        eResult = mapfile.LoadFile(filename.c_str());
+        if(eResult != XML_SUCCESS) {
+            Logger(Logger::error) << "Can't find file at: " << filename;
+            return eResult;
+        }
+        XMLElement* p_root = mapfile.FirstChildElement("map");
+        if(p_root != nullptr) {elements.parse(p_root);}
     }
 
     // Check for map base element
-    XMLElement* pMap = mapfile.FirstChildElement("map");
-    if (pMap == nullptr)  {
+    const Element* pMap = elements.get_root();
+    if (pMap == nullptr || std::string("map") != pMap->Name())  {
         Logger(Logger::error) << "Missing base node \"map\" inside .tmx file!";
         return XML_ERROR_PARSING_ELEMENT;
     }
@@ -90,9 +108,12 @@ tinyxml2::XMLError MapData::init_map(std::string filename, SDL_Renderer** render
         return eResult;
     }
 
+    // Worker threads for file parsing, image and layer decoding, textures get uploaded on this thread
+    ThreadPool& pool = m_game->get_thread_pool();
+
     /// @note First parse tilesets, then layers, because layers depend on tileset information
     // This initiates the parsing of all tilesets
-    eResult = m_ts_collection.init(pMap, this);
+    eResult = m_ts_collection.init(pMap, this, pool);
     if(eResult != XML_SUCCESS) {
         Logger(Logger::error) << "Failed at parsing tilesets!";
         return eResult;
@@ -111,7 +132,7 @@ tinyxml2::XMLError MapData::init_map(std::string filename, SDL_Renderer** render
     std::string l = "layer";
     std::string i = "imagelayer";
     std::string o = "objectgroup";
-    XMLElement* pLa = pMap->FirstChildElement();
+    const Element* pLa = pMap->FirstChildElement();
     while(pLa != nullptr) {
         const char* name = pLa->Name();
         if(name == l || name == i || name == o) {break;}
@@ -119,24 +140,45 @@ tinyxml2::XMLError MapData::init_map(std::string filename, SDL_Renderer** render
     }
 
     // Parse all layers of the map file
-    eResult = m_layer_collection.init(pLa, *this);
+    eResult = m_layer_collection.init(pLa, *this, pool);
+    // The decoded map layers got copied, so neither the cooked map nor the elements mapped from it are needed anymore
+    mp_cooked.reset();
     if(eResult != XML_SUCCESS) {
         Logger(Logger::error) << "Failed at parsing layers!";
         return eResult;
     }
 
+    // Report the codecs of the map layers, which dominate the loading time of big maps
+    std::map<std::string, unsigned> codecs = get_layer_codecs();
+    if(!codecs.empty()) {
+        Logger log(Logger::info);
+        log << "Map " << filename << " uses layer codecs:";
+        for(auto& codec : codecs) {
+            log << " " << codec.first << " (" << codec.second << ")";
+        }
+    }
+
     // Initialize last_update timestamp
     m_last_update = SDL_GetTicks();
 
     return XML_SUCCESS;
 }
 
+/// Returns the number of map layers per data codec like "base64+zlib" or "csv"
+std::map<std::string, unsigned> MapData::get_layer_codecs() {
+    std::map<std::string, unsigned> codecs;
+    for(MapLayer* layer : m_layer_collection.get_map_layers()) {
+        codecs[layer->get_codec()]++;
+    }
+    return codecs;
+}
+
 /**
  * @brief Parse map dimensions, orientation, stagger-axis, stagger-index, hexsidelength and bg-color
- * @param pMap @c XMLElement* which points to the first map file element called "map"
+ * @param pMap @c const Element* which points to the first map file element called "map"
  * @return @c XMLError which indicates sucess or failure
  */
-tinyxml2::XMLError MapData::parse_map_info(tinyxml2::XMLElement* pMap) {
+tinyxml2::XMLError MapData::parse_map_info(const Element* pMap) {
     using namespace tinyxml2;
     XMLError eResult;
 
@@ -150,17 +192,22 @@ tinyxml2::XMLError MapData::parse_map_info(tinyxml2::XMLElement* pMap) {
     eResult = parser.parse(pMap);
     if(eResult != XML_SUCCESS) {return eResult;}
 
-    if(orientation != "orthogonal" && orientation != "hexagonal" && orientation != "staggered") {
+    if(orientation == "orthogonal") {m_tile_layout.orientation = Orientation::orthogonal;}
+    else if(orientation == "staggered") {m_tile_layout.orientation = Orientation::staggered;}
+    else if(orientation == "hexagonal") {m_tile_layout.orientation = Orientation::hexagonal;}
+    else {
         Logger(Logger::error) << "Tile orientation " << orientation << " isn't supported!";
         return XMLError::XML_WRONG_ATTRIBUTE_TYPE;
     }
-    m_tile_layout.orientation = orientation;
 
-    if(render_order != "right-down" && render_order != "right-up" && render_order != "left-down" && render_order != "left-up") {
+    if(render_order == "right-down") {m_tile_layout.render_order = RenderOrder::right_down;}
+    else if(render_order == "right-up") {m_tile_layout.render_order = RenderOrder::right_up;}
+    else if(render_order == "left-down") {m_tile_layout.render_order = RenderOrder::left_down;}
+    else if(render_order == "left-up") {m_tile_layout.render_order = RenderOrder::left_up;}
+    else {
         Logger(Logger::error) << "Tile render_order " << render_order << " isn't supported!";
         return XMLError::XML_WRONG_ATTRIBUTE_TYPE;
     }
-    m_tile_layout.render_order = render_order;
 
     // Parse the (optional) stagger-axi of the map and check it
     const char* p_stagger_axis = pMap->Attribute("staggeraxis");
@@ -207,14 +254,14 @@ tinyxml2::XMLError MapData::parse_map_info(tinyxml2::XMLElement* pMap) {
 
 /**
  * @brief Parse on_* callbacks of map and possible symbolic tilesets yielding events
- * @param pMap @c XMLElement* which points to the first map file element called "map"
+ * @param pMap @c const Element* which points to the first map file element called "map"
  * @return @c XMLError which indicates sucess or failure
  */
-tinyxml2::XMLError MapData::parse_map_properties(tinyxml2::XMLElement* pMap) {
+tinyxml2::XMLError MapData::parse_map_properties(const Element* pMap) {
     using namespace tinyxml2;
 
     // Parse names of possible on_* callbacks and filenames of possible symbolic tilesets
-    XMLElement* pProp = pMap->FirstChildElement("properties");
+    const Element* pProp = pMap->FirstChildElement("properties");
     if (pProp != nullptr) {
         pProp = pProp->FirstChildElement("property");
         while(pProp != nullptr) {
@@ -296,7 +343,7 @@ void MapData::update() {
     //m_delta_time = 1.0f / 60.0f;
     m_last_update = current_time;
 
-    // Checks and changes animated tiles
+    // Advances the shared clock of animated tiles
     m_ts_collection.push_all_anim();
 
     // Registers inter actor-tile-mouse collision
@@ -313,7 +360,7 @@ void MapData::resume() {
 /// Returns map width in pixels
 unsigned MapData::get_w() const {
     int width = m_width * m_ts_collection.get_tile_w();
-    if(m_tile_layout.orientation != "orthogonal") {
+    if(m_tile_layout.orientation != Orientation::orthogonal) {
         if(!m_tile_layout.stagger_axis_y) {
             width /= 2;
             width += m_width * m_tile_layout.hexsidelength / 2;
@@ -326,7 +373,7 @@ unsigned MapData::get_w() const {
 /// Returns map height in pixels
 unsigned MapData::get_h() const {
     int height = m_height * m_ts_collection.get_tile_h();
-    if(m_tile_layout.orientation != "orthogonal") {
+    if(m_tile_layout.orientation != Orientation::orthogonal) {
         if(m_tile_layout.stagger_axis_y) {
             height /= 2;
             height += m_height * m_tile_layout.hexsidelength / 2;
@@ -360,12 +407,12 @@ void MapData::add_actor_animation(std::string name, std::string anim, Direction
 }
 
 /**
- * @brief Add an Actor template to the vector @c m_actor_templates from an @c XMLElement
- * @param source The @c XMLElement which contains the information
+ * @brief Add an Actor template to the vector @c m_actor_templates from an @c Element
+ * @param source The @c Element which contains the information
  * @param tile The pointer to the Actor template tile
  * @return an @c XMLError object which indicates success or error type
  */
-tinyxml2::XMLError MapData::add_actor_template(tinyxml2::XMLElement* source, Tile* tile) {
+tinyxml2::XMLError MapData::add_actor_template(const Element* source, Tile* tile) {
     using namespace tinyxml2;
     XMLError eResult;
 
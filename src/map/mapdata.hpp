@@ -21,13 +21,17 @@
 
 #include <SDL.h>
 #include <vector>
+#include <map>
+#include <memory>
 #include <string>
 #include <tinyxml2.h>
 
 #include "camera.hpp"
 #include "actor/data_block.hpp"
+#include "map/cooked_map.hpp"
 #include "map/layer_collection.hpp"
 #include "map/tileset_collection.hpp"
+#include "util/element_tree.hpp"
 #include "util/game_types.hpp"
 
 namespace salmon {
@@ -47,9 +51,20 @@ class Tile;
 
 class MapData {
     public:
+        enum class Orientation{
+            orthogonal,
+            staggered,
+            hexagonal,
+        };
+        enum class RenderOrder{
+            right_down,
+            right_up,
+            left_down,
+            left_up,
+        };
         struct TileLayout{
-            std::string orientation = "";
-            std::string render_order = "";
+            Orientation orientation = Orientation::orthogonal;
+            RenderOrder render_order = RenderOrder::right_down;
             int hexsidelength = 0;
             bool stagger_axis_y = true;
             bool stagger_index_odd = true;
@@ -66,8 +81,8 @@ class MapData {
 
         // Map parsing functions
         tinyxml2::XMLError init_map(std::string filename, SDL_Renderer** renderer);
-        tinyxml2::XMLError parse_map_info(tinyxml2::XMLElement* pMap);
-        tinyxml2::XMLError parse_map_properties(tinyxml2::XMLElement* pMap);
+        tinyxml2::XMLError parse_map_info(const Element* pMap);
+        tinyxml2::XMLError parse_map_properties(const Element* pMap);
 
         bool render() const;
         void update();
@@ -87,7 +102,9 @@ class MapData {
         TilesetCollection& get_ts_collection() {return m_ts_collection;}
         LayerCollection& get_layer_collection() {return m_layer_collection;}
         salmon::Camera& get_camera() {return m_camera;}
-        const TileLayout get_tile_layout() {return m_tile_layout;}
+        const TileLayout& get_tile_layout() const {return m_tile_layout;}
+        std::map<std::string, unsigned> get_layer_codecs();
+        const CookedMap* get_cooked_map() const {return mp_cooked.get();} ///< Only set while a cooked map gets loaded
 
         // Actor management
         bool is_actor(Uint32 gid) const;
@@ -95,7 +112,7 @@ class MapData {
         Actor get_actor(Uint32 gid) const;
         Actor get_actor(std::string name) const;
 
-        tinyxml2::XMLError add_actor_template(tinyxml2::XMLElement* source, Tile* tile);
+        tinyxml2::XMLError add_actor_template(const Element* source, Tile* tile);
         void add_actor_animation(std::string name, std::string anim, Direction dir, Tile* tile);
 
         Actor* fetch_actor(std::string name);
@@ -130,6 +147,8 @@ class MapData {
         std::map<Uint32, std::string> m_gid_to_actor_temp_name; ///< List of actor template names by global tile id
 
         SDL_Renderer** mpp_renderer = nullptr;
+
+        std::unique_ptr<CookedMap> mp_cooked; ///< The cooked map which holds the decoded map layers while loading
 };
 }} // namespace salmon::internal
 
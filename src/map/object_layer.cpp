@@ -25,6 +25,7 @@
 #include "actor/actor.hpp"
 #include "actor/primitive.hpp"
 #include "map/mapdata.hpp"
+#include "map/tile_flip.hpp"
 #include "map/tileset_collection.hpp"
 #include "map/layer_collection.hpp"
 #include "util/logger.hpp"
@@ -34,21 +35,21 @@ namespace salmon { namespace internal {
 unsigned ObjectLayer::next_object_id = 1;
 
 /// Factory function which retrieves a pointer owning the object layer
-ObjectLayer* ObjectLayer::parse(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) {
+ObjectLayer* ObjectLayer::parse(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) {
     return new ObjectLayer(source, name, layer_collection, eresult);
 }
 
 /// Constructor which only may be used internally
-ObjectLayer::ObjectLayer(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) : Layer(name, layer_collection) {
+ObjectLayer::ObjectLayer(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult) : Layer(name, layer_collection) {
     eresult = init(source);
 }
 
 /**
  * @brief Initialize the layer by parsing info from source
- * @param source The @c XMLElement from which information is parsed
+ * @param source The @c Element from which information is parsed
  * @return @c XMLError which indicates failure or sucess of parsing
  */
-tinyxml2::XMLError ObjectLayer::init(tinyxml2::XMLElement* source) {
+tinyxml2::XMLError ObjectLayer::init(const Element* source) {
     using namespace tinyxml2;
     XMLError eResult;
     MapData& mapdata = m_layer_collection->get_base_map();
@@ -63,9 +64,9 @@ tinyxml2::XMLError ObjectLayer::init(tinyxml2::XMLElement* source) {
     m_transform.set_pos(offsetx,offsety);
 
     // Parse user specified properties of the object_layer (only suspended right now)
-    XMLElement* p_tile_properties = source->FirstChildElement("properties");
+    const Element* p_tile_properties = source->FirstChildElement("properties");
     if(p_tile_properties != nullptr) {
-        XMLElement* p_property = p_tile_properties->FirstChildElement("property");
+        const Element* p_property = p_tile_properties->FirstChildElement("property");
         while(p_property != nullptr) {
             const char* p_name;
             p_name = p_property->Attribute("name");
@@ -88,24 +89,14 @@ tinyxml2::XMLError ObjectLayer::init(tinyxml2::XMLElement* source) {
     }
 
     // Parse individual objects/actors
-    XMLElement* p_object = source->FirstChildElement("object");
+    const Element* p_object = source->FirstChildElement("object");
     while(p_object != nullptr) {
         unsigned gid = 0;
         eResult = p_object->QueryUnsignedAttribute("gid", &gid);
 
-        const Uint32 FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
-        const Uint32 FLIPPED_VERTICALLY_FLAG   = 0x40000000;
-        bool flipped_horizontally = false;
-        bool flipped_vertically = false;
-
-        // Parse flip values
-        if(gid >= FLIPPED_VERTICALLY_FLAG) {
-            // Read out flags
-            flipped_horizontally = (gid & FLIPPED_HORIZONTALLY_FLAG);
-            flipped_vertically = (gid & FLIPPED_VERTICALLY_FLAG);
-
-            gid &= ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG);
-        }
+        // Parse flip values, tile objects can only be flipped horizontally and vertically
+        const TileFlip& flip = TileFlip::get(gid & (TileFlip::HORIZONTAL | TileFlip::VERTICAL));
+        gid &= ~(TileFlip::HORIZONTAL | TileFlip::VERTICAL);
 
         if(eResult == XML_SUCCESS && mapdata.is_actor(gid)) {
 
@@ -113,7 +104,7 @@ tinyxml2::XMLError ObjectLayer::init(tinyxml2::XMLElement* source) {
 
             // m_obj_grid.push_back(Actor(mapdata.get_actor(gid)));
 
-            // Initialize actor from the XMLElement*
+            // Initialize actor from the const Element*
             auto& actor = m_obj_grid.back();
             eResult = actor.parse_base(p_object);
             if(eResult != XML_SUCCESS) {
@@ -131,8 +122,8 @@ tinyxml2::XMLError ObjectLayer::init(tinyxml2::XMLElement* source) {
             actor.move_relative(p.x,p.y);
 
             auto& transform = actor.get_transform();
-            transform.set_h_flip(flipped_horizontally);
-            transform.set_v_flip(flipped_vertically);
+            transform.set_h_flip(flip.h_flip);
+            transform.set_v_flip(flip.v_flip);
         }
         else {
 
@@ -255,6 +246,7 @@ Actor* ObjectLayer::add_actor(Actor a) {
 bool ObjectLayer::erase_actor(std::string name) {
     for (auto itr = m_obj_grid.begin(); itr != m_obj_grid.end(); itr++) {
         if ((*itr).get_name() == name) {
+            m_layer_collection->forget_actor(&(*itr));
             itr = m_obj_grid.erase(itr);
             return true;
         }
@@ -275,6 +267,7 @@ bool ObjectLayer::erase_actor(std::string name) {
 bool ObjectLayer::erase_actor(Actor* actor) {
     for (auto itr = m_obj_grid.begin(); itr != m_obj_grid.end(); itr++) {
         if (&(*itr) == actor) {
+            m_layer_collection->forget_actor(actor);
             itr = m_obj_grid.erase(itr);
             return true;
         }
@@ -63,7 +63,7 @@ class ObjectLayer : public Layer{
         std::vector<Actor*> get_clip(const Rect& rect);
         std::vector<const Actor*> get_clip(const Rect& rect) const;
 
-        static ObjectLayer* parse(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
+        static ObjectLayer* parse(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
 
         ObjectLayer(const ObjectLayer& other) = delete;
         ObjectLayer& operator=(const ObjectLayer& other) = delete;
@@ -72,10 +72,10 @@ class ObjectLayer : public Layer{
         ObjectLayer& operator=(ObjectLayer&& other) = default;
 
     protected:
-        ObjectLayer(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
+        ObjectLayer(const Element* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
 
     private:
-        tinyxml2::XMLError init(tinyxml2::XMLElement* source);
+        tinyxml2::XMLError init(const Element* source);
 
         std::list<Actor> m_obj_grid;
         std::list<Smart<Primitive>> m_primitives;
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/raycast.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace salmon { namespace internal {
+
+namespace {
+
+constexpr float INF = std::numeric_limits<float>::infinity();
+
+/**
+ * @brief Calculate the distances at which a ray enters and leaves the space between two lines
+ * @return False if the ray runs parallel to the lines and outside of them or on one of them
+ */
+bool clip_axis(float origin, float direction, float low, float high, float& enter, float& exit) {
+    if(direction == 0) {
+        enter = -INF;
+        exit = INF;
+        // Like Rect::has_intersection() merely touching a border doesn't count
+        return origin > low && origin < high;
+    }
+    enter = (low - origin) / direction;
+    exit = (high - origin) / direction;
+    if(enter > exit) {std::swap(enter, exit);}
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Construct a ray
+ * @param origin The start of the ray in world coordinates
+ * @param direction The direction of the ray which doesn't need to be normalized
+ * @param length The length of the ray, the ray is invalid if this or the direction is zero
+ */
+Ray::Ray(Point origin, Point direction, float length) : m_origin{origin}, m_length{length} {
+    float norm = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    if(norm == 0 || !(length > 0)) {
+        m_length = 0;
+        return;
+    }
+    m_direction = Point{direction.x / norm, direction.y / norm};
+}
+
+/**
+ * @brief Calculate the part of the ray which lies inside of the rect
+ * @param rect The rect to clip the ray with
+ * @param enter Receives the distance at which the ray enters the rect, zero if it starts inside
+ * @param exit Receives the distance at which the ray leaves the rect or ends
+ * @return True if the ray overlaps the rect, merely touching it doesn't count
+ */
+bool Ray::clip(const Rect& rect, float& enter, float& exit) const {
+    if(!valid() || rect.empty()) {return false;}
+    float x_enter, x_exit, y_enter, y_exit;
+    if(!clip_axis(m_origin.x, m_direction.x, rect.x, rect.x + rect.w, x_enter, x_exit) ||
+       !clip_axis(m_origin.y, m_direction.y, rect.y, rect.y + rect.h, y_enter, y_exit)) {return false;}
+    enter = std::max({x_enter, y_enter, 0.0f});
+    exit = std::min({x_exit, y_exit, m_length});
+    return enter < exit;
+}
+
+/**
+ * @brief Check where the ray hits the rect
+ * @param rect The rect to check, usually a hitbox
+ * @param distance Receives the distance from the origin to where the ray enters the rect
+ * @param normal Receives the unit normal of the side which got hit, zero if the ray starts inside the rect
+ * @return True if the ray hits the rect, merely touching it doesn't count
+ */
+bool Ray::intersect(const Rect& rect, float& distance, Point& normal) const {
+    if(!valid() || rect.empty()) {return false;}
+    float x_enter, x_exit, y_enter, y_exit;
+    if(!clip_axis(m_origin.x, m_direction.x, rect.x, rect.x + rect.w, x_enter, x_exit) ||
+       !clip_axis(m_origin.y, m_direction.y, rect.y, rect.y + rect.h, y_enter, y_exit)) {return false;}
+    float enter = std::max(x_enter, y_enter);
+    float exit = std::min({x_exit, y_exit, m_length});
+    if(enter >= exit || exit <= 0) {return false;}
+
+    if(enter < 0) {
+        distance = 0;
+        normal = Point{0, 0};
+    }
+    else if(x_enter > y_enter) {
+        distance = enter;
+        normal = Point{m_direction.x > 0 ? -1.0f : 1.0f, 0};
+    }
+    else {
+        distance = enter;
+        normal = Point{0, m_direction.y > 0 ? -1.0f : 1.0f};
+    }
+    return true;
+}
+
+/**
+ * @brief Start walking the grid at the cell which contains the given point of the ray
+ * @param ray The ray to follow
+ * @param grid_origin The upper left corner of the cell (0,0) in world coordinates
+ * @param cell_w The width of each cell
+ * @param cell_h The height of each cell
+ * @param from The distance along the ray to start at
+ * @param to The distance along the ray to stop at, usually the exit of Ray::clip()
+ */
+GridWalk::GridWalk(const Ray& ray, Point grid_origin, float cell_w, float cell_h, float from, float to) :
+m_enter{from}, m_to{to}
+{
+    const Point start = ray.at(from);
+    const Point dir = ray.get_direction();
+    m_x = static_cast<int>(std::floor((start.x - grid_origin.x) / cell_w));
+    m_y = static_cast<int>(std::floor((start.y - grid_origin.y) / cell_h));
+
+    if(dir.x != 0) {
+        m_step_x = dir.x > 0 ? 1 : -1;
+        float border = grid_origin.x + (dir.x > 0 ? m_x + 1 : m_x) * cell_w;
+        m_next_x = from + (border - start.x) / dir.x;
+        m_delta_x = cell_w / std::abs(dir.x);
+    }
+    else {
+        m_step_x = 0;
+        m_next_x = INF;
+        m_delta_x = INF;
+    }
+
+    if(dir.y != 0) {
+        m_step_y = dir.y > 0 ? 1 : -1;
+        float border = grid_origin.y + (dir.y > 0 ? m_y + 1 : m_y) * cell_h;
+        m_next_y = from + (border - start.y) / dir.y;
+        m_delta_y = cell_h / std::abs(dir.y);
+    }
+    else {
+        m_step_y = 0;
+        m_next_y = INF;
+        m_delta_y = INF;
+    }
+}
+
+/**
+ * @brief Step into the next cell along the ray
+ * @return False if the ray ends before reaching the next cell
+ *
+ * The intervals [get_enter(), get_exit()) of all visited cells cover the ray without gaps or overlaps.
+ */
+bool GridWalk::next() {
+    if(m_next_x < m_next_y) {
+        m_enter = m_next_x;
+        m_x += m_step_x;
+        m_next_x += m_delta_x;
+    }
+    else {
+        m_enter = m_next_y;
+        m_y += m_step_y;
+        m_next_y += m_delta_y;
+    }
+    return m_enter < m_to;
+}
+
+}} // namespace salmon::internal
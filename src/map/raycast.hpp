@@ -0,0 +1,102 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RAYCAST_HPP_INCLUDED
+#define RAYCAST_HPP_INCLUDED
+
+#include <algorithm>
+
+#include "map/tile.hpp"
+#include "util/game_types.hpp"
+#include "util/hitbox.hpp"
+
+namespace salmon { namespace internal {
+
+class Actor;
+
+/**
+ * @brief A segment in world coordinates given by its origin, direction and length
+ *
+ * The direction gets normalized, so every distance along the ray is measured in pixels.
+ */
+class Ray {
+    public:
+        Ray(Point origin, Point direction, float length);
+
+        bool clip(const Rect& rect, float& enter, float& exit) const;
+        bool intersect(const Rect& rect, float& distance, Point& normal) const;
+
+        /// Returns the point at the given distance from the origin
+        Point at(float distance) const {return Point{m_origin.x + m_direction.x * distance, m_origin.y + m_direction.y * distance};}
+
+        Point get_origin() const {return m_origin;}
+        Point get_direction() const {return m_direction;}
+        float get_length() const {return m_length;}
+        bool valid() const {return m_length > 0;}
+
+    private:
+        Point m_origin;
+        Point m_direction;
+        float m_length;
+};
+
+/**
+ * @brief Visits the cells of a uniform grid in the order a ray passes them
+ *
+ * Implements the traversal by Amanatides and Woo. Each step crosses exactly one cell
+ * border, so the cells of a long ray are found without testing any cell it misses.
+ */
+class GridWalk {
+    public:
+        GridWalk(const Ray& ray, Point grid_origin, float cell_w, float cell_h, float from, float to);
+
+        bool next();
+
+        /// Returns the column of the current cell
+        int get_x() const {return m_x;}
+        /// Returns the row of the current cell
+        int get_y() const {return m_y;}
+        /// Returns the distance at which the ray enters the current cell
+        float get_enter() const {return m_enter;}
+        /// Returns the distance at which the ray leaves the current cell
+        float get_exit() const {return std::min(m_next_x, m_next_y);}
+
+    private:
+        int m_x, m_y;
+        int m_step_x, m_step_y;
+        float m_next_x, m_next_y;   // Distance to the next vertical and horizontal cell border
+        float m_delta_x, m_delta_y; // Distance between two vertical or horizontal cell borders
+        float m_enter;
+        float m_to;
+};
+
+/// The first contact of a ray with a hitbox of a tile or an actor
+struct RaycastHit {
+    Point point;  ///< Where the ray enters the hitbox
+    Point normal; ///< Unit normal of the side which got hit, zero if the ray starts inside the hitbox
+    float distance = 0;
+    HitboxId hitbox = HitboxNames::DEFAULT;
+    Actor* actor = nullptr; ///< The actor which got hit, nullptr if it was a tile
+    TileCollider tile;      ///< The tile which got hit, only valid if actor is nullptr. Points into the tables of the TilesetCollection
+
+    bool operator<(const RaycastHit& other) const {return distance < other.distance;}
+};
+
+}} // namespace salmon::internal
+
+#endif // RAYCAST_HPP_INCLUDED
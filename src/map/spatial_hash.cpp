@@ -0,0 +1,106 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/spatial_hash.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace salmon { namespace internal {
+
+constexpr unsigned SpatialHash::MAX_CELLS;
+
+/**
+ * @brief Sort the rects into grid cells and collect the pairs sharing a cell
+ * @param bounds The rects to check, empty ones never form a pair
+ * @param filters The collision filter of each rect, pairs which don't accept each other are dropped
+ */
+void SpatialHash::build(const std::vector<Rect>& bounds, const std::vector<CollisionFilter>& filters) {
+    m_entries.clear();
+    m_oversized.clear();
+    m_pairs.clear();
+    m_bounds = Rect{0,0,0,0};
+
+    // Determine cell size by the mean extent of the rects
+    float total = 0;
+    unsigned count = 0;
+    for(const Rect& b : bounds) {
+        if(b.empty()) {continue;}
+        total += std::max(b.w, b.h);
+        count++;
+        if(m_bounds.empty()) {m_bounds = b; continue;}
+        float x2 = std::max(m_bounds.x + m_bounds.w, b.x + b.w);
+        float y2 = std::max(m_bounds.y + m_bounds.h, b.y + b.h);
+        m_bounds.x = std::min(m_bounds.x, b.x);
+        m_bounds.y = std::min(m_bounds.y, b.y);
+        m_bounds.w = x2 - m_bounds.x;
+        m_bounds.h = y2 - m_bounds.y;
+    }
+    // A single rect can't form a pair, but still gets registered for queries
+    if(count == 0) {return;}
+    const float cell_size = std::max(2.0f * total / count, 1.0f);
+    m_cell_size = cell_size;
+
+    for(unsigned i = 0; i < bounds.size(); i++) {
+        const Rect& b = bounds[i];
+        if(b.empty()) {continue;}
+        Sint32 x_from = static_cast<Sint32>(std::floor(b.x / cell_size));
+        Sint32 x_to = static_cast<Sint32>(std::floor((b.x + b.w) / cell_size));
+        Sint32 y_from = static_cast<Sint32>(std::floor(b.y / cell_size));
+        Sint32 y_to = static_cast<Sint32>(std::floor((b.y + b.h) / cell_size));
+        Uint64 cells = static_cast<Uint64>(x_to - x_from + 1) * static_cast<Uint64>(y_to - y_from + 1);
+        if(cells > MAX_CELLS) {
+            m_oversized.push_back(i);
+            continue;
+        }
+        for(Sint32 y = y_from; y <= y_to; y++) {
+            for(Sint32 x = x_from; x <= x_to; x++) {
+                m_entries.push_back(CellEntry{cell_key(x, y), i});
+            }
+        }
+    }
+
+    // Pair up all rects of each cell
+    std::sort(m_entries.begin(), m_entries.end());
+    for(size_t first = 0; first < m_entries.size();) {
+        size_t last = first + 1;
+        while(last < m_entries.size() && m_entries[last].cell == m_entries[first].cell) {last++;}
+        for(size_t a = first; a < last; a++) {
+            const CollisionFilter& filter = filters[m_entries[a].index];
+            for(size_t b = a + 1; b < last; b++) {
+                if(!filter.accepts(filters[m_entries[b].index])) {continue;}
+                m_pairs.emplace_back(m_entries[a].index, m_entries[b].index);
+            }
+        }
+        first = last;
+    }
+
+    // Oversized rects are paired with everything
+    for(unsigned o : m_oversized) {
+        for(unsigned i = 0; i < bounds.size(); i++) {
+            if(i == o || bounds[i].empty() || !filters[o].accepts(filters[i])) {continue;}
+            m_pairs.emplace_back(std::min(i, o), std::max(i, o));
+        }
+    }
+
+    // Rects sharing multiple cells form duplicate pairs
+    std::sort(m_pairs.begin(), m_pairs.end());
+    m_pairs.erase(std::unique(m_pairs.begin(), m_pairs.end()), m_pairs.end());
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SPATIAL_HASH_HPP_INCLUDED
+#define SPATIAL_HASH_HPP_INCLUDED
+
+#include <SDL.h>
+#include <algorithm>
+#include <vector>
+#include <utility>
+
+#include "actor/collision_filter.hpp"
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Uniform grid broad phase which finds all pairs of possibly overlapping rects
+ *
+ * Each rect gets registered in every grid cell it touches. The cell size adapts to the
+ * mean extent of the rects, so each rect only touches a few cells. Instead of a hash map
+ * the (cell, rect) entries get sorted, which groups the rects of each cell without any
+ * per cell allocations. All buffers are kept between builds.
+ *
+ * The cells of the last build can be queried, e.g. to walk them along a ray.
+ */
+class SpatialHash {
+    public:
+        static constexpr unsigned MAX_CELLS = 64; ///< Rects touching more cells get tested against all others
+
+        void build(const std::vector<Rect>& bounds, const std::vector<CollisionFilter>& filters);
+
+        /// Returns the candidate pairs of the last build sorted by first and second index, first < second
+        const std::vector<std::pair<unsigned, unsigned>>& get_pairs() const {return m_pairs;}
+
+        /// Returns the edge length of the square cells, the cell (0,0) starts at the world origin
+        float get_cell_size() const {return m_cell_size;}
+        /// Returns the smallest rect enclosing all rects of the last build
+        const Rect& get_bounds() const {return m_bounds;}
+        /// Returns the rects of the last build which got too big to be registered in cells
+        const std::vector<unsigned>& get_oversized() const {return m_oversized;}
+
+        /// Calls the function with the index of each rect registered in the cell in ascending order
+        template<class Function>
+        void for_each_in_cell(Sint32 x, Sint32 y, Function function) const {
+            const Uint64 cell = cell_key(x, y);
+            auto it = std::lower_bound(m_entries.begin(), m_entries.end(), CellEntry{cell, 0});
+            for(; it != m_entries.end() && it->cell == cell; ++it) {function(it->index);}
+        }
+
+    private:
+        static Uint64 cell_key(Sint32 x, Sint32 y) {
+            return (static_cast<Uint64>(static_cast<Uint32>(x)) << 32) | static_cast<Uint32>(y);
+        }
+
+        struct CellEntry {
+            Uint64 cell;
+            unsigned index;
+            bool operator<(const CellEntry& other) const {
+                return cell != other.cell ? cell < other.cell : index < other.index;
+            }
+        };
+
+        float m_cell_size = 1.0f;
+        Rect m_bounds;
+        std::vector<CellEntry> m_entries;
+        std::vector<unsigned> m_oversized;
+        std::vector<std::pair<unsigned, unsigned>> m_pairs;
+};
+
+}} // namespace salmon::internal
+
+#endif // SPATIAL_HASH_HPP_INCLUDED
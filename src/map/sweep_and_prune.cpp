@@ -0,0 +1,189 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/sweep_and_prune.hpp"
+
+#include <algorithm>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Register a new rect
+ * @return The handle which identifies the rect in all pairs until it gets removed
+ */
+unsigned SweepAndPrune::add(const Rect& bounds) {
+    unsigned proxy;
+    if(m_free.empty()) {
+        proxy = m_bounds.size();
+        m_bounds.push_back(bounds);
+        m_alive.push_back(true);
+    }
+    else {
+        proxy = m_free.back();
+        m_free.pop_back();
+        m_bounds[proxy] = bounds;
+        m_alive[proxy] = true;
+    }
+    // The ends get appended and sorted in on the next update
+    m_endpoints.push_back(Endpoint{0, proxy, false});
+    m_endpoints.push_back(Endpoint{0, proxy, true});
+    m_added++;
+    m_moved = true;
+    return proxy;
+}
+
+/// Set the new bounds of a rect, which take effect on the next update
+void SweepAndPrune::move(unsigned proxy, const Rect& bounds) {
+    Rect& old = m_bounds[proxy];
+    if(old.x == bounds.x && old.y == bounds.y && old.w == bounds.w && old.h == bounds.h) {return;}
+    old = bounds;
+    m_moved = true;
+}
+
+/// Unregister a rect, its pairs end with the next update
+void SweepAndPrune::remove(unsigned proxy) {
+    m_alive[proxy] = false;
+    m_released.push_back(proxy);
+    m_moved = true;
+}
+
+/// Remove all rects
+void SweepAndPrune::clear() {
+    *this = SweepAndPrune();
+}
+
+/**
+ * @brief Update the overlapping pairs after rects were added, moved or removed
+ *
+ * If only few rects were added, the ends get re-sorted by insertion sort, which is
+ * nearly linear for small movements. Otherwise everything gets sorted from scratch.
+ */
+void SweepAndPrune::update() {
+    if(m_moved) {
+        // Drop the ends of removed rects
+        m_endpoints.erase(std::remove_if(m_endpoints.begin(), m_endpoints.end(),
+                                         [this](const Endpoint& e){return !m_alive[e.proxy];}),
+                          m_endpoints.end());
+
+        if(m_added * 4 > m_endpoints.size()) {rebuild();}
+        else {resort();}
+        m_added = 0;
+        m_moved = false;
+    }
+
+    // Keep the pairs which also overlap on the other axis
+    m_pairs.clear();
+    for(auto it = m_axis_pairs.begin(); it != m_axis_pairs.end();) {
+        unsigned a = static_cast<unsigned>(*it >> 32);
+        unsigned b = static_cast<unsigned>(*it);
+        if(!m_alive[a] || !m_alive[b]) {
+            it = m_axis_pairs.erase(it);
+            continue;
+        }
+        if(!m_bounds[a].empty() && !m_bounds[b].empty() && m_bounds[a].has_intersection(m_bounds[b])) {
+            m_pairs.emplace_back(a, b);
+        }
+        ++it;
+    }
+
+    // Handles of removed rects are safe to reuse now that their pairs are dropped
+    m_free.insert(m_free.end(), m_released.begin(), m_released.end());
+    m_released.clear();
+}
+
+/// Returns the key of a pair in m_axis_pairs, which is the same for both orders
+Uint64 SweepAndPrune::make_key(unsigned a, unsigned b) {
+    if(a > b) {std::swap(a, b);}
+    return (static_cast<Uint64>(a) << 32) | b;
+}
+
+/// Choose the axis with the larger spread, sort all ends and sweep them to find the overlapping pairs
+void SweepAndPrune::rebuild() {
+    float x_min = 0, x_max = 0, y_min = 0, y_max = 0;
+    bool first = true;
+    for(unsigned proxy = 0; proxy < m_bounds.size(); proxy++) {
+        if(!m_alive[proxy]) {continue;}
+        const Rect& b = m_bounds[proxy];
+        if(first) {
+            x_min = x_max = b.x;
+            y_min = y_max = b.y;
+            first = false;
+        }
+        x_min = std::min(x_min, b.x);
+        x_max = std::max(x_max, b.x);
+        y_min = std::min(y_min, b.y);
+        y_max = std::max(y_max, b.y);
+    }
+    m_x_axis = (x_max - x_min) >= (y_max - y_min);
+
+    for(Endpoint& e : m_endpoints) {
+        e.value = e.is_max ? upper(e.proxy) : lower(e.proxy);
+    }
+    std::sort(m_endpoints.begin(), m_endpoints.end(), precedes);
+
+    m_axis_pairs.clear();
+    m_active.clear();
+    for(const Endpoint& e : m_endpoints) {
+        if(e.is_max) {
+            auto found = std::find(m_active.begin(), m_active.end(), e.proxy);
+            if(found != m_active.end()) {
+                *found = m_active.back();
+                m_active.pop_back();
+            }
+        }
+        // Intervals without length never overlap
+        else if(lower(e.proxy) < upper(e.proxy)) {
+            for(unsigned other : m_active) {
+                m_axis_pairs.insert(make_key(e.proxy, other));
+            }
+            m_active.push_back(e.proxy);
+        }
+    }
+}
+
+/**
+ * @brief Re-sort the ends via insertion sort and update the pairs by the swaps
+ *
+ * A lower end passing an upper end of another rect may start an overlap,
+ * an upper end passing a lower end always stops one.
+ */
+void SweepAndPrune::resort() {
+    for(Endpoint& e : m_endpoints) {
+        e.value = e.is_max ? upper(e.proxy) : lower(e.proxy);
+    }
+    for(size_t i = 1; i < m_endpoints.size(); i++) {
+        const Endpoint e = m_endpoints[i];
+        size_t j = i;
+        for(; j > 0 && precedes(e, m_endpoints[j - 1]); j--) {
+            const Endpoint& other = m_endpoints[j - 1];
+            if(e.proxy != other.proxy && e.is_max != other.is_max) {
+                if(!e.is_max) {
+                    // Checking with the final values keeps the cache exact, since each pair of ends swaps at most once
+                    if(overlap_on_axis(e.proxy, other.proxy)) {m_axis_pairs.insert(make_key(e.proxy, other.proxy));}
+                }
+                else {
+                    m_axis_pairs.erase(make_key(e.proxy, other.proxy));
+                }
+            }
+            m_endpoints[j] = other;
+        }
+        m_endpoints[j] = e;
+    }
+}
+
+}} // namespace salmon::internal
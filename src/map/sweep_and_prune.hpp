@@ -0,0 +1,91 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SWEEP_AND_PRUNE_HPP_INCLUDED
+#define SWEEP_AND_PRUNE_HPP_INCLUDED
+
+#include <SDL.h>
+#include <vector>
+#include <utility>
+#include <unordered_set>
+
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Broad phase which keeps the rects sorted along one axis between updates
+ *
+ * Each rect is a proxy with a stable handle. The interval ends of all proxies stay sorted
+ * along the axis of the larger spread, and the pairs overlapping on that axis are cached.
+ * When proxies move only a little, re-sorting via insertion sort touches few entries and
+ * each swap of two ends tells if a pair starts or stops overlapping. This suits many
+ * actors which move steadily, like in a shoot 'em up.
+ */
+class SweepAndPrune {
+    public:
+        typedef std::pair<unsigned, unsigned> Pair;
+
+        unsigned add(const Rect& bounds);
+        void move(unsigned proxy, const Rect& bounds);
+        void remove(unsigned proxy);
+        void clear();
+
+        void update();
+
+        /// Returns the overlapping pairs of proxies in no particular order, first < second
+        const std::vector<Pair>& get_pairs() const {return m_pairs;}
+
+    private:
+        struct Endpoint {
+            float value;
+            unsigned proxy;
+            bool is_max;
+        };
+
+        /// Sort order of the ends, at equal values the upper ends go first so touching rects don't overlap
+        static bool precedes(const Endpoint& a, const Endpoint& b) {
+            return a.value < b.value || (a.value == b.value && a.is_max && !b.is_max);
+        }
+        static Uint64 make_key(unsigned a, unsigned b);
+
+        float lower(unsigned proxy) const {return m_x_axis ? m_bounds[proxy].x : m_bounds[proxy].y;}
+        float upper(unsigned proxy) const {return m_x_axis ? m_bounds[proxy].x + m_bounds[proxy].w : m_bounds[proxy].y + m_bounds[proxy].h;}
+        bool overlap_on_axis(unsigned a, unsigned b) const {return lower(a) < upper(b) && lower(b) < upper(a);}
+
+        void rebuild();
+        void resort();
+
+        std::vector<Rect> m_bounds; ///< Bounds of each proxy by handle
+        std::vector<bool> m_alive;
+        std::vector<unsigned> m_free;     ///< Handles which may be reused
+        std::vector<unsigned> m_released; ///< Handles removed since the last update, reused after it
+
+        std::vector<Endpoint> m_endpoints;    ///< The interval ends of all proxies, sorted along the axis
+        std::unordered_set<Uint64> m_axis_pairs; ///< Pairs overlapping on the axis, see make_key()
+        std::vector<unsigned> m_active;       ///< Scratch list of open intervals while rebuilding
+        bool m_x_axis = true;
+        bool m_moved = false;  ///< Some proxy was added, moved or removed since the last update
+        unsigned m_added = 0;  ///< Number of proxies added since the last update
+
+        std::vector<Pair> m_pairs;
+};
+
+}} // namespace salmon::internal
+
+#endif // SWEEP_AND_PRUNE_HPP_INCLUDED
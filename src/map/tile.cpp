@@ -21,6 +21,7 @@
 #include <string>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 #include "actor/actor.hpp"
 #include "graphics/texture.hpp"
@@ -35,29 +36,30 @@ namespace salmon { namespace internal {
  * @brief Construct and registers a fully functional tile
  * @param ts Pointer to the corresponding tileset
  * @param clp @c SDL_Rect which determines the snippet of the whole tileset image
+ * @param gid The global tile id under which the tile gets registered
  */
-Tile::Tile(Tileset* ts, const SDL_Rect& clp) :
-mp_tileset{ts}, m_clip{clp}
+Tile::Tile(Tileset* ts, const SDL_Rect& clp, Uint32 gid) :
+mp_tileset{ts}, m_gid{gid}, m_clip{clp}
 {
 
 }
 
 /**
  * @brief Parse tile information of standard tiles
- * @param source The @c XMLElement from the tileset
+ * @param source The @c Element from the tileset
  * @return an @c XMLError object which indicates success or error type
  *
  * Determines the tile type and calls the corresponding tile parsers
  */
-tinyxml2::XMLError Tile::parse_tile(tinyxml2::XMLElement* source, bool skip_properties) {
+tinyxml2::XMLError Tile::parse_tile(const Element* source, bool skip_properties) {
     using namespace tinyxml2;
 
     XMLError eResult;
 
     // Parse user specified properties of the tile (only speed right now)
-    XMLElement* p_tile_properties = source->FirstChildElement("properties");
+    const Element* p_tile_properties = source->FirstChildElement("properties");
     if(!skip_properties && p_tile_properties != nullptr) {
-        XMLElement* p_property = p_tile_properties->FirstChildElement("property");
+        const Element* p_property = p_tile_properties->FirstChildElement("property");
         while(p_property != nullptr) {
             const char* p_name;
             const char* p_value;
@@ -79,9 +81,9 @@ tinyxml2::XMLError Tile::parse_tile(tinyxml2::XMLElement* source, bool skip_prop
     }
 
     // Parse the hitbox of the individual tile
-    XMLElement* p_objgroup = source->FirstChildElement("objectgroup");
+    const Element* p_objgroup = source->FirstChildElement("objectgroup");
     if(p_objgroup != nullptr) {
-        XMLElement* p_object = p_objgroup->FirstChildElement("object");
+        const Element* p_object = p_objgroup->FirstChildElement("object");
         if(p_object != nullptr) {
             eResult = parse::hitboxes(p_object, m_hitboxes);
             if(eResult != XML_SUCCESS) {
@@ -92,12 +94,11 @@ tinyxml2::XMLError Tile::parse_tile(tinyxml2::XMLElement* source, bool skip_prop
     }
 
     // Parse the animation info
-    XMLElement* p_animation = source->FirstChildElement("animation");
+    const Element* p_animation = source->FirstChildElement("animation");
     if(p_animation != nullptr) {
-        XMLElement* p_frame = p_animation->FirstChildElement("frame");
+        const Element* p_frame = p_animation->FirstChildElement("frame");
 
         m_animated = true;
-        mp_tileset->get_ts_collection().set_tile_animated(this);
 
         // Parse each animation frame
         while(p_frame != nullptr) {
@@ -108,30 +109,35 @@ tinyxml2::XMLError Tile::parse_tile(tinyxml2::XMLElement* source, bool skip_prop
             eResult = p_frame->QueryUnsignedAttribute("duration", &duration);
             if(eResult != XML_SUCCESS) return eResult;
 
-            // We don't use local, but global tile ids for animation
-            anim_tile_id += mp_tileset->get_first_gid();
+            // Resolve the frame tile once so rendering doesn't need to look it up by gid
+            // Its hitboxes are referenced since they may get parsed after this tile
+            const Tile* frame_tile = mp_tileset->get_ts_collection().get_tile(anim_tile_id + mp_tileset->get_first_gid());
+            if(frame_tile == nullptr) {
+                Logger(Logger::error) << "Animation frame refers to invalid tile id " << anim_tile_id;
+                return XML_ERROR_PARSING_ATTRIBUTE;
+            }
 
             // The actual registration of the frame
-            m_anim_ids.push_back(static_cast<Uint32>(anim_tile_id));
-            m_durations.push_back(duration);
+            m_frames.push_back(AnimFrame{frame_tile->m_clip, &frame_tile->m_hitboxes, duration});
 
             // Go to next frame
             p_frame = p_frame->NextSiblingElement("frame");
         }
+        init_frame_table();
     }
     return XML_SUCCESS;
 }
 
 /**
  * @brief Parse tile information of actor animation tiles
- * @param source The @c XMLElement from the tileset
+ * @param source The @c Element from the tileset
  * @param first_gid The first global tile id of the tileset
  * @param base_map Reference to map object to register as actor animation
  * @return an @c XMLError object which indicates success or error type
  *
  * Determines the tile type and calls the corresponding tile parsers
  */
-tinyxml2::XMLError Tile::parse_actor_anim(tinyxml2::XMLElement* source) {
+tinyxml2::XMLError Tile::parse_actor_anim(const Element* source) {
     using namespace tinyxml2;
     XMLError eResult;
 
@@ -146,9 +152,9 @@ tinyxml2::XMLError Tile::parse_actor_anim(tinyxml2::XMLElement* source) {
 
 
     // Parse user specified properties of the tile
-    XMLElement* p_tile_properties = source->FirstChildElement("properties");
+    const Element* p_tile_properties = source->FirstChildElement("properties");
     if(p_tile_properties != nullptr) {
-        XMLElement* p_property = p_tile_properties->FirstChildElement("property");
+        const Element* p_property = p_tile_properties->FirstChildElement("property");
         while(p_property != nullptr) {
             const char* p_name;
             p_name = p_property->Attribute("name");
@@ -254,8 +260,8 @@ tinyxml2::XMLError Tile::parse_actor_anim(tinyxml2::XMLElement* source) {
         return XML_NO_ATTRIBUTE;
     }
 
-    else if(m_animated && m_trigger_frame >= m_anim_ids.size()) {
-        Logger(Logger::error) << "The trigger frame " << m_trigger_frame << " is out of the animation range from 0 to " << m_anim_ids.size() - 1;
+    else if(m_animated && m_trigger_frame >= m_frames.size()) {
+        Logger(Logger::error) << "The trigger frame " << m_trigger_frame << " is out of the animation range from 0 to " << m_frames.size() - 1;
         return XML_ERROR_PARSING_ATTRIBUTE;
     }
 
@@ -268,13 +274,13 @@ tinyxml2::XMLError Tile::parse_actor_anim(tinyxml2::XMLElement* source) {
 
 /**
  * @brief Parse tile information of actor template tiles
- * @param source The @c XMLElement from the tileset
+ * @param source The @c Element from the tileset
  * @param base_map Reference to map object to register as actor template
  * @return an @c XMLError object which indicates success or error type
  *
  * Parse the tile via the static Actor method @c add_template
  */
-tinyxml2::XMLError Tile::parse_actor_templ(tinyxml2::XMLElement* source) {
+tinyxml2::XMLError Tile::parse_actor_templ(const Element* source) {
     using namespace tinyxml2;
     XMLError eResult;
 
@@ -293,34 +299,79 @@ tinyxml2::XMLError Tile::parse_actor_templ(tinyxml2::XMLElement* source) {
 /**
  * @brief Returns area of tileset image corresponding to tile
  *
- * For animated tiles the clip is the one of the current animation tile id,
- * instead of recursively calling this function again, get_clip_self is used which
- * always yields the normal clip value of the tile.
+ * For animated tiles the clip is the one of the current animation frame,
+ * which got resolved at load time. Animation frames which are animated themselves
+ * aren't daisy chained.
  *
  * If not animated the normal clip value is returned
  */
 const SDL_Rect& Tile::get_clip() const {
-    const TilesetCollection& tsc = mp_tileset->get_ts_collection();
     if(m_animated) {
-        // Avoids daisy chaining of animated tiles
-        return tsc.get_tile(m_anim_ids[m_current_id])->get_clip_self();
+        return m_frames[current_frame()].clip;
     }
     else {
         return m_clip;
     }
 }
 
+/**
+ * @brief Build the prefix sums of the frame durations
+ *
+ * Enables looking up the frame of any point in time via binary search
+ * or via a single division if all frames share the same duration
+ */
+void Tile::init_frame_table() {
+    m_frame_ends.clear();
+    Uint32 end = 0;
+    for(const AnimFrame& frame : m_frames) {
+        end += frame.duration;
+        m_frame_ends.push_back(end);
+    }
+    m_uniform_duration = 0;
+    if(!m_frames.empty() && std::all_of(m_frames.begin(), m_frames.end(),
+                                        [this](const AnimFrame& f){return f.duration == m_frames.front().duration;})) {
+        m_uniform_duration = m_frames.front().duration;
+    }
+}
+
+/**
+ * @brief Return the animation frame which is active at the supplied time
+ * @param time The time in milliseconds since the start of the animation
+ */
+unsigned Tile::frame_at(Uint32 time) const {
+    if(m_frame_ends.empty() || m_frame_ends.back() == 0) {return 0;}
+    time %= m_frame_ends.back();
+    if(m_uniform_duration != 0) {
+        return time / m_uniform_duration;
+    }
+    return std::upper_bound(m_frame_ends.begin(), m_frame_ends.end(), time) - m_frame_ends.begin();
+}
+
+/**
+ * @brief Return the currently active animation frame
+ *
+ * Map tiles follow the shared animation clock of the tileset collection, so their
+ * frame only gets looked up when they are actually drawn or queried.
+ * Tiles which got animated explicitly, like the animation tiles of actors, use their own state.
+ */
+unsigned Tile::current_frame() const {
+    if(m_local_anim) {return m_current_id;}
+    return frame_at(mp_tileset->get_ts_collection().get_anim_time());
+}
+
 /// Initialize the tile to the supplied timestamp and first frame
 void Tile::init_anim(Uint32 time) {
+    m_local_anim = true;
     m_current_id = 0;
     m_anim_timestamp = time;
 }
 
 /// Set tile to specific animation frame
 bool Tile::set_frame(int anim_frame, Uint32 time) {
-    if(anim_frame < 0 || static_cast<size_t>(anim_frame) >= m_anim_ids.size()) {
+    if(anim_frame < 0 || static_cast<size_t>(anim_frame) >= m_frames.size()) {
         return false;
     }
+    m_local_anim = true;
     m_current_id = static_cast<unsigned>(anim_frame);
     m_anim_timestamp = time;
     return true;
@@ -353,6 +404,12 @@ bool Tile::push_anim(float speed, Uint32 time) {
  */
 AnimSignal Tile::push_anim_trigger(float speed, Uint32 time) {
     if(!m_animated) {return AnimSignal::wrap;}
+    if(!m_local_anim) {
+        // Continue from the frame of the shared clock
+        m_current_id = current_frame();
+        m_anim_timestamp = time;
+        m_local_anim = true;
+    }
     // if(speed < 0.0f) {speed = 0.0f;}
     m_time_delta += speed * (time - m_anim_timestamp);
     m_anim_timestamp = time;
@@ -362,13 +419,13 @@ AnimSignal Tile::push_anim_trigger(float speed, Uint32 time) {
     if(m_time_delta < 0) {
 
         unsigned id_before = m_current_id - 1;
-        if(m_current_id == 0) {id_before = m_anim_ids.size() - 1;}
+        if(m_current_id == 0) {id_before = m_frames.size() - 1;}
 
-        while(-m_time_delta >= m_durations[id_before]) {
-            m_time_delta += m_durations[id_before];
+        while(-m_time_delta >= m_frames[id_before].duration) {
+            m_time_delta += m_frames[id_before].duration;
 
             if(m_current_id == 0) {
-                m_current_id = m_anim_ids.size() - 1;
+                m_current_id = m_frames.size() - 1;
                 if(sig < AnimSignal::wrap) {sig = AnimSignal::wrap;}
 
                 id_before = m_current_id - 1;
@@ -377,7 +434,7 @@ AnimSignal Tile::push_anim_trigger(float speed, Uint32 time) {
                 m_current_id--;
 
                 id_before = m_current_id - 1;
-                if(m_current_id == 0) {id_before = m_anim_ids.size() - 1;}
+                if(m_current_id == 0) {id_before = m_frames.size() - 1;}
             }
 
             if(m_current_id == m_trigger_frame) {
@@ -388,10 +445,10 @@ AnimSignal Tile::push_anim_trigger(float speed, Uint32 time) {
     }
 
     // Forward animation
-    while(m_time_delta >= m_durations[m_current_id]) {
-        m_time_delta -= m_durations[m_current_id];
+    while(m_time_delta >= m_frames[m_current_id].duration) {
+        m_time_delta -= m_frames[m_current_id].duration;
         m_current_id++;
-        if(m_current_id >= m_anim_ids.size()) {
+        if(m_current_id >= m_frames.size()) {
             m_current_id = 0;
             if(sig < AnimSignal::wrap) {sig = AnimSignal::wrap;}
         }
@@ -436,6 +493,22 @@ void Tile::render_extra(float x, float y, double angle, bool x_flip, bool y_flip
     return;
 }
 
+/**
+ * @brief Render a tile object flipped and rotated around its center
+ * @param x, y The specified coordinates
+ * @param flip The table entry of the tile's flip flags
+ */
+void Tile::render_extra(float x, float y, const TileFlip& flip) const {
+    const TilesetCollection& tsc = mp_tileset->get_ts_collection();
+    x += mp_tileset->get_x_offset();
+    y += mp_tileset->get_y_offset() - (mp_tileset->get_tile_height() - tsc.get_tile_h());
+    const Texture* image = mp_tileset->get_image_pointer();
+
+    const SDL_Rect& clip = get_clip();
+    SDL_Point center{(clip.w + 1) / 2, (clip.h + 1) / 2};
+    image->render_extra(round(x), round(y), &clip, flip.angle, flip.sdl_flip, &center);
+}
+
 /**
  * @brief Render a tile object to a rect
  * @param dest The rendering rect
@@ -477,53 +550,55 @@ void Tile::render_extra(Rect& dest, double angle, bool x_flip, bool y_flip, floa
 
 /**
  * @brief Return the active hitbox by name
- * @param name The name/type of the hitbox
+ * @param id The interned name/type of the hitbox
  * @param aligned Sets the origin of hitbox relative to tile grid
  *
  * The active hitbox is usually the hitbox stored within the m_hitbox member variable
  * but if the tile is animated it first checks if the currently active frame has the
  * hitbox of the given name and returns it instead
  */
-Rect Tile::get_hitbox(std::string name, bool aligned) const {
+Rect Tile::get_hitbox(HitboxId id, bool aligned) const {
     if(m_animated) {
-        const TilesetCollection& tsc = mp_tileset->get_ts_collection();
         // Animation frame which is an animation itself doesn't make sense!
-        // Explicitly request own hitbox
-        Rect hitbox = tsc.get_tile(m_anim_ids[m_current_id])->get_hitbox_self(name, aligned);
-        if(!hitbox.empty()) {
-            return hitbox;
+        // Only the frame tile's own hitboxes are considered
+        const Rect* hitbox = m_frames[current_frame()].hitboxes->find(id);
+        if(hitbox != nullptr && !hitbox->empty()) {
+            return offset_hitbox(*hitbox, aligned);
         }
     }
-    return get_hitbox_self(name, aligned);
+    return get_hitbox_self(id, aligned);
 }
 
 /**
  * @brief Return the hitbox of this tile by name
- * @param name The name/type of the hitbox
+ * @param id The interned name/type of the hitbox
  * @param aligned Sets the origin of hitbox relative to tile grid
  */
-Rect Tile::get_hitbox_self(std::string name, bool aligned) const {
-    if(m_hitboxes.find(name) == m_hitboxes.end()) {
-        // std::cerr << "Could not find hitbox " << type << " for actor " << m_name << "\n";
+Rect Tile::get_hitbox_self(HitboxId id, bool aligned) const {
+    const Rect* hitbox = m_hitboxes.find(id);
+    if(hitbox == nullptr) {
         return Rect{0,0,0,0};
     }
     else{
-        if(aligned) {
-            Rect hitbox = m_hitboxes.at(name);
-            const TilesetCollection& tsc = mp_tileset->get_ts_collection();
-            hitbox.x += mp_tileset->get_x_offset();
-            hitbox.y += mp_tileset->get_y_offset() - (mp_tileset->get_tile_height() - tsc.get_tile_h());
-            return hitbox;
-        }
-        else {
-            Rect hitbox = m_hitboxes.at(name);
-            hitbox.x += mp_tileset->get_x_offset();
-            hitbox.y += mp_tileset->get_y_offset();
-            return hitbox;
-        }
+        return offset_hitbox(*hitbox, aligned);
     }
 }
 
+/**
+ * @brief Apply the tileset offsets to a hitbox of this tile or one of its animation frames
+ * @param hitbox The hitbox with its origin at the upper left corner of the tile
+ * @param aligned Sets the origin of hitbox relative to tile grid
+ */
+Rect Tile::offset_hitbox(Rect hitbox, bool aligned) const {
+    hitbox.x += mp_tileset->get_x_offset();
+    hitbox.y += mp_tileset->get_y_offset();
+    if(aligned) {
+        const TilesetCollection& tsc = mp_tileset->get_ts_collection();
+        hitbox.y -= mp_tileset->get_tile_height() - tsc.get_tile_h();
+    }
+    return hitbox;
+}
+
 /**
  * @brief Return the active hitboxes
  * @param aligned Sets the origin of hitboxes relative to tile grid
@@ -532,31 +607,72 @@ Rect Tile::get_hitbox_self(std::string name, bool aligned) const {
  * but if the tile is animated the hitboxes of the active frame get added and
  * may override the hitboxes of the base tile
  */
-std::map<std::string, Rect> Tile::get_hitboxes(bool aligned) const {
-    if(m_animated) {
-        std::map<std::string, Rect> hitboxes = get_hitboxes_self(aligned);
+HitboxSet Tile::get_hitboxes(bool aligned) const {
+    return get_frame_hitboxes(m_animated ? current_frame() : 0, aligned);
+}
 
-        const TilesetCollection& tsc = mp_tileset->get_ts_collection();
+/**
+ * @brief Return the hitboxes which are active while the given frame is shown
+ * @param frame The animation frame, ignored if the tile isn't animated
+ * @param aligned Sets the origin of hitboxes relative to tile grid
+ *
+ * Like get_hitbox() an empty hitbox of a frame doesn't override the one of the base tile
+ */
+HitboxSet Tile::get_frame_hitboxes(unsigned frame, bool aligned) const {
+    HitboxSet hitboxes = get_hitboxes_self(aligned);
+    if(m_animated) {
         // Animation frame which is an animation itself doesn't make sense!
-        // Explicitly request own hitbox
-        for(const auto& hitbox_pair: tsc.get_tile(m_anim_ids[m_current_id])->get_hitboxes_self(aligned)) {
-            hitboxes[hitbox_pair.first] = hitbox_pair.second;
+        // Only the frame tile's own hitboxes are considered
+        for(const HitboxSet::Entry& hitbox : *m_frames[frame].hitboxes) {
+            if(hitbox.rect.empty()) {continue;}
+            hitboxes.set(hitbox.id, offset_hitbox(hitbox.rect, aligned));
         }
-        return hitboxes;
     }
-    return get_hitboxes_self(aligned);
+    return hitboxes;
+}
+
+/// Return the clip of the given frame, or the clip of the tile if it isn't animated
+const SDL_Rect& Tile::get_frame_clip(unsigned frame) const {
+    return m_animated ? m_frames[frame].clip : m_clip;
 }
 
 /**
  * @brief Return the hitboxes of this tile
  * @param aligned Sets the origin of hitboxes relative to tile grid
  */
-const std::map<std::string, Rect> Tile::get_hitboxes_self(bool aligned) const {
-    std::map<std::string, Rect> hitboxes;
-    for(auto& hb : m_hitboxes) {
-        hitboxes[hb.first] = get_hitbox_self(hb.first, aligned);
+HitboxSet Tile::get_hitboxes_self(bool aligned) const {
+    HitboxSet hitboxes = m_hitboxes;
+    for(HitboxSet::Entry& hitbox : hitboxes) {
+        hitbox.rect = offset_hitbox(hitbox.rect, aligned);
     }
     return hitboxes;
 }
 
+/**
+ * @brief Create the instance of a map tile at a world position
+ * @param tile The tile without flip flags
+ * @param tile_id The gid of the tile including its flip flags
+ * @param x, y The upper left corner of the tile in world coordinates
+ */
+TileInstance TileInstance::place(Tile* tile, Uint32 tile_id, float x, float y) {
+    Transform trans = {x, y,
+                       static_cast<float>(tile->get_w()),
+                       static_cast<float>(tile->get_h()),
+                       0,0};
+    trans.set_rotation_center(0.5,0.5);
+    const TileFlip& flip = TileFlip::get(tile_id);
+    trans.set_h_flip(flip.h_flip);
+    trans.set_v_flip(flip.v_flip);
+    trans.set_rotation(flip.angle);
+    return {tile, trans};
+}
+
+/// Return the hitbox by id in world coordinates or an empty rect if the tile has none
+Rect TileCollider::get_hitbox(HitboxId id) const {
+    for(const HitboxSet::Entry& entry : *this) {
+        if(entry.id == id) {return get_hitbox(entry);}
+    }
+    return Rect{0,0,0,0};
+}
+
 }} // namespace salmon::internal
@@ -25,7 +25,10 @@
 #include <tinyxml2.h>
 
 #include "transform.hpp"
+#include "map/tile_flip.hpp"
+#include "util/element_tree.hpp"
 #include "util/game_types.hpp"
+#include "util/hitbox.hpp"
 
 namespace salmon { namespace internal {
 
@@ -38,69 +41,93 @@ class Tileset; // forward declaration
 class Tile{
 public:
     Tile() = default;
-    Tile(Tileset* ts, const SDL_Rect& clp); // The initializing constructor
+    Tile(Tileset* ts, const SDL_Rect& clp, Uint32 gid); // The initializing constructor
 
     void render(float x, float y) const;
     void render_extra(float x, float y, double angle, bool x_flip = false, bool y_flip = false, float x_center = 0.5, float y_center = 0.5) const;
+    void render_extra(float x, float y, const TileFlip& flip) const;
     void render(Rect& dest) const; // Resizable render
     void render_extra(Rect& dest, double angle, bool x_flip = false, bool y_flip = false, float x_center = 0.5, float y_center = 0.5) const;
 
-    Rect get_hitbox(std::string name = DEFAULT_HITBOX, bool aligned = false) const;
-    std::map<std::string, Rect> get_hitboxes(bool aligned = false) const;
+    Rect get_hitbox(HitboxId id = HitboxNames::DEFAULT, bool aligned = false) const;
+    Rect get_hitbox(const std::string& name, bool aligned = false) const {return get_hitbox(HitboxNames::find(name), aligned);}
+    HitboxSet get_hitboxes(bool aligned = false) const;
+    HitboxSet get_frame_hitboxes(unsigned frame, bool aligned = false) const;
+    const SDL_Rect& get_frame_clip(unsigned frame) const;
 
-    tinyxml2::XMLError parse_tile(tinyxml2::XMLElement* source, bool skip_properties = false);
-    tinyxml2::XMLError parse_actor_anim(tinyxml2::XMLElement* source);
-    tinyxml2::XMLError parse_actor_templ(tinyxml2::XMLElement* source);
+    tinyxml2::XMLError parse_tile(const Element* source, bool skip_properties = false);
+    tinyxml2::XMLError parse_actor_anim(const Element* source);
+    tinyxml2::XMLError parse_actor_templ(const Element* source);
 
     void init_anim(Uint32 time = SDL_GetTicks());
 
     bool push_anim(float speed = 1.0f, Uint32 time = SDL_GetTicks());
     AnimSignal push_anim_trigger(float speed = 1.0f, Uint32 time = SDL_GetTicks());
     bool set_frame(int anim_frame, Uint32 time = SDL_GetTicks());
-    int get_frame_count() const {return m_anim_ids.size();}
-    int get_current_frame() const {return m_current_id;}
+    int get_frame_count() const {return m_frames.size();}
+    int get_current_frame() const {return current_frame();}
     bool is_valid() const {return mp_tileset != nullptr;}
+    bool is_animated() const {return m_animated;}
 
     std::string get_type() const {return m_type;}
+    Uint32 get_gid() const {return m_gid;}
     Tileset& get_tileset() {return *mp_tileset;}
 
     int get_w() const {return get_clip().w;}
     int get_h() const {return get_clip().h;}
 
 private:
-    Rect get_hitbox_self(std::string name = DEFAULT_HITBOX, bool aligned = false) const;
-    const std::map<std::string, Rect> get_hitboxes_self(bool aligned = false) const;
+    Rect get_hitbox_self(HitboxId id, bool aligned = false) const;
+    HitboxSet get_hitboxes_self(bool aligned = false) const;
+    Rect offset_hitbox(Rect hitbox, bool aligned) const;
 
-    const SDL_Rect& get_clip_self() const {return m_clip;}
     const SDL_Rect& get_clip() const;
 
+    void init_frame_table();
+    unsigned frame_at(Uint32 time) const;
+    unsigned current_frame() const;
+
     Tileset* mp_tileset = nullptr;
+    Uint32 m_gid = 0; // Global id of the tile, copies keep the id of their origin
     SDL_Rect m_clip;
-    std::map<std::string, Rect> m_hitboxes; // Origin at upper left corner of tile
+    HitboxSet m_hitboxes; // Origin at upper left corner of tile
     std::string m_type = "";
     bool m_animated = false;
 
+    /// A single animation frame resolved at load time
+    struct AnimFrame {
+        SDL_Rect clip; ///< Clip of the frame tile within the tileset image
+        const HitboxSet* hitboxes; ///< Hitboxes of the frame tile
+        Uint32 duration; ///< Display time of the frame in ms
+    };
+
     // Variables required for animated tiles
     unsigned m_current_id = 0;
     unsigned m_trigger_frame = 0;
-    std::vector<Uint32> m_anim_ids; // could use Tile* for better performance but greater memory allocation
-    std::vector<unsigned> m_durations;
+    std::vector<AnimFrame> m_frames;
     Uint32 m_anim_timestamp = 0;
     float m_time_delta = 0;
+
+    // Frame lookup by the shared animation clock of the tileset collection
+    std::vector<Uint32> m_frame_ends; // Prefix sums of the frame durations, the last one is the cycle length
+    Uint32 m_uniform_duration = 0; // Duration of every frame if all are equal, else 0
+    bool m_local_anim = false; // True if animated by its own state, e.g. the tile copies of actors
 };
 
 class TileInstance {
     public:
         TileInstance(Tile* tile, Transform t) : m_tile{tile}, m_transform{t} {}
+        static TileInstance place(Tile* tile, Uint32 tile_id, float x, float y);
 
-        Rect get_hitbox(std::string name = DEFAULT_HITBOX, bool aligned = false) const {
-            Rect temp = m_tile->get_hitbox(name,aligned);
+        Rect get_hitbox(HitboxId id = HitboxNames::DEFAULT, bool aligned = false) const {
+            Rect temp = m_tile->get_hitbox(id,aligned);
             m_transform.transform_hitbox(temp);
             return temp;
         }
-        std::map<std::string, Rect> get_hitboxes(bool aligned = false) const {
-            std::map<std::string, Rect> hitboxes = m_tile->get_hitboxes(aligned);
-            for(auto& hb : hitboxes) {m_transform.transform_hitbox(hb.second);;}
+        Rect get_hitbox(const std::string& name, bool aligned = false) const {return get_hitbox(HitboxNames::find(name), aligned);}
+        HitboxSet get_hitboxes(bool aligned = false) const {
+            HitboxSet hitboxes = m_tile->get_hitboxes(aligned);
+            for(auto& hb : hitboxes) {m_transform.transform_hitbox(hb.rect);}
             return hitboxes;
         }
         Tile* get_tile() const {return m_tile;}
@@ -112,6 +139,47 @@ class TileInstance {
         Tile* m_tile = nullptr;
         Transform m_transform;
 };
+
+/**
+ * @brief A map tile placed in the world, reduced to what collision checks need
+ *
+ * The hitboxes are precomputed per flip state by the TilesetCollection, so unlike
+ * a TileInstance no Transform gets built. Only recording a collision needs one.
+ */
+class TileCollider {
+    public:
+        TileCollider() = default;
+        TileCollider(Tile* tile, Uint32 tile_id, float x, float y, const HitboxSet::Entry* first, const HitboxSet::Entry* last)
+            : m_tile{tile}, m_tile_id{tile_id}, m_x{x}, m_y{y}, m_first{first}, m_last{last} {}
+
+        Rect get_hitbox(HitboxId id) const;
+        /// Returns the rect of one of the entries below in world coordinates
+        Rect get_hitbox(const HitboxSet::Entry& entry) const {return Rect{entry.rect.x + m_x, entry.rect.y + m_y, entry.rect.w, entry.rect.h};}
+
+        /// The hitboxes relative to the upper left corner of the tile, sorted by id
+        const HitboxSet::Entry* begin() const {return m_first;}
+        const HitboxSet::Entry* end() const {return m_last;}
+
+        /// Builds the equivalent TileInstance, e.g. to record a collision
+        TileInstance get_instance() const {return TileInstance::place(m_tile, m_tile_id, m_x, m_y);}
+        Tile* get_tile() const {return m_tile;}
+
+    private:
+        Tile* m_tile = nullptr;
+        Uint32 m_tile_id = 0; // Gid including flip flags
+        float m_x = 0;
+        float m_y = 0;
+        const HitboxSet::Entry* m_first = nullptr;
+        const HitboxSet::Entry* m_last = nullptr;
+};
+
+/// Reports each pair of intersecting non-empty hitboxes of a set in world coordinates and a tile, see intersect_hitboxes()
+template<class Report>
+bool intersect_hitboxes(const HitboxSet& first, const TileCollider& tile, Report report) {
+    return intersect_hitboxes(first, [](const HitboxSet::Entry& entry) -> const HitboxSet::Entry& {return entry;},
+                              tile, [&tile](const HitboxSet::Entry& entry) {return HitboxSet::Entry{entry.id, tile.get_hitbox(entry)};},
+                              report);
+}
 }} // namespace salmon::internal
 
 #endif // TILE_HPP_INCLUDED
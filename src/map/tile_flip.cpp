@@ -0,0 +1,75 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/tile_flip.hpp"
+
+namespace salmon { namespace internal {
+
+constexpr Uint32 TileFlip::HORIZONTAL;
+constexpr Uint32 TileFlip::VERTICAL;
+constexpr Uint32 TileFlip::DIAGONAL;
+constexpr Uint32 TileFlip::FLAGS;
+constexpr unsigned TileFlip::SHIFT;
+constexpr unsigned TileFlip::COUNT;
+
+namespace {
+    constexpr SDL_RendererFlip FLIP_NONE = SDL_FLIP_NONE;
+    constexpr SDL_RendererFlip FLIP_H = SDL_FLIP_HORIZONTAL;
+    constexpr SDL_RendererFlip FLIP_V = SDL_FLIP_VERTICAL;
+    const SDL_RendererFlip FLIP_HV = static_cast<SDL_RendererFlip>(SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL);
+}
+
+/**
+ * Indexed by the flag bits H V D. A diagonal flip is rendered as a rotation
+ * by 90 or 270 degrees with the vertical flip toggled, which matches the preview of Tiled.
+ */
+const TileFlip TileFlip::TABLE[COUNT] = {
+    //angle quarter h_flip v_flip sdl_flip identity
+    {  0.0,  0,  false, false, FLIP_NONE, true },  // -
+    { 90.0,  1,  false, true,  FLIP_V,    false},  // D
+    {  0.0,  0,  false, true,  FLIP_V,    false},  // V
+    {270.0,  3,  false, false, FLIP_NONE, false},  // V D
+    {  0.0,  0,  true,  false, FLIP_H,    false},  // H
+    {270.0,  3,  true,  true,  FLIP_HV,   false},  // H D
+    {  0.0,  0,  true,  true,  FLIP_HV,   false},  // H V
+    { 90.0,  1,  true,  false, FLIP_H,    false},  // H V D
+};
+
+/**
+ * @brief Apply the flip and rotation to a hitbox of a tile
+ * @param hitbox The hitbox relative to the upper left corner of the tile
+ * @param w, h The dimensions of the tile
+ * @return The hitbox relative to the upper left corner of the unrotated tile
+ *
+ * Yields the same result as Transform::transform_hitbox of a tile transform
+ * rotated around its center, but without any trigonometry.
+ */
+Rect TileFlip::transform_hitbox(Rect hitbox, float w, float h) const {
+    if(h_flip) {hitbox.x = w - hitbox.x - hitbox.w;}
+    if(v_flip) {hitbox.y = h - hitbox.y - hitbox.h;}
+    float cx = w / 2;
+    float cy = h / 2;
+    switch(quarter_turns) {
+        case 1 : return Rect{cx + cy - hitbox.y - hitbox.h, cy - cx + hitbox.x, hitbox.h, hitbox.w};
+        case 2 : return Rect{w - hitbox.x - hitbox.w, h - hitbox.y - hitbox.h, hitbox.w, hitbox.h};
+        case 3 : return Rect{cx - cy + hitbox.y, cx + cy - hitbox.x - hitbox.w, hitbox.h, hitbox.w};
+        default : return hitbox;
+    }
+}
+
+}} // namespace salmon::internal
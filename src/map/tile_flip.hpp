@@ -0,0 +1,63 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TILE_FLIP_HPP_INCLUDED
+#define TILE_FLIP_HPP_INCLUDED
+
+#include <SDL.h>
+
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Rendering and hitbox transformation of one combination of Tiled's flip flags
+ *
+ * Tiled stores the horizontal, vertical and diagonal flip of a tile in the three
+ * highest bits of its gid. Since there are only 8 combinations, they are precomputed
+ * in a table which gets indexed directly by these bits, so rendering and collision
+ * don't need to decode them per tile.
+ */
+struct TileFlip {
+    static constexpr Uint32 HORIZONTAL = 0x80000000;
+    static constexpr Uint32 VERTICAL   = 0x40000000;
+    static constexpr Uint32 DIAGONAL   = 0x20000000;
+    static constexpr Uint32 FLAGS = HORIZONTAL | VERTICAL | DIAGONAL;
+    static constexpr unsigned SHIFT = 29;
+    static constexpr unsigned COUNT = 8; ///< Number of flag combinations
+
+    double angle;               ///< Rotation in degrees around the tile center
+    unsigned quarter_turns;     ///< The rotation as multiple of 90 degrees
+    bool h_flip;                ///< Flip along the vertical axis, applied before rotation
+    bool v_flip;                ///< Flip along the horizontal axis, applied before rotation
+    SDL_RendererFlip sdl_flip;  ///< h_flip and v_flip as SDL flag
+    bool identity;              ///< True if the tile is neither flipped nor rotated
+
+    Rect transform_hitbox(Rect hitbox, float w, float h) const;
+
+    /// Returns the entry of the flip flags of the supplied gid
+    static const TileFlip& get(Uint32 gid) {return TABLE[gid >> SHIFT];}
+    /// Returns the supplied gid with its flip flags cleared
+    static Uint32 strip(Uint32 gid) {return gid & ~FLAGS;}
+
+    static const TileFlip TABLE[COUNT];
+};
+
+}} // namespace salmon::internal
+
+#endif // TILE_FLIP_HPP_INCLUDED
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/tile_grid.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace salmon { namespace internal {
+
+constexpr unsigned TileGrid::CHUNK_SHIFT;
+constexpr unsigned TileGrid::CHUNK_SIZE;
+constexpr unsigned TileGrid::CHUNK_MASK;
+constexpr unsigned TileGrid::CHUNK_TILES;
+constexpr Uint32 TileGrid::NO_CHUNK;
+constexpr unsigned TileGrid::SPARSE_PERCENT;
+
+namespace {
+    /// Returns the number of set bits
+    unsigned count_bits(Uint32 bits) {
+        #if defined(__GNUC__) || defined(__clang__)
+            return __builtin_popcount(bits);
+        #else
+            unsigned n = 0;
+            for(; bits != 0; n++) {bits &= bits - 1;}
+            return n;
+        #endif
+    }
+}
+
+/**
+ * @brief Resizes the grid to the given dimensions and sets every tile to id 0
+ * @param width, height The dimensions measured in tiles
+ */
+void TileGrid::resize(unsigned width, unsigned height) {
+    m_width = width;
+    m_height = height;
+    m_chunks_w = (width + CHUNK_MASK) >> CHUNK_SHIFT;
+    m_chunks_h = (height + CHUNK_MASK) >> CHUNK_SHIFT;
+    m_sparse = false;
+
+    m_chunk_slots.assign(static_cast<size_t>(m_chunks_w) * m_chunks_h, NO_CHUNK);
+    m_tiles.clear();
+    m_row_masks.clear();
+}
+
+/// Releases all tile data
+void TileGrid::clear() {
+    resize(0,0);
+    m_chunk_slots.shrink_to_fit();
+    m_tiles.shrink_to_fit();
+    m_row_masks.shrink_to_fit();
+}
+
+/**
+ * @brief Releases chunks which became empty and decides between sparse or dense walking
+ *
+ * Should be called once the grid got filled, e.g. after parsing a layer
+ */
+void TileGrid::optimize() {
+    std::vector<Uint32> tiles;
+    std::vector<Uint32> row_masks;
+    size_t occupied = 0;
+
+    for(Uint32& slot : m_chunk_slots) {
+        if(slot == NO_CHUNK) {continue;}
+        const Uint32* masks = &m_row_masks[static_cast<size_t>(slot) * CHUNK_SIZE];
+        unsigned count = 0;
+        for(unsigned i = 0; i < CHUNK_SIZE; i++) {
+            count += count_bits(masks[i]);
+        }
+        if(count == 0) {
+            slot = NO_CHUNK;
+            continue;
+        }
+        occupied += count;
+
+        const Uint32 new_slot = row_masks.size() / CHUNK_SIZE;
+        tiles.insert(tiles.end(), m_tiles.begin() + static_cast<size_t>(slot) * CHUNK_TILES,
+                                  m_tiles.begin() + static_cast<size_t>(slot + 1) * CHUNK_TILES);
+        row_masks.insert(row_masks.end(), masks, masks + CHUNK_SIZE);
+        slot = new_slot;
+    }
+
+    m_tiles.swap(tiles);
+    m_row_masks.swap(row_masks);
+
+    size_t total = static_cast<size_t>(m_width) * m_height;
+    m_sparse = occupied * 100 < total * SPARSE_PERCENT;
+}
+
+/// Sets the tile id at x, y without bounds checking, allocates the chunk if required
+void TileGrid::set(unsigned x, unsigned y, Uint32 tile_id) {
+    size_t chunk = chunk_index(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+    Uint32 slot = m_chunk_slots[chunk];
+    if(slot == NO_CHUNK) {
+        // Keep empty chunks unallocated
+        if(tile_id == 0) {return;}
+        slot = alloc_chunk(chunk);
+    }
+    m_tiles[static_cast<size_t>(slot) * CHUNK_TILES + ((y & CHUNK_MASK) << CHUNK_SHIFT) + (x & CHUNK_MASK)] = tile_id;
+
+    Uint32& mask = m_row_masks[static_cast<size_t>(slot) * CHUNK_SIZE + (y & CHUNK_MASK)];
+    Uint32 bit = 1u << (x & CHUNK_MASK);
+    if(tile_id != 0) {mask |= bit;}
+    else {mask &= ~bit;}
+}
+
+/**
+ * @brief Copies a horizontal run of tile ids into the grid
+ * @param x, y The position of the first tile
+ * @param count The number of tiles, the run must not leave the grid
+ * @param tile_ids Pointer to @p count consecutive tile ids
+ */
+void TileGrid::set_span(unsigned x, unsigned y, unsigned count, const Uint32* tile_ids) {
+    const unsigned x_end = x + count;
+    while(x < x_end) {
+        unsigned n = std::min(CHUNK_SIZE - (x & CHUNK_MASK), x_end - x);
+        size_t chunk = chunk_index(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+        Uint32 slot = m_chunk_slots[chunk];
+        if(slot == NO_CHUNK) {
+            // Keep empty chunks unallocated
+            if(std::find_if(tile_ids, tile_ids + n, [](Uint32 id) {return id != 0;}) == tile_ids + n) {
+                x += n;
+                tile_ids += n;
+                continue;
+            }
+            slot = alloc_chunk(chunk);
+        }
+        size_t offset = static_cast<size_t>(slot) * CHUNK_TILES + ((y & CHUNK_MASK) << CHUNK_SHIFT) + (x & CHUNK_MASK);
+        std::memcpy(&m_tiles[offset], tile_ids, n * sizeof(Uint32));
+        update_row_mask(slot, y & CHUNK_MASK);
+        x += n;
+        tile_ids += n;
+    }
+}
+
+/// Returns true if the chunk holds no tile
+bool TileGrid::is_chunk_empty(unsigned chunk_x, unsigned chunk_y) const {
+    Uint32 slot = m_chunk_slots[chunk_index(chunk_x, chunk_y)];
+    if(slot == NO_CHUNK) {return true;}
+    for(unsigned i = 0; i < CHUNK_SIZE; i++) {
+        if(m_row_masks[static_cast<size_t>(slot) * CHUNK_SIZE + i] != 0) {return false;}
+    }
+    return true;
+}
+
+/// Appends storage for an empty chunk and returns its slot
+Uint32 TileGrid::alloc_chunk(size_t chunk) {
+    Uint32 slot = m_row_masks.size() / CHUNK_SIZE;
+    m_tiles.resize(m_tiles.size() + CHUNK_TILES, 0);
+    m_row_masks.resize(m_row_masks.size() + CHUNK_SIZE, 0);
+    m_chunk_slots[chunk] = slot;
+    return slot;
+}
+
+/// Recalculates the occupancy mask of a chunk row from its tile ids
+void TileGrid::update_row_mask(Uint32 slot, unsigned local_y) {
+    const Uint32* row = &m_tiles[static_cast<size_t>(slot) * CHUNK_TILES + (local_y << CHUNK_SHIFT)];
+    Uint32 mask = 0;
+    for(unsigned i = 0; i < CHUNK_SIZE; i++) {
+        if(row[i] != 0) {mask |= 1u << i;}
+    }
+    m_row_masks[static_cast<size_t>(slot) * CHUNK_SIZE + local_y] = mask;
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TILE_GRID_HPP_INCLUDED
+#define TILE_GRID_HPP_INCLUDED
+
+#include <SDL.h>
+#include <vector>
+#include <cstddef>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Chunked storage of the tile ids of a map layer
+ *
+ * The grid is split into square chunks of CHUNK_SIZE x CHUNK_SIZE tiles. Inside of each
+ * chunk the tiles are stored row by row, so a rect of tiles like the one covered by the
+ * camera only touches a few small memory regions. Chunks only get allocated once they
+ * hold a non zero tile id, so empty areas of a layer cost no tile memory.
+ *
+ * For each row of a chunk a bit mask tracks which tiles are occupied. After parsing,
+ * optimize() picks by density if layer walks should use these masks to jump between
+ * occupied tiles (sparse) or simply read every tile (dense).
+ */
+class TileGrid {
+    public:
+        static constexpr unsigned CHUNK_SHIFT = 5;
+        static constexpr unsigned CHUNK_SIZE = 1 << CHUNK_SHIFT; ///< Chunk width and height in tiles, matches the bits of a row mask
+        static constexpr unsigned CHUNK_MASK = CHUNK_SIZE - 1;
+        static constexpr unsigned CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+        static constexpr Uint32 NO_CHUNK = 0xFFFFFFFF; ///< Slot of chunks which aren't allocated
+        static constexpr unsigned SPARSE_PERCENT = 25; ///< Layers with less occupied tiles are walked by their masks
+
+        TileGrid() = default;
+
+        void resize(unsigned width, unsigned height);
+        void clear();
+        void optimize();
+
+        unsigned get_width() const {return m_width;}   ///< Width measured in tiles
+        unsigned get_height() const {return m_height;} ///< Height measured in tiles
+
+        unsigned get_chunks_w() const {return m_chunks_w;} ///< Number of chunk columns
+        unsigned get_chunks_h() const {return m_chunks_h;} ///< Number of chunk rows
+
+        bool is_sparse() const {return m_sparse;}
+        void set_sparse(bool sparse) {m_sparse = sparse;}
+
+        /// Returns true if the tile coordinate lies inside of the grid
+        bool in_bounds(int x, int y) const {
+            return x >= 0 && y >= 0 && x < static_cast<int>(m_width) && y < static_cast<int>(m_height);
+        }
+
+        /// Returns the tile id at x, y without bounds checking
+        Uint32 get(unsigned x, unsigned y) const {
+            Uint32 slot = m_chunk_slots[chunk_index(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT)];
+            if(slot == NO_CHUNK) {return 0;}
+            return m_tiles[static_cast<size_t>(slot) * CHUNK_TILES + ((y & CHUNK_MASK) << CHUNK_SHIFT) + (x & CHUNK_MASK)];
+        }
+        void set(unsigned x, unsigned y, Uint32 tile_id);
+        void set_row(unsigned y, const Uint32* tile_ids) {set_span(0, y, m_width, tile_ids);}
+        void set_span(unsigned x, unsigned y, unsigned count, const Uint32* tile_ids);
+
+        /// Returns the CHUNK_SIZE tile ids of row y in chunk column chunk_x or nullptr if the chunk is empty
+        const Uint32* get_row_segment(unsigned chunk_x, unsigned y) const {
+            Uint32 slot = m_chunk_slots[chunk_index(chunk_x, y >> CHUNK_SHIFT)];
+            if(slot == NO_CHUNK) {return nullptr;}
+            return &m_tiles[static_cast<size_t>(slot) * CHUNK_TILES + ((y & CHUNK_MASK) << CHUNK_SHIFT)];
+        }
+        /// Returns the occupancy of row y in chunk column chunk_x, bit n is set if tile n isn't empty
+        Uint32 get_row_mask(unsigned chunk_x, unsigned y) const {
+            Uint32 slot = m_chunk_slots[chunk_index(chunk_x, y >> CHUNK_SHIFT)];
+            if(slot == NO_CHUNK) {return 0;}
+            return m_row_masks[static_cast<size_t>(slot) * CHUNK_SIZE + (y & CHUNK_MASK)];
+        }
+        bool is_chunk_empty(unsigned chunk_x, unsigned chunk_y) const;
+
+        /// Returns the index of the lowest set bit, bits must not be 0
+        static int lowest_bit(Uint32 bits) {
+            #if defined(__GNUC__) || defined(__clang__)
+                return __builtin_ctz(bits);
+            #else
+                int n = 0;
+                while(!(bits & 1)) {bits >>= 1; n++;}
+                return n;
+            #endif
+        }
+        /// Returns the index of the highest set bit, bits must not be 0
+        static int highest_bit(Uint32 bits) {
+            #if defined(__GNUC__) || defined(__clang__)
+                return 31 - __builtin_clz(bits);
+            #else
+                int n = 31;
+                while(!(bits & 0x80000000)) {bits <<= 1; n--;}
+                return n;
+            #endif
+        }
+        /// Returns a mask with the bits from first to last set
+        static Uint32 bit_range(unsigned first, unsigned last) {
+            return (0xFFFFFFFF >> (31 - last)) & (0xFFFFFFFF << first);
+        }
+
+    private:
+        size_t chunk_index(unsigned chunk_x, unsigned chunk_y) const {
+            return static_cast<size_t>(chunk_y) * m_chunks_w + chunk_x;
+        }
+        Uint32 alloc_chunk(size_t chunk);
+        void update_row_mask(Uint32 slot, unsigned local_y);
+
+        unsigned m_width = 0;
+        unsigned m_height = 0;
+        unsigned m_chunks_w = 0;
+        unsigned m_chunks_h = 0;
+        bool m_sparse = false;
+
+        std::vector<Uint32> m_chunk_slots; ///< Storage slot of each chunk or NO_CHUNK
+        std::vector<Uint32> m_tiles; ///< The tiles of all allocated chunks stored back to back
+        std::vector<Uint32> m_row_masks; ///< CHUNK_SIZE occupancy masks per allocated chunk
+};
+}} // namespace salmon::internal
+
+#endif // TILE_GRID_HPP_INCLUDED
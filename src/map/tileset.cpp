@@ -30,13 +30,60 @@
 
 namespace salmon { namespace internal {
 
+/**
+ * @brief Find the tileset element and load the external .tsx file if the attribute "source" is set
+ * @param ts_file The @c Element of the map file which stores the tileset information
+ * @param map_path The path of the directory holding the map file
+ * @return an @c XMLError object which indicates success or error type
+ */
+tinyxml2::XMLError TilesetSource::load(const Element* ts_file, std::string map_path) {
+    using namespace tinyxml2;
+
+    element = ts_file;
+    base_path = map_path;
+
+    const char* p_source;
+    p_source = ts_file->Attribute("source");
+    if(p_source == nullptr) {return XML_SUCCESS;}
+
+    std::string full_path = map_path + std::string(p_source);
+
+    // Cooked maps hold the external tileset inside of its reference
+    const Element* p_inlined = ts_file->FirstChildElement("tileset");
+    if(p_inlined != nullptr) {
+        base_path = full_path.erase(full_path.find_last_of('/') + 1);
+        element = p_inlined;
+        return XML_SUCCESS;
+    }
+
+    XMLDocument tsx_file{true, tinyxml2::COLLAPSE_WHITESPACE};
+    XMLError eResult = tsx_file.LoadFile(full_path.c_str());
+    if(eResult != XML_SUCCESS) return eResult;
+
+    // Trim string
+    base_path = full_path.erase(full_path.find_last_of('/') + 1);
+
+    XMLElement* p_tileset = tsx_file.FirstChildElement("tileset");
+    if (p_tileset == nullptr) return XML_ERROR_PARSING_ELEMENT;
+
+    tsx.reset(new ElementTree);
+    tsx->parse(p_tileset);
+    element = tsx->get_root();
+
+    return XML_SUCCESS;
+}
+
 /**
  * @brief Initialize a tileset from XML info
- * @param ts_file The @c XMLElement which stores the tileset information
+ * @param ts_file The @c Element of the map file which stores the tileset information
+ * @param source The loaded tileset element of @p ts_file
+ * @param image The already decoded tileset image or @c nullptr if it still has to be loaded
  * @param ts_collection Reference to tileset collection to register tiles, etc.
  * @return an @c XMLError object which indicates success or error type
+ *
+ * The texture upload of @p image happens here, so this must run on the render thread.
  */
-tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollection& ts_collection) {
+tinyxml2::XMLError Tileset::init(const Element* ts_file, const TilesetSource& source, SDL_Surface* image, TilesetCollection& ts_collection) {
 
     using namespace tinyxml2;
 
@@ -46,26 +93,8 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
     eResult = ts_file->QueryUnsignedAttribute("firstgid", &m_first_gid);
     if(eResult != XML_SUCCESS) return eResult;
 
-    // If attribute "source" is set, load external .tsx tileset file
-    std::string full_path = ts_collection.get_mapdata().get_file_path();
-
-    const char* p_source;
-    p_source = ts_file->Attribute("source");
-    XMLDocument tsx_tileset{true, tinyxml2::COLLAPSE_WHITESPACE};
-    if(p_source != nullptr) {
-        full_path += std::string(p_source);
-
-        XMLError eResult = tsx_tileset.LoadFile(full_path.c_str());
-        if(eResult != XML_SUCCESS) return eResult;
-
-        // Trim string
-        full_path.erase(full_path.find_last_of('/') + 1);
-
-        XMLElement* pTileset = tsx_tileset.FirstChildElement("tileset");
-        if (pTileset == nullptr) return XML_ERROR_PARSING_ELEMENT;
-
-        ts_file = pTileset;
-    }
+    std::string full_path = source.base_path;
+    ts_file = source.element;
 
     // Parse tileset name, tile dimensions and tile count
     const char* p_ts_name;
@@ -85,7 +114,7 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
     if(eResult != XML_SUCCESS) return eResult;
 
     // Parse tile offset values
-    XMLElement* p_offset = ts_file->FirstChildElement("tileoffset");
+    const Element* p_offset = ts_file->FirstChildElement("tileoffset");
     if(p_offset != nullptr) {
         eResult = p_offset->QueryIntAttribute("x", &m_x_offset);
         if(eResult != XML_SUCCESS) return eResult;
@@ -94,7 +123,7 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
     }
 
     // Parse image path and dimensions, and load the image file
-    XMLElement* p_image = ts_file->FirstChildElement("image");
+    const Element* p_image = ts_file->FirstChildElement("image");
     if(p_image == nullptr) return XML_ERROR_PARSING_ELEMENT;
     const char* p_ts_source;
     p_ts_source = p_image->Attribute("source");
@@ -102,7 +131,10 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
 
     const char* p_color_key;
     p_color_key = p_image->Attribute("trans");
-    if (p_color_key == nullptr) {
+    if (image != nullptr) {
+        m_image = mp_ts_collection->get_mapdata().get_game().get_texture_cache().get(full_path + std::string(p_ts_source), image);
+    }
+    else if (p_color_key == nullptr) {
         m_image = mp_ts_collection->get_mapdata().get_game().get_texture_cache().get(full_path + std::string(p_ts_source));
     }
     else {
@@ -136,7 +168,7 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
     for(temp.y = m_margin; temp.y <= y_limit; temp.y += y_advance) {
         for(temp.x = m_margin; temp.x <= x_limit; temp.x += x_advance) {
             // Construct each tile of the tilset and store in m_tiles
-            m_tiles.push_back(Tile(this, temp));
+            m_tiles.push_back(Tile(this, temp, i_tile + m_first_gid));
             if(!ts_collection.register_tile(&m_tiles.back(), i_tile + m_first_gid)) {
                 Logger(Logger::error) << "Failed to register Tile, abort parsing process!";
                 return XML_ERROR_PARSING;
@@ -151,9 +183,9 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
     }
 
     // Parse user specified properties of the tileset (only blend mode right now)
-    XMLElement* p_properties = ts_file->FirstChildElement("properties");
+    const Element* p_properties = ts_file->FirstChildElement("properties");
     if(p_properties != nullptr) {
-        XMLElement* p_property = p_properties->FirstChildElement("property");
+        const Element* p_property = p_properties->FirstChildElement("property");
         while(p_property != nullptr) {
             const char* p_name;
             p_name = p_property->Attribute("name");
@@ -176,7 +208,7 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
     }
 
     // Check if there is specific tile info
-    XMLElement* p_tile = ts_file->FirstChildElement("tile");
+    const Element* p_tile = ts_file->FirstChildElement("tile");
 
     if(p_tile != nullptr) {
 
@@ -266,13 +298,13 @@ std::map<Direction, unsigned> Tileset::determine_overhang(unsigned tile_w, unsig
 
 /**
  * @brief Parse tile information from tileset
- * @param source The @c XMLElement from the tileset
+ * @param source The @c Element from the tileset
  * @param first_gid The first global tile id of the tileset
  * @return an @c XMLError object which indicates success or error type
  *
  * Determines the tile type and calls the corresponding tile parsers
  */
-tinyxml2::XMLError Tileset::parse_tile_info(tinyxml2::XMLElement* source) {
+tinyxml2::XMLError Tileset::parse_tile_info(const Element* source) {
     using namespace tinyxml2;
 
     XMLError eResult;
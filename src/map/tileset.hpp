@@ -22,9 +22,11 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
 #include <tinyxml2.h>
 
 #include "graphics/texture.hpp"
+#include "util/element_tree.hpp"
 #include "util/game_types.hpp"
 
 namespace salmon { namespace internal {
@@ -33,6 +35,19 @@ class Tile; // forward declaration
 class TilesetCollection;
 class MapData;
 
+/**
+ * @brief The source of a tileset which gets loaded ahead of Tileset::init
+ *
+ * Loading only touches its own document, so it may run on a worker thread.
+ */
+struct TilesetSource {
+    tinyxml2::XMLError load(const Element* ts_file, std::string map_path);
+
+    const Element* element = nullptr; ///< The tileset element, which lies inside of the .tsx file of external tilesets
+    std::string base_path; ///< Path of the directory holding the tileset, image paths are relative to it
+    std::unique_ptr<ElementTree> tsx; ///< The elements of the .tsx file of external tilesets
+};
+
 /**
  * @brief Parse, store and manage all tilesets
  *
@@ -43,9 +58,9 @@ class Tileset{
 
     public:
 
-        tinyxml2::XMLError init(tinyxml2::XMLElement* ts_file, TilesetCollection& ts_collection); // Initialize single object
+        tinyxml2::XMLError init(const Element* ts_file, const TilesetSource& source, SDL_Surface* image, TilesetCollection& ts_collection); // Initialize single object
 
-        tinyxml2::XMLError parse_tile_info(tinyxml2::XMLElement* source);
+        tinyxml2::XMLError parse_tile_info(const Element* source);
 
         const Texture* get_image_pointer() const {return &m_image;}
         TilesetCollection& get_ts_collection() const {return *mp_ts_collection;}
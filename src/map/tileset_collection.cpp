@@ -21,24 +21,34 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <future>
+#include <set>
 #include <sstream>
 #include <SDL.h>
 
+#include "core/gameinfo.hpp"
 #include "map/tile.hpp"
+#include "map/tile_flip.hpp"
 #include "map/tileset.hpp"
 #include "map/mapdata.hpp"
 #include "util/logger.hpp"
 #include "util/parse.hpp"
+#include "util/thread_pool.hpp"
 
 namespace salmon { namespace internal {
 
 /**
  * @brief Initialize a TilesetCollection from XML info
- * @param source The @c XMLElement which stores the tileset information
+ * @param source The @c Element which stores the tileset information
  * @param mapdata Pointer to map to which these tilesets belong
+ * @param pool Worker threads for loading .tsx files and decoding tileset images
  * @return an @c XMLError object which indicates success or error type
+ *
+ * External .tsx files get parsed and tileset images get decoded on the worker threads,
+ * while the tilesets themselves are initialized and their textures uploaded in order on
+ * the calling thread. This keeps the result identical to a sequential load.
  */
-tinyxml2::XMLError TilesetCollection::init(tinyxml2::XMLElement* source, MapData* mapdata) {
+tinyxml2::XMLError TilesetCollection::init(const Element* source, MapData* mapdata, ThreadPool& pool) {
     using namespace tinyxml2;
 
     mp_base_map = mapdata;
@@ -49,9 +59,9 @@ tinyxml2::XMLError TilesetCollection::init(tinyxml2::XMLElement* source, MapData
     if(eResult != XML_SUCCESS) return eResult;
 
     // All tilesets get parsed
-    std::vector<XMLElement*> p_tilesets;
+    std::vector<const Element*> p_tilesets;
 
-    XMLElement* pTs = source->FirstChildElement("tileset");
+    const Element* pTs = source->FirstChildElement("tileset");
     if (pTs == nullptr) {
         //std::cout << "Error: Parsing Mapfile without any Tileset!\n";
         /// @note Empty tileset_collection is okay now
@@ -71,16 +81,71 @@ tinyxml2::XMLError TilesetCollection::init(tinyxml2::XMLElement* source, MapData
     //
     // Anybody who dares manually adressing tile 0, deserves the segmentation fault ;-)
     mp_tiles.push_back(nullptr);
-    m_anim_tiles.clear();
 
     m_tilesets.clear();
     m_tilesets.resize(p_tilesets.size());
 
+    // Load the external .tsx files on the worker threads
+    std::string map_path = mp_base_map->get_file_path();
+    std::vector<TilesetSource> sources(p_tilesets.size());
+    std::vector<std::future<XMLError>> loaded(p_tilesets.size());
+    for(unsigned i = 0; i < p_tilesets.size(); i++) {
+        TilesetSource* ts_source = &sources[i];
+        const Element* p_tileset = p_tilesets[i];
+        if(p_tileset->Attribute("source") != nullptr) {
+            loaded[i] = pool.submit([ts_source, p_tileset, map_path](){return ts_source->load(p_tileset, map_path);});
+        }
+        else {
+            ts_source->load(p_tileset, map_path);
+        }
+    }
+    // Wait for all files before bailing out, since the tasks write into sources
+    std::vector<XMLError> results(p_tilesets.size(), XML_SUCCESS);
+    for(unsigned i = 0; i < p_tilesets.size(); i++) {
+        if(loaded[i].valid()) {results[i] = loaded[i].get();}
+    }
+    for(unsigned i = 0; i < p_tilesets.size(); i++) {
+        if(results[i] != XML_SUCCESS) {
+            Logger(Logger::error) << "Failed at parsing Tileset: " << i;
+            return results[i];
+        }
+    }
+
+    // Decode the tileset images on the worker threads
+    // Images without color key get decoded once, all further tilesets use the cached texture
+    TextureCache& texture_cache = mp_base_map->get_game().get_texture_cache();
+    std::set<std::string> queued_images;
+    std::vector<std::future<SDL_Surface*>> images(p_tilesets.size());
+    for(unsigned i = 0; i < p_tilesets.size(); i++) {
+        // Missing attributes get reported by Tileset::init
+        const Element* p_image = sources[i].element->FirstChildElement("image");
+        if(p_image == nullptr || p_image->Attribute("source") == nullptr) {continue;}
+
+        std::string image_path = sources[i].base_path + std::string(p_image->Attribute("source"));
+        const char* p_color_key = p_image->Attribute("trans");
+        if(p_color_key == nullptr) {
+            std::string absolute_path = image_path;
+            make_path_absolute(absolute_path);
+            if(texture_cache.has(absolute_path) || !queued_images.insert(absolute_path).second) {continue;}
+            images[i] = pool.submit([image_path](){return Texture::load_surface(image_path);});
+        }
+        else {
+            SDL_Color color_key = str_to_color(p_color_key);
+            images[i] = pool.submit([image_path, color_key](){return Texture::load_surface(image_path, color_key);});
+        }
+    }
+
     // Actually parse each tileset of the vector of pointers
     for(unsigned i = 0; i < p_tilesets.size(); i++) {
-        eResult = m_tilesets[i].init(p_tilesets[i], *this);
+        SDL_Surface* image = images[i].valid() ? images[i].get() : nullptr;
+        eResult = m_tilesets[i].init(p_tilesets[i], sources[i], image, *this);
+        SDL_FreeSurface(image);
         if(eResult != XML_SUCCESS) {
             Logger(Logger::error) << "Failed at parsing Tileset: " << i;
+            // Free the images which are still in flight
+            for(unsigned j = i + 1; j < p_tilesets.size(); j++) {
+                if(images[j].valid()) {SDL_FreeSurface(images[j].get());}
+            }
             return eResult;
         }
     }
@@ -94,6 +159,9 @@ tinyxml2::XMLError TilesetCollection::init(tinyxml2::XMLElement* source, MapData
     // and passes the current timestamp
     init_anim_tiles();
 
+    // This must be called after the parsing of all tilesets!
+    init_tile_hitboxes();
+
     return XML_SUCCESS;
 }
 
@@ -121,10 +189,8 @@ unsigned TilesetCollection::get_overhang(Direction dir) const{
 
 /// Return global Id of a tile if it's registered or 0 if not
 Uint32 TilesetCollection::get_gid(Tile* tile)  const{
-    for(Uint32 i = 0; i < mp_tiles.size(); i++) {
-        if(mp_tiles[i] == tile) {
-            return i;
-        }
+    if(is_registered(tile)) {
+        return tile->get_gid();
     }
     Logger(Logger::error) << "Could not find Tile to get its gid, not in global list!";
     return 0;
@@ -132,11 +198,8 @@ Uint32 TilesetCollection::get_gid(Tile* tile)  const{
 
 /// Returns the pointer to a tile from it's tile id
 Tile* TilesetCollection::get_tile(Uint32 tile_id) const{
-    const Uint32 FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
-    const Uint32 FLIPPED_VERTICALLY_FLAG   = 0x40000000;
-    const Uint32 FLIPPED_DIAGONALLY_FLAG   = 0x20000000;
     // Clear the flags
-    tile_id &= ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
+    tile_id = TileFlip::strip(tile_id);
     if(tile_id >= mp_tiles.size()) {
         Logger(Logger::error) << "Tile id " << tile_id << " is out of bounds";
         return nullptr;
@@ -144,6 +207,22 @@ Tile* TilesetCollection::get_tile(Uint32 tile_id) const{
     else return mp_tiles[tile_id];
 }
 
+/**
+ * @brief Returns a tile placed at a world position with its hitboxes ready for collision checks
+ * @param tile_id The gid of the tile including its flip flags
+ * @param x, y The upper left corner of the tile in world coordinates
+ *
+ * Looks up the hitboxes of the current animation frame and flip state, allocating no memory
+ */
+TileCollider TilesetCollection::get_collider(Uint32 tile_id, float x, float y) const {
+    Tile* tile = get_tile(tile_id);
+    if(tile == nullptr || tile->get_gid() >= m_hitbox_first.size()) {return TileCollider{};}
+    unsigned frame = tile->is_animated() ? tile->get_current_frame() : 0;
+    Uint32 range = m_hitbox_first[tile->get_gid()] + frame * TileFlip::COUNT + (tile_id >> TileFlip::SHIFT);
+    const HitboxSet::Entry* entries = m_hitbox_entries.data();
+    return TileCollider{tile, tile_id, x, y, entries + m_hitbox_ranges[range], entries + m_hitbox_ranges[range + 1]};
+}
+
 /// Registers tile so it's renderable by its gid
 bool TilesetCollection::register_tile(Tile* tile, unsigned gid) {
     mp_tiles.push_back(tile);
@@ -154,45 +233,58 @@ bool TilesetCollection::register_tile(Tile* tile, unsigned gid) {
     return true;
 }
 
-/// Adds tile to the "always animate" list
-void TilesetCollection::set_tile_animated(unsigned gid) {
-    m_anim_tiles.push_back(gid);
+/// Returns true if the tile itself and not a copy of it is registered under its gid
+bool TilesetCollection::is_registered(const Tile* tile) const {
+    Uint32 gid = tile->get_gid();
+    return gid < mp_tiles.size() && mp_tiles[gid] == tile;
 }
 
-/// Adds tile to the "always animate" list
-void TilesetCollection::set_tile_animated(Tile* tile) {
-    for(unsigned i = 0; i < mp_tiles.size(); i++) {
-        if(mp_tiles[i] == tile) {
-            m_anim_tiles.push_back(i);
-            return;
-        }
-    }
-    Logger(Logger::error) << "Could not find Tile to set it to animated, not in global tile list! (has no gid)";
-}
-
-/// Initializes all registered animated tiles to the current timestamp and first frame
+/// Starts the shared animation clock so all animated tiles begin at their first frame
 void TilesetCollection::init_anim_tiles() {
-    Uint32 time = SDL_GetTicks();
-    for(unsigned tile : m_anim_tiles) {
-        mp_tiles[tile]->init_anim(time);
-    }
+    m_anim_start = SDL_GetTicks();
+    m_anim_time = 0;
 }
 
 /**
  * @brief Animates all tiles
  *
- * Checks if next frame of animated tile is due, changes to next frame
- * and wraps around if required.
- * Passing of time is to ensure synchronity of tile animation
+ * Advances the shared animation clock which drives all animated map tiles.
+ * Each tile looks up its frame from the clock only when it gets drawn or queried,
+ * so this doesn't depend on the number of animated tiles.
  */
 void TilesetCollection::push_all_anim() {
-    Uint32 time = SDL_GetTicks();
-    for(unsigned tile : m_anim_tiles) {
-        mp_tiles[tile]->push_anim(1.0f, time);
-    }
+    m_anim_time = SDL_GetTicks() - m_anim_start;
 }
 
 
+/**
+ * @brief Precompute the hitboxes of each tile for all of its animation frames and flip states
+ *
+ * The hitboxes get flipped and rotated within the tile like a TileInstance would,
+ * so collision queries only need to offset them by the tile position.
+ */
+void TilesetCollection::init_tile_hitboxes() {
+    m_hitbox_first.assign(mp_tiles.size(), 0);
+    m_hitbox_ranges.clear();
+    m_hitbox_entries.clear();
+    for(Uint32 gid = 1; gid < mp_tiles.size(); gid++) {
+        const Tile* tile = mp_tiles[gid];
+        m_hitbox_first[gid] = m_hitbox_ranges.size();
+        unsigned frames = tile->is_animated() ? tile->get_frame_count() : 1;
+        for(unsigned frame = 0; frame < frames; frame++) {
+            HitboxSet hitboxes = tile->get_frame_hitboxes(frame);
+            const SDL_Rect& clip = tile->get_frame_clip(frame);
+            for(const TileFlip& flip : TileFlip::TABLE) {
+                m_hitbox_ranges.push_back(m_hitbox_entries.size());
+                for(const HitboxSet::Entry& hitbox : hitboxes) {
+                    m_hitbox_entries.push_back({hitbox.id, flip.transform_hitbox(hitbox.rect, clip.w, clip.h)});
+                }
+            }
+        }
+    }
+    m_hitbox_ranges.push_back(m_hitbox_entries.size());
+}
+
 /// Checks for minimum of overhang values for each tileset and saves the corresponding maximum
 void TilesetCollection::write_overhang() {
     std::map<Direction, unsigned> oh;
@@ -223,50 +315,20 @@ void TilesetCollection::write_overhang() {
  * @note Additionally performs flipping by reading the last three bits of the id as flags
  */
 bool TilesetCollection::render(Uint32 tile_id, int x, int y) const{
-    bool success = true;
-
-    const Uint32 FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
-    const Uint32 FLIPPED_VERTICALLY_FLAG   = 0x40000000;
-    const Uint32 FLIPPED_DIAGONALLY_FLAG   = 0x20000000;
-
-    if(tile_id >= FLIPPED_DIAGONALLY_FLAG) {
-        // Read out flags
-        bool flipped_horizontally = (tile_id & FLIPPED_HORIZONTALLY_FLAG);
-        bool flipped_vertically = (tile_id & FLIPPED_VERTICALLY_FLAG);
-        bool flipped_diagonally = (tile_id & FLIPPED_DIAGONALLY_FLAG);
-        double angle = 0;
-        // This snippet was determined via trial and error
-        // I have no idea why this even works, but it does
-        if(flipped_diagonally) {
-            angle = 270;
-            if(flipped_horizontally == flipped_vertically) {
-                angle = 90;
-            }
-            flipped_vertically = !flipped_vertically;
-        }
-        // Clear the flags
-        tile_id &= ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG);
-        // Check if id is valid
-        if(tile_id >= mp_tiles.size()) {
-            Logger(Logger::error) << "Tile id " << tile_id << " is out of bounds";
-            success = false;
-        }
-        else {
-            mp_tiles[tile_id]->render_extra(x,y,angle, flipped_horizontally, flipped_vertically);
-        }
-        return success;
+    const TileFlip& flip = TileFlip::get(tile_id);
+    tile_id = TileFlip::strip(tile_id);
+    // Check if id is valid
+    if(tile_id >= mp_tiles.size()) {
+        Logger(Logger::error) << "Tile id " << tile_id << " is out of bounds";
+        return false;
+    }
+    if(flip.identity) {
+        mp_tiles[tile_id]->render(x,y);
     }
     else {
-        // Check if id is valid
-        if(tile_id >= mp_tiles.size()) {
-            Logger(Logger::error) << "Tile id " << tile_id << " is out of bounds";
-            success = false;
-        }
-        else {
-            mp_tiles[tile_id]->render(x,y);
-        }
-        return success;
+        mp_tiles[tile_id]->render_extra(x,y,flip);
     }
+    return true;
 }
 
 /**
@@ -22,13 +22,17 @@
 #include <vector>
 #include <tinyxml2.h>
 
+#include "util/element_tree.hpp"
 #include "util/game_types.hpp"
+#include "util/hitbox.hpp"
 
 namespace salmon { namespace internal {
 
 class Tileset; // forward declaration
 class Tile;
+class TileCollider;
 class MapData;
+class ThreadPool;
 
 /**
  * @brief Manage multiple tilesets and forward to tiles by their global id (gid)
@@ -52,7 +56,7 @@ class TilesetCollection{
         TilesetCollection(TilesetCollection&& other) = default;
         TilesetCollection& operator= (TilesetCollection&& other) = default;
 
-        tinyxml2::XMLError init(tinyxml2::XMLElement* source, MapData* mapdata);
+        tinyxml2::XMLError init(const Element* source, MapData* mapdata, ThreadPool& pool);
 
         unsigned get_tile_h() const {return m_tile_h;} ///< Return base tile height
         unsigned get_tile_w() const {return m_tile_w;} ///< Return base tile width
@@ -61,13 +65,14 @@ class TilesetCollection{
 
         Uint32 get_gid(Tile* tile)  const;
         Tile* get_tile(Uint32 tile_id) const;
+        TileCollider get_collider(Uint32 tile_id, float x, float y) const;
 
         bool register_tile(Tile* tile, unsigned gid);
-        void set_tile_animated(unsigned gid);
-        void set_tile_animated(Tile* tile);
+        bool is_registered(const Tile* tile) const;
 
         void init_anim_tiles();
         void push_all_anim();
+        Uint32 get_anim_time() const {return m_anim_time;} ///< Return time of the shared animation clock in ms
 
         bool render(Uint32 tile_id, int x, int y) const;
         bool render(Uint32 tile_id, Rect& dest) const;
@@ -80,6 +85,8 @@ class TilesetCollection{
         unsigned m_tile_w; // The tile dimensions in pixels
         unsigned m_tile_h;
 
+        void init_tile_hitboxes();
+
         void write_overhang(); // sets the 4 values below v v
         unsigned m_up_overhang = 0;
         unsigned m_down_overhang = 0;
@@ -88,8 +95,15 @@ class TilesetCollection{
 
         std::vector<Tileset> m_tilesets; ///< Contains all used Tilesets
 
-        std::vector<Tile*> mp_tiles;      ///< List of pointers to all tiles in order
-        std::vector<Uint32> m_anim_tiles; ///< List of ids of all animated tiles
+        std::vector<Tile*> mp_tiles; ///< List of pointers to all tiles in order
+
+        // Hitboxes of all tiles for each animation frame and flip state, see init_tile_hitboxes()
+        std::vector<Uint32> m_hitbox_first;             ///< Index of the first range of each tile by gid
+        std::vector<Uint32> m_hitbox_ranges;            ///< Start of each range in m_hitbox_entries, followed by a final end
+        std::vector<HitboxSet::Entry> m_hitbox_entries; ///< Flipped and rotated hitboxes relative to the tile origin
+
+        Uint32 m_anim_start = 0; ///< Timestamp at which the shared animation clock started
+        Uint32 m_anim_time = 0;  ///< Milliseconds passed on the shared animation clock
 };
 }} // namespace salmon::internal
 
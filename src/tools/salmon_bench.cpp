@@ -0,0 +1,589 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file salmon_bench.cpp
+ * @brief Command line tool which benchmarks loading and updating generated maps
+ *
+ * The maps and their tileset images get generated into the temporary directory.
+ * SDL runs with its dummy video driver and a software renderer, so no display is needed.
+ * Each mode returns a failure if its results are wrong, or with -s if they don't scale as expected.
+ */
+#define SDL_MAIN_HANDLED
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <SDL.h>
+
+#include "actor/actor.hpp"
+#include "core/gameinfo.hpp"
+#include "map/layer_collection.hpp"
+#include "map/map_layer.hpp"
+#include "map/mapdata.hpp"
+
+namespace fs = std::experimental::filesystem;
+
+using namespace salmon::internal;
+
+namespace {
+
+const unsigned TILE_SIZE = 16;
+const unsigned TILESET_COLUMNS = 100;
+const unsigned SOLID_GID = 2; ///< Gid of the plain tile with a hitbox in write_tile_map()
+
+/// Writes a blank tileset image which fits the given number of tiles
+bool write_tileset_image(const std::string& path, unsigned tile_count) {
+    unsigned rows = (tile_count + TILESET_COLUMNS - 1) / TILESET_COLUMNS;
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, TILESET_COLUMNS * TILE_SIZE, rows * TILE_SIZE, 32, SDL_PIXELFORMAT_RGBA32);
+    if(surface == nullptr) {return false;}
+    bool success = SDL_SaveBMP(surface, path.c_str()) == 0;
+    SDL_FreeSurface(surface);
+    return success;
+}
+
+/**
+ * @brief Writes a map whose tileset consists of actor templates with one hitbox each
+ * @param objects The positions of actors of the first template, which get placed in one object layer
+ */
+bool write_map(const std::string& path, const std::string& image, unsigned tile_count, const std::vector<salmon::Point>& objects = {}) {
+    unsigned rows = (tile_count + TILESET_COLUMNS - 1) / TILESET_COLUMNS;
+    std::ofstream file(path, std::ios::trunc);
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         << "<map version=\"1.2\" orientation=\"orthogonal\" renderorder=\"right-down\" width=\"1\" height=\"1\""
+         << " tilewidth=\"" << TILE_SIZE << "\" tileheight=\"" << TILE_SIZE << "\">\n"
+         << " <tileset firstgid=\"1\" name=\"bench\" tilewidth=\"" << TILE_SIZE << "\" tileheight=\"" << TILE_SIZE << "\""
+         << " tilecount=\"" << rows * TILESET_COLUMNS << "\" columns=\"" << TILESET_COLUMNS << "\">\n"
+         << "  <image source=\"" << image << "\" width=\"" << TILESET_COLUMNS * TILE_SIZE << "\" height=\"" << rows * TILE_SIZE << "\"/>\n";
+    for(unsigned id = 0; id < tile_count; id++) {
+        file << "  <tile id=\"" << id << "\" type=\"ACTOR_TEMPLATE\">\n"
+             << "   <properties><property name=\"ACTOR_NAME\" value=\"ACTOR_" << id << "\"/></properties>\n"
+             << "   <objectgroup><object id=\"1\" x=\"2\" y=\"2\" width=\"12\" height=\"12\"/></objectgroup>\n"
+             << "  </tile>\n";
+    }
+    file << " </tileset>\n"
+         << " <layer id=\"1\" name=\"ground\" width=\"1\" height=\"1\"><data encoding=\"csv\">0</data></layer>\n";
+    if(!objects.empty()) {
+        file << " <objectgroup id=\"2\" name=\"actors\">\n";
+        for(unsigned i = 0; i < objects.size(); i++) {
+            file << "  <object id=\"" << i + 1 << "\" name=\"actor_" << i << "\" gid=\"1\" x=\"" << objects[i].x << "\" y=\"" << objects[i].y << "\""
+                 << " width=\"" << TILE_SIZE << "\" height=\"" << TILE_SIZE << "\"/>\n";
+        }
+        file << " </objectgroup>\n";
+    }
+    file << "</map>\n";
+    return static_cast<bool>(file);
+}
+
+/// Returns the fastest of several loads of the map in milliseconds or a negative value on failure
+double best_load_milliseconds(GameInfo& game, const std::string& path, unsigned runs) {
+    double best = -1.0;
+    for(unsigned i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if(!game.load_map(path, true)) {return -1.0;}
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        game.close_map();
+        if(best < 0.0 || milliseconds < best) {best = milliseconds;}
+    }
+    return best;
+}
+
+/// Returns true if the actor template of each tile got registered under the gid of its tile
+bool check_actor_gids(GameInfo& game, const std::string& path, unsigned tile_count) {
+    if(!game.load_map(path, true)) {return false;}
+    bool success = true;
+    MapData& map = game.get_map();
+    for(unsigned id = 0; id < tile_count && success; id++) {
+        success = map.is_actor(id + 1) && map.get_actor(id + 1).get_type() == "ACTOR_" + std::to_string(id);
+    }
+    game.close_map();
+    return success;
+}
+
+/**
+ * @brief Times loading tilesets of 1250 up to 10000 actor template tiles
+ * @param check_scaling If true fail if the time per tile grows too much, which is unreliable on busy machines
+ *
+ * Parsing each actor template looks up its gid, so the load time per tile stays flat
+ * if the lookup takes constant time. A linear lookup makes it grow with the tile count.
+ * Each template has to end up registered under the gid of its tile.
+ */
+int bench_tileset(GameInfo& game, const std::string& directory, bool check_scaling) {
+    const std::vector<unsigned> TILE_COUNTS = {1250, 2500, 5000, 10000};
+    const unsigned RUNS = 3;
+    // A linear gid lookup would grow the time per tile by about 8 from the smallest to the biggest tileset
+    const double MAX_GROWTH = 4.0;
+
+    std::printf("%8s %12s %12s\n", "tiles", "load ms", "us per tile");
+    std::vector<double> per_tile;
+    for(unsigned tile_count : TILE_COUNTS) {
+        std::string name = "tileset_" + std::to_string(tile_count);
+        if(!write_tileset_image(directory + name + ".bmp", tile_count) ||
+           !write_map(directory + name + ".tmx", name + ".bmp", tile_count)) {
+            std::cerr << "Failed writing " << directory + name << "\n";
+            return EXIT_FAILURE;
+        }
+        double milliseconds = best_load_milliseconds(game, directory + name + ".tmx", RUNS);
+        if(milliseconds < 0.0) {
+            std::cerr << "Failed loading " << directory + name << ".tmx\n";
+            return EXIT_FAILURE;
+        }
+        if(!check_actor_gids(game, directory + name + ".tmx", tile_count)) {
+            std::cerr << "Actor templates of " << directory + name << ".tmx aren't registered under the gids of their tiles\n";
+            return EXIT_FAILURE;
+        }
+        per_tile.push_back(milliseconds * 1000.0 / tile_count);
+        std::printf("%8u %12.2f %12.3f\n", tile_count, milliseconds, per_tile.back());
+    }
+
+    double growth = per_tile.back() / per_tile.front();
+    std::printf("Time per tile grew by %.2f from %u to %u tiles\n", growth, TILE_COUNTS.front(), TILE_COUNTS.back());
+    if(check_scaling && growth > MAX_GROWTH) {
+        std::cerr << "Load time grows faster than linear with the tile count\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/// A collision of two actors as (actor, other actor, hitbox of the actor, hitbox of the other actor)
+typedef std::tuple<unsigned, unsigned, HitboxId, HitboxId> ActorPair;
+
+/// Returns the sorted actor collisions which the last update added to the actors
+std::vector<ActorPair> registered_pairs(const std::vector<Actor*>& actors) {
+    std::unordered_map<const Actor*, unsigned> indices;
+    for(unsigned i = 0; i < actors.size(); i++) {indices[actors[i]] = i;}
+    std::vector<ActorPair> pairs;
+    for(unsigned i = 0; i < actors.size(); i++) {
+        for(const Collision& c : actors[i]->get_collisions()) {
+            if(!c.actor()) {continue;}
+            pairs.emplace_back(i, indices.at(c.get_actor()), c.get_my_hitbox_id(), c.get_other_hitbox_id());
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+/// Returns the sorted actor collisions found by testing all pairs of actors
+std::vector<ActorPair> brute_force_pairs(const std::vector<Actor*>& actors) {
+    std::vector<HitboxSet> hitboxes;
+    for(Actor* actor : actors) {hitboxes.push_back(actor->get_hitboxes());}
+    std::vector<ActorPair> pairs;
+    for(unsigned i = 0; i < actors.size(); i++) {
+        for(unsigned j = i + 1; j < actors.size(); j++) {
+            if(!actors[i]->get_collision_filter().accepts(actors[j]->get_collision_filter())) {continue;}
+            for(const HitboxSet::Entry& first : hitboxes[i]) {
+                if(first.rect.empty()) {continue;}
+                for(const HitboxSet::Entry& second : hitboxes[j]) {
+                    if(second.rect.empty() || !first.rect.has_intersection(second.rect)) {continue;}
+                    pairs.emplace_back(i, j, first.id, second.id);
+                    pairs.emplace_back(j, i, second.id, first.id);
+                }
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+/**
+ * @brief Times the collision check of a map with the given number of actors
+ * @param milliseconds Returns the mean time of one update after the first one
+ * @param pairs Returns the actor collisions of the last update
+ * @param brute_force Returns the actor collisions of testing all pairs after the last update
+ * @return False if the map failed to load
+ *
+ * Each frame moves all actors by a random step. The same seed yields the same moves for each broad phase.
+ */
+bool run_collision_frames(GameInfo& game, const std::string& path, salmon::BroadPhase broad_phase,
+                          double& milliseconds, std::vector<ActorPair>& pairs, std::vector<ActorPair>& brute_force) {
+    const unsigned FRAMES = 20;
+    if(!game.load_map(path, true)) {return false;}
+    LayerCollection& layers = game.get_map().get_layer_collection();
+    layers.set_broad_phase(broad_phase);
+    std::vector<Actor*> actors = layers.get_actors();
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+    double total = 0.0;
+    for(unsigned frame = 0; frame < FRAMES; frame++) {
+        for(Actor* actor : actors) {
+            actor->move_relative(step(random), step(random));
+            actor->clear_collisions();
+        }
+        auto start = std::chrono::steady_clock::now();
+        layers.update();
+        // The first update fills the caches of the broad and narrow phase
+        if(frame > 0) {total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();}
+    }
+    milliseconds = total / (FRAMES - 1);
+    pairs = registered_pairs(actors);
+    brute_force = brute_force_pairs(actors);
+    game.close_map();
+    return true;
+}
+
+/**
+ * @brief Times the collision check with both broad phases and compares their results to testing all pairs
+ *
+ * The actors are spread at a constant density, so the number of collisions grows linearly with their count.
+ * The time per actor should stay about flat, while testing all pairs would grow it with the actor count.
+ */
+int bench_collision(GameInfo& game, const std::string& directory, const std::vector<unsigned>& actor_counts, bool check_scaling) {
+    // Testing all pairs would grow the time per actor by 200 from 100 to 20000 actors
+    const double MAX_GROWTH = 8.0;
+    const float AREA_PER_ACTOR = 64.0f * 64.0f;
+
+    if(!write_tileset_image(directory + "collision.bmp", 1)) {
+        std::cerr << "Failed writing " << directory << "collision.bmp\n";
+        return EXIT_FAILURE;
+    }
+
+    std::printf("%8s %10s %12s %12s %12s %12s\n", "actors", "pairs", "grid ms", "grid us/a", "sap ms", "sap us/a");
+    std::vector<double> per_actor[2];
+    int exit_code = EXIT_SUCCESS;
+    for(unsigned actor_count : actor_counts) {
+        std::mt19937 random(actor_count);
+        std::uniform_real_distribution<float> coordinate(0.0f, std::sqrt(actor_count * AREA_PER_ACTOR));
+        std::vector<salmon::Point> objects(actor_count);
+        for(salmon::Point& object : objects) {
+            object.x = coordinate(random);
+            object.y = coordinate(random);
+        }
+        std::string path = directory + "collision_" + std::to_string(actor_count) + ".tmx";
+        if(!write_map(path, "collision.bmp", 1, objects)) {
+            std::cerr << "Failed writing " << path << "\n";
+            return EXIT_FAILURE;
+        }
+
+        double milliseconds[2];
+        std::vector<ActorPair> pairs[2];
+        std::vector<ActorPair> brute_force[2];
+        const salmon::BroadPhase broad_phases[2] = {salmon::BroadPhase::grid, salmon::BroadPhase::sweep_and_prune};
+        for(unsigned i = 0; i < 2; i++) {
+            if(!run_collision_frames(game, path, broad_phases[i], milliseconds[i], pairs[i], brute_force[i])) {
+                std::cerr << "Failed loading " << path << "\n";
+                return EXIT_FAILURE;
+            }
+            per_actor[i].push_back(milliseconds[i] * 1000.0 / actor_count);
+        }
+        std::printf("%8u %10zu %12.3f %12.3f %12.3f %12.3f\n", actor_count, brute_force[0].size() / 2,
+                    milliseconds[0], per_actor[0].back(), milliseconds[1], per_actor[1].back());
+
+        const char* names[2] = {"grid", "sweep and prune"};
+        for(unsigned i = 0; i < 2; i++) {
+            if(pairs[i] != brute_force[i]) {
+                std::cerr << "Collisions of the " << names[i] << " broad phase differ from testing all pairs with "
+                          << actor_count << " actors: " << pairs[i].size() << " instead of " << brute_force[i].size() << "\n";
+                exit_code = EXIT_FAILURE;
+            }
+        }
+        if(pairs[0] != pairs[1]) {
+            std::cerr << "Collisions of the grid and the sweep and prune broad phase differ with " << actor_count << " actors\n";
+            exit_code = EXIT_FAILURE;
+        }
+    }
+
+    for(unsigned i = 0; i < 2 && actor_counts.size() > 1; i++) {
+        double growth = per_actor[i].back() / per_actor[i].front();
+        std::printf("Time per actor of the %s grew by %.2f from %u to %u actors\n", i == 0 ? "grid" : "sweep and prune",
+                    growth, actor_counts.front(), actor_counts.back());
+        if(check_scaling && growth > MAX_GROWTH) {
+            std::cerr << "Collision check grows faster than linear with the actor count\n";
+            exit_code = EXIT_FAILURE;
+        }
+    }
+    return exit_code;
+}
+
+/**
+ * @brief Writes a map with one actor template, one solid tile and a layer of randomly placed solid tiles
+ * @param objects The positions of actors of the template, which get placed in one object layer
+ */
+bool write_tile_map(const std::string& path, const std::string& image, unsigned width, unsigned height,
+                    const std::vector<salmon::Point>& objects, std::mt19937& random) {
+    std::ofstream file(path, std::ios::trunc);
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         << "<map version=\"1.2\" orientation=\"orthogonal\" renderorder=\"right-down\" width=\"" << width << "\" height=\"" << height << "\""
+         << " tilewidth=\"" << TILE_SIZE << "\" tileheight=\"" << TILE_SIZE << "\">\n"
+         << " <tileset firstgid=\"1\" name=\"bench\" tilewidth=\"" << TILE_SIZE << "\" tileheight=\"" << TILE_SIZE << "\""
+         << " tilecount=\"" << TILESET_COLUMNS << "\" columns=\"" << TILESET_COLUMNS << "\">\n"
+         << "  <image source=\"" << image << "\" width=\"" << TILESET_COLUMNS * TILE_SIZE << "\" height=\"" << TILE_SIZE << "\"/>\n"
+         << "  <tile id=\"0\" type=\"ACTOR_TEMPLATE\">\n"
+         << "   <properties><property name=\"ACTOR_NAME\" value=\"ACTOR_0\"/></properties>\n"
+         << "   <objectgroup><object id=\"1\" x=\"2\" y=\"2\" width=\"12\" height=\"12\"/></objectgroup>\n"
+         << "  </tile>\n"
+         << "  <tile id=\"1\">\n"
+         << "   <objectgroup><object id=\"1\" x=\"2\" y=\"2\" width=\"12\" height=\"12\"/></objectgroup>\n"
+         << "  </tile>\n"
+         << " </tileset>\n"
+         << " <layer id=\"1\" name=\"ground\" width=\"" << width << "\" height=\"" << height << "\"><data encoding=\"csv\">\n";
+    std::bernoulli_distribution solid(0.3);
+    for(unsigned i = 0; i < width * height; i++) {
+        file << (solid(random) ? SOLID_GID : 0) << (i + 1 < width * height ? "," : "\n");
+    }
+    file << "</data></layer>\n"
+         << " <objectgroup id=\"2\" name=\"actors\">\n";
+    for(unsigned i = 0; i < objects.size(); i++) {
+        file << "  <object id=\"" << i + 1 << "\" name=\"actor_" << i << "\" gid=\"1\" x=\"" << objects[i].x << "\" y=\"" << objects[i].y << "\""
+             << " width=\"" << TILE_SIZE << "\" height=\"" << TILE_SIZE << "\"/>\n";
+    }
+    file << " </objectgroup>\n"
+         << "</map>\n";
+    return static_cast<bool>(file);
+}
+
+/// A collision of an actor with a tile as (actor, tile x, tile y, hitbox of the actor, hitbox of the tile)
+typedef std::tuple<unsigned, float, float, HitboxId, HitboxId> TileHit;
+
+/// Returns the tile collisions which the last update added to the actors, in the order the actors got them
+std::vector<TileHit> registered_tiles(const std::vector<Actor*>& actors) {
+    std::vector<TileHit> hits;
+    for(unsigned i = 0; i < actors.size(); i++) {
+        for(const Collision& c : actors[i]->get_collisions()) {
+            if(!c.tile()) {continue;}
+            salmon::Point p = c.get_transform().get_relative(0,0);
+            hits.emplace_back(i, p.x, p.y, c.get_my_hitbox_id(), c.get_other_hitbox_id());
+        }
+    }
+    return hits;
+}
+
+/// Returns the sorted tile collisions found by testing each actor against all tiles of each map layer
+std::vector<TileHit> brute_force_tiles(LayerCollection& layers, const std::vector<Actor*>& actors, unsigned width, unsigned height) {
+    std::vector<HitboxSet> hitboxes;
+    for(Actor* actor : actors) {hitboxes.push_back(actor->get_hitboxes());}
+    std::vector<TileHit> hits;
+    for(MapLayer* layer : layers.get_map_layers()) {
+        salmon::Point origin = layer->get_transform().get_relative(0,0);
+        salmon::Rect all{origin.x, origin.y, static_cast<float>(width * TILE_SIZE), static_cast<float>(height * TILE_SIZE)};
+        layer->for_each_tile_collider(all, [&](const TileCollider& tile) {
+            salmon::Point p = tile.get_instance().get_transform().get_relative(0,0);
+            for(unsigned i = 0; i < actors.size(); i++) {
+                if(!actors[i]->get_collision_filter().accepts(layer->get_collision_filter())) {continue;}
+                for(const HitboxSet::Entry& first : hitboxes[i]) {
+                    if(first.rect.empty()) {continue;}
+                    for(const HitboxSet::Entry& second : tile) {
+                        salmon::Rect rect = tile.get_hitbox(second);
+                        if(rect.empty() || !first.rect.has_intersection(rect)) {continue;}
+                        hits.emplace_back(i, p.x, p.y, first.id, second.id);
+                    }
+                }
+            }
+        });
+    }
+    std::sort(hits.begin(), hits.end());
+    return hits;
+}
+
+/// The collisions of all actors after one update
+struct FrameResult {
+    std::vector<ActorPair> pairs;
+    std::vector<TileHit> tiles; ///< In the order the actors got them
+    std::vector<ActorPair> brute_force_pairs;
+    std::vector<TileHit> brute_force_tiles;
+};
+
+/**
+ * @brief Times the collision check of a map whose actors mostly stand still
+ * @param tile_cache If false the tile collisions of each actor get tested again every frame
+ * @param milliseconds Returns the mean time of one update after the first one
+ * @param frames Returns the collisions after each update, the brute force results are only filled if brute_force is true
+ * @return False if the map failed to load
+ *
+ * Each frame a few actors move. Every few frames some tiles get replaced or the map layer moves,
+ * which has to invalidate the cached tile collisions of all actors. The same seed yields the
+ * same changes for each run.
+ */
+bool run_static_frames(GameInfo& game, const std::string& path, unsigned width, unsigned height, bool tile_cache, bool brute_force,
+                       double& milliseconds, std::vector<FrameResult>& frames) {
+    const unsigned FRAMES = 30;
+    if(!game.load_map(path, true)) {return false;}
+    LayerCollection& layers = game.get_map().get_layer_collection();
+    layers.set_tile_cache(tile_cache);
+    std::vector<Actor*> actors = layers.get_actors();
+    std::vector<MapLayer*> map_layers = layers.get_map_layers();
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+    std::bernoulli_distribution moves(0.05);
+    std::uniform_int_distribution<unsigned> tile_x(0, width - 1);
+    std::uniform_int_distribution<unsigned> tile_y(0, height - 1);
+    double total = 0.0;
+    frames.clear();
+    for(unsigned frame = 0; frame < FRAMES; frame++) {
+        for(Actor* actor : actors) {
+            if(moves(random)) {actor->move_relative(step(random), step(random));}
+            actor->clear_collisions();
+        }
+        for(MapLayer* layer : map_layers) {
+            if(frame % 5 == 4) {
+                for(unsigned i = 0; i < 20; i++) {
+                    unsigned x = tile_x(random);
+                    unsigned y = tile_y(random);
+                    layer->set_tile_id(x, y, layer->get_tile_id(x, y) == 0 ? SOLID_GID : 0);
+                }
+            }
+            if(frame % 7 == 6) {layer->get_transform().move_pos(3.0f, -2.0f);}
+        }
+        auto start = std::chrono::steady_clock::now();
+        layers.update();
+        // The first update fills the caches
+        if(frame > 0) {total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();}
+
+        frames.emplace_back();
+        FrameResult& result = frames.back();
+        result.pairs = registered_pairs(actors);
+        result.tiles = registered_tiles(actors);
+        if(brute_force) {
+            result.brute_force_pairs = brute_force_pairs(actors);
+            result.brute_force_tiles = brute_force_tiles(layers, actors, width, height);
+        }
+    }
+    milliseconds = total / (FRAMES - 1);
+    game.close_map();
+    return true;
+}
+
+/**
+ * @brief Times the collision check of mostly static actors with and without the tile cache
+ *
+ * Each frame the collisions with the cache have to match the ones without it, in the same order,
+ * and testing all pairs of actors and all pairs of actors and tiles.
+ */
+int bench_static(GameInfo& game, const std::string& directory) {
+    const unsigned ACTOR_COUNT = 1000;
+    const unsigned MAP_SIZE = 64; // Measured in tiles
+
+    if(!write_tileset_image(directory + "static.bmp", 2)) {
+        std::cerr << "Failed writing " << directory << "static.bmp\n";
+        return EXIT_FAILURE;
+    }
+    std::mt19937 random(ACTOR_COUNT);
+    std::uniform_real_distribution<float> coordinate(0.0f, static_cast<float>((MAP_SIZE - 1) * TILE_SIZE));
+    std::vector<salmon::Point> objects(ACTOR_COUNT);
+    for(salmon::Point& object : objects) {
+        object.x = coordinate(random);
+        object.y = coordinate(random);
+    }
+    std::string path = directory + "static.tmx";
+    if(!write_tile_map(path, "static.bmp", MAP_SIZE, MAP_SIZE, objects, random)) {
+        std::cerr << "Failed writing " << path << "\n";
+        return EXIT_FAILURE;
+    }
+
+    double milliseconds[2];
+    std::vector<FrameResult> frames[2];
+    for(unsigned i = 0; i < 2; i++) {
+        // Only the run with the cache needs to be checked against brute force, the other one has to match it
+        if(!run_static_frames(game, path, MAP_SIZE, MAP_SIZE, i == 0, i == 0, milliseconds[i], frames[i])) {
+            std::cerr << "Failed loading " << path << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    std::printf("%8s %12s %12s\n", "actors", "cache ms", "no cache ms");
+    std::printf("%8u %12.3f %12.3f\n", ACTOR_COUNT, milliseconds[0], milliseconds[1]);
+
+    int exit_code = EXIT_SUCCESS;
+    for(unsigned frame = 0; frame < frames[0].size(); frame++) {
+        const FrameResult& cached = frames[0][frame];
+        const FrameResult& uncached = frames[1][frame];
+        std::vector<TileHit> sorted_tiles = cached.tiles;
+        std::sort(sorted_tiles.begin(), sorted_tiles.end());
+        if(cached.pairs != cached.brute_force_pairs) {
+            std::cerr << "Actor collisions differ from testing all pairs in frame " << frame << ": "
+                      << cached.pairs.size() << " instead of " << cached.brute_force_pairs.size() << "\n";
+            exit_code = EXIT_FAILURE;
+        }
+        if(sorted_tiles != cached.brute_force_tiles) {
+            std::cerr << "Tile collisions differ from testing all tiles in frame " << frame << ": "
+                      << sorted_tiles.size() << " instead of " << cached.brute_force_tiles.size() << "\n";
+            exit_code = EXIT_FAILURE;
+        }
+        if(cached.pairs != uncached.pairs || cached.tiles != uncached.tiles) {
+            std::cerr << "Collisions with and without the tile cache differ in frame " << frame << "\n";
+            exit_code = EXIT_FAILURE;
+        }
+    }
+    return exit_code;
+}
+
+void print_usage() {
+    std::cout << "Usage: salmon-bench [-s] <mode> [counts]...\n"
+              << "Benchmarks generated maps, which get written to the temporary directory.\n"
+              << "Fails if the results are wrong, timings only fail with -s.\n"
+              << "  -s          Fail if the time per tile or actor grows faster than linear\n"
+              << "  tileset     Load tilesets of 1250 up to 10000 actor template tiles\n"
+              << "  collision   Check collisions of 100 up to 20000 actors, or of the given actor counts,\n"
+              << "              and compare the results of both broad phases to testing all pairs\n"
+              << "  static      Check collisions of mostly still actors while tiles get replaced and the layer moves,\n"
+              << "              and compare the results with and without the tile cache to testing all pairs\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool check_scaling = false;
+    std::string mode;
+    std::vector<unsigned> counts;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "-h" || arg == "--help") {print_usage(); return EXIT_SUCCESS;}
+        else if(arg == "-s") {check_scaling = true;}
+        else if(mode.empty()) {mode = arg;}
+        else {
+            unsigned count = std::strtoul(argv[i], nullptr, 10);
+            if(count == 0) {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+            counts.push_back(count);
+        }
+    }
+    if(mode == "collision" && counts.empty()) {counts = {100, 1000, 5000, 20000};}
+    else if(mode != "collision" && ((mode != "tileset" && mode != "static") || !counts.empty())) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    std::error_code error;
+    fs::path directory = fs::temp_directory_path(error) / "salmon-bench";
+    fs::create_directories(directory, error);
+    if(error) {
+        std::cerr << "Can't create " << directory.string() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // Run without a display, the vsynced renderer of GameInfo needs the software driver then
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    GameInfo game;
+
+    if(mode == "collision") {return bench_collision(game, directory.generic_string() + "/", counts, check_scaling);}
+    if(mode == "static") {return bench_static(game, directory.generic_string() + "/");}
+    return bench_tileset(game, directory.generic_string() + "/", check_scaling);
+}
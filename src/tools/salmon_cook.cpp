@@ -0,0 +1,322 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file salmon_cook.cpp
+ * @brief Command line tool which cooks all maps and images of data directories
+ *
+ * Maps become cooked maps (see CookedMap) and images become cooked images (see CookedImage).
+ * The content hash of the inputs of each cooked file gets stored in a manifest per data
+ * directory, so unchanged files get skipped on the next run. Files are cooked in parallel.
+ * Afterwards each map gets loaded like the engine does, with SDL's dummy video driver and
+ * a software renderer, so broken maps fail here instead of in the game.
+ */
+#define SDL_MAIN_HANDLED
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include "core/gameinfo.hpp"
+#include "graphics/cooked_image.hpp"
+#include "map/cooked_map.hpp"
+#include "map/map_cooker.hpp"
+#include "util/mapped_file.hpp"
+#include "util/thread_pool.hpp"
+
+namespace fs = std::experimental::filesystem;
+
+using namespace salmon::internal;
+
+namespace {
+
+const char* const MANIFEST_NAME = ".salmon-cook";
+const std::vector<std::string> IMAGE_FORMATS = {".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff"};
+
+/// A file which gets cooked and its outcome
+struct CookJob {
+    enum Type {
+        map,
+        image,
+    };
+    enum Status {
+        cooked,
+        skipped,
+        failed,
+    };
+    Type type;
+    std::string path;
+    std::string manifest_path; ///< Relative to the data directory
+    Uint64 old_hash = 0; ///< Content hash of the last run, zero if unknown
+
+    Status status = failed;
+    Uint64 hash = 0;
+    double milliseconds = 0.0;
+    Uint64 in_size = 0; ///< Size of all inputs in bytes
+    Uint64 out_size = 0; ///< Size of the cooked file in bytes
+};
+
+/// 64 bit FNV-1a hash, continued from the given hash
+Uint64 hash_bytes(const Uint8* data, size_t size, Uint64 hash = 14695981039346656037ULL) {
+    for(size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// Hashes the content of a file into the given hash
+bool hash_file(const std::string& path, Uint64& hash, Uint64& size) {
+    MappedFile file;
+    if(!file.open(path)) {return false;}
+    hash = hash_bytes(file.get_data(), file.get_size(), hash);
+    size += file.get_size();
+    return true;
+}
+
+std::string lower_extension(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c){return std::tolower(c);});
+    return extension;
+}
+
+Uint64 file_size(const std::string& path) {
+    std::error_code error;
+    Uint64 size = fs::file_size(fs::path(path), error);
+    return error ? 0 : size;
+}
+
+/// Hashes the sources recorded in an up to date cooked map
+bool hash_map(const std::string& path, CookJob& job) {
+    std::string base_path = path.substr(0, path.find_last_of('/') + 1);
+    CookedMap cooked;
+    if(!cooked.open(path + CookedMap::EXTENSION, base_path)) {return false;}
+    job.hash = 14695981039346656037ULL;
+    job.in_size = 0;
+    for(const CookedMap::Source& source : cooked.get_sources()) {
+        if(!hash_file(base_path + source.path, job.hash, job.in_size)) {return false;}
+    }
+    return true;
+}
+
+void cook_map(CookJob& job, bool force) {
+    if(!force && hash_map(job.path, job) && job.hash == job.old_hash) {
+        job.status = CookJob::skipped;
+    }
+    else if(MapCooker::cook(job.path) == tinyxml2::XML_SUCCESS && hash_map(job.path, job)) {
+        job.status = CookJob::cooked;
+    }
+    else {
+        job.status = CookJob::failed;
+    }
+    job.out_size = file_size(job.path + CookedMap::EXTENSION);
+}
+
+void cook_image(CookJob& job, bool force) {
+    job.hash = 14695981039346656037ULL;
+    if(!hash_file(job.path, job.hash, job.in_size)) {
+        job.status = CookJob::failed;
+        return;
+    }
+
+    if(!force && job.hash == job.old_hash && CookedImage::is_current(job.path)) {
+        job.status = CookJob::skipped;
+    }
+    else {
+        SDL_Surface* surface = IMG_Load(job.path.c_str());
+        if(surface == nullptr) {
+            std::cerr << "Unable to load image " << job.path << "! SDL_image Error: " << IMG_GetError() << "\n";
+            job.status = CookJob::failed;
+        }
+        else {
+            job.status = CookedImage::write(job.path, surface) ? CookJob::cooked : CookJob::failed;
+            SDL_FreeSurface(surface);
+        }
+    }
+    job.out_size = file_size(job.path + CookedImage::EXTENSION);
+}
+
+/// Reads the manifest of a data directory which maps relative paths to content hashes
+std::map<std::string, Uint64> read_manifest(const std::string& directory) {
+    std::map<std::string, Uint64> manifest;
+    std::ifstream file(directory + MANIFEST_NAME);
+    std::string line;
+    while(std::getline(file, line)) {
+        size_t split = line.find(' ');
+        if(split == std::string::npos) {continue;}
+        manifest[line.substr(split + 1)] = std::strtoull(line.substr(0, split).c_str(), nullptr, 16);
+    }
+    return manifest;
+}
+
+bool write_manifest(const std::string& directory, const std::map<std::string, Uint64>& manifest) {
+    std::ofstream file(directory + MANIFEST_NAME, std::ios::trunc);
+    for(auto& entry : manifest) {
+        char hash[17];
+        std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(entry.second));
+        file << hash << ' ' << entry.first << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+void print_usage() {
+    std::cout << "Usage: salmon-cook [-f] [-j threads] <data directory>...\n"
+              << "Cooks all .tmx maps and images below the data directories for faster loading.\n"
+              << "Each map gets loaded afterwards and counts as failed if that doesn't work.\n"
+              << "  -f          Cook all files, even unchanged ones\n"
+              << "  -j threads  Number of worker threads, defaults to all cores\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool force = false;
+    unsigned threads = ThreadPool::default_size();
+    std::vector<std::string> directories;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "-f") {force = true;}
+        else if(arg == "-j" && i + 1 < argc) {threads = std::strtoul(argv[++i], nullptr, 10);}
+        else if(arg == "-h" || arg == "--help") {print_usage(); return EXIT_SUCCESS;}
+        else if(!arg.empty() && arg[0] == '-') {print_usage(); return EXIT_FAILURE;}
+        else {
+            if(arg.back() != '/') {arg += '/';}
+            directories.push_back(arg);
+        }
+    }
+    if(directories.empty()) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    // Collect all maps and images
+    std::vector<std::map<std::string, Uint64>> manifests;
+    std::vector<std::vector<CookJob>> jobs;
+    for(const std::string& directory : directories) {
+        std::error_code error;
+        if(!fs::is_directory(directory, error)) {
+            std::cerr << directory << " is no directory\n";
+            return EXIT_FAILURE;
+        }
+        manifests.push_back(read_manifest(directory));
+        jobs.emplace_back();
+        for(const fs::directory_entry& entry : fs::recursive_directory_iterator(directory)) {
+            if(!fs::is_regular_file(entry.status())) {continue;}
+            std::string extension = lower_extension(entry.path());
+            CookJob job;
+            if(extension == ".tmx") {job.type = CookJob::map;}
+            else if(std::find(IMAGE_FORMATS.begin(), IMAGE_FORMATS.end(), extension) != IMAGE_FORMATS.end()) {job.type = CookJob::image;}
+            else {continue;}
+
+            job.path = entry.path().generic_string();
+            job.manifest_path = job.path.substr(directory.size());
+            auto old = manifests.back().find(job.manifest_path);
+            if(old != manifests.back().end()) {job.old_hash = old->second;}
+            jobs.back().push_back(job);
+        }
+        std::sort(jobs.back().begin(), jobs.back().end(), [](const CookJob& a, const CookJob& b){return a.path < b.path;});
+    }
+
+    // Cook all files on the worker threads
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> results;
+        for(std::vector<CookJob>& directory_jobs : jobs) {
+            for(CookJob& job : directory_jobs) {
+                CookJob* p_job = &job;
+                results.push_back(pool.submit([p_job, force](){
+                    auto job_start = std::chrono::steady_clock::now();
+                    if(p_job->type == CookJob::map) {cook_map(*p_job, force);}
+                    else {cook_image(*p_job, force);}
+                    p_job->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job_start).count();
+                }));
+            }
+        }
+        for(std::future<void>& result : results) {result.get();}
+    }
+
+    // Load each map once all images are cooked, on this thread since GameInfo isn't thread safe
+    bool any_map = false;
+    for(const std::vector<CookJob>& directory_jobs : jobs) {
+        for(const CookJob& job : directory_jobs) {
+            if(job.type == CookJob::map && job.status != CookJob::failed) {any_map = true;}
+        }
+    }
+    if(any_map) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        GameInfo game;
+        for(std::vector<CookJob>& directory_jobs : jobs) {
+            for(CookJob& job : directory_jobs) {
+                if(job.type != CookJob::map || job.status == CookJob::failed) {continue;}
+                auto load_start = std::chrono::steady_clock::now();
+                if(game.load_map(job.path, true)) {game.close_map();}
+                else {
+                    std::cerr << "Unable to load cooked map " << job.path << "\n";
+                    job.status = CookJob::failed;
+                }
+                job.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+            }
+        }
+    }
+    double total_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Report each file and update the manifests
+    const char* status_names[] = {"cooked ", "skipped", "FAILED "};
+    unsigned counts[3] = {0, 0, 0};
+    Uint64 total_in = 0;
+    Uint64 total_out = 0;
+    int exit_code = EXIT_SUCCESS;
+    for(unsigned i = 0; i < directories.size(); i++) {
+        for(const CookJob& job : jobs[i]) {
+            std::printf("%s %9.2f ms %12llu -> %12llu bytes  %s\n", status_names[job.status], job.milliseconds,
+                        static_cast<unsigned long long>(job.in_size), static_cast<unsigned long long>(job.out_size), job.path.c_str());
+            counts[job.status]++;
+            total_in += job.in_size;
+            total_out += job.out_size;
+            if(job.status == CookJob::failed) {
+                manifests[i].erase(job.manifest_path);
+                exit_code = EXIT_FAILURE;
+            }
+            else {
+                manifests[i][job.manifest_path] = job.hash;
+            }
+        }
+        if(!write_manifest(directories[i], manifests[i])) {
+            std::cerr << "Failed writing manifest of " << directories[i] << "\n";
+            exit_code = EXIT_FAILURE;
+        }
+    }
+    std::printf("%u cooked, %u skipped, %u failed in %.2f ms on %u threads, %llu -> %llu bytes\n",
+                counts[CookJob::cooked], counts[CookJob::skipped], counts[CookJob::failed], total_milliseconds,
+                std::max(threads, 1u), static_cast<unsigned long long>(total_in), static_cast<unsigned long long>(total_out));
+
+    return exit_code;
+}
@@ -24,7 +24,7 @@
 
 namespace salmon { namespace internal {
 
-tinyxml2::XMLError AttributeParser::parse(tinyxml2::XMLElement* source, bool ignore_missing) {
+tinyxml2::XMLError AttributeParser::parse(const Element* source, bool ignore_missing) {
     using namespace tinyxml2;
     XMLError eResult;
     for(auto& entry : m_bool) {
@@ -24,6 +24,7 @@
 #include <map>
 #include <tinyxml2.h>
 
+#include "util/element_tree.hpp"
 #include "util/game_types.hpp"
 
 namespace salmon { namespace internal {
@@ -38,7 +39,7 @@ class AttributeParser{
         void add(int& value, std::string name) {m_int[name] = &value;}
         void add(float& value, std::string name) {m_float[name] = &value;}
         void add(std::string& value, std::string name) {m_string[name] = &value;}
-        tinyxml2::XMLError parse(tinyxml2::XMLElement* source, bool ignore_missing = false);
+        tinyxml2::XMLError parse(const Element* source, bool ignore_missing = false);
 
     private:
         std::map<std::string, bool*> m_bool;
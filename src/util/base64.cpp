@@ -0,0 +1,144 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/base64.hpp"
+
+#include <cstring>
+
+namespace salmon { namespace internal {
+
+namespace base64{
+
+namespace {
+    const Uint8 INVALID = 0xFF;
+    const Uint8 SPACE = 0xFE;
+    const Uint8 PADDING = 0xFD;
+
+    /// Maps each character to its 6 bit value or to one of the markers above
+    struct DecodeTable {
+        Uint8 values[256];
+        DecodeTable() {
+            std::memset(values, INVALID, sizeof(values));
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for(Uint8 i = 0; i < 64; i++) {
+                values[static_cast<unsigned char>(alphabet[i])] = i;
+            }
+            values[static_cast<unsigned char>(' ')] = SPACE;
+            values[static_cast<unsigned char>('\t')] = SPACE;
+            values[static_cast<unsigned char>('\n')] = SPACE;
+            values[static_cast<unsigned char>('\r')] = SPACE;
+            values[static_cast<unsigned char>('=')] = PADDING;
+        }
+    };
+    const DecodeTable s_table;
+}
+
+/**
+ * @brief Decodes base64 text into a buffer
+ * @param text The base64 encoded text
+ * @param length The length of @p text
+ * @param out The buffer receiving the decoded bytes
+ * @param capacity The size of @p out in bytes
+ * @param out_size Receives the number of decoded bytes
+ * @return @c bool which is false on invalid characters or if @p out is too small
+ *
+ * Whole quads without whitespace get decoded in one go, everything else falls
+ * back to decoding character by character.
+ */
+bool decode(const char* text, size_t length, Uint8* out, size_t capacity, size_t& out_size) {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(text);
+    const unsigned char* end = in + length;
+    const Uint8* t = s_table.values;
+    size_t n = 0;
+
+    Uint32 bits = 0;
+    unsigned count = 0;
+    while(in < end) {
+        // Fast path for whole quads
+        if(count == 0 && end - in >= 4) {
+            Uint8 a = t[in[0]];
+            Uint8 b = t[in[1]];
+            Uint8 c = t[in[2]];
+            Uint8 d = t[in[3]];
+            // Only 6 bit values are below 64
+            if((a | b | c | d) < 64) {
+                if(n + 3 > capacity) {return false;}
+                Uint32 quad = (a << 18) | (b << 12) | (c << 6) | d;
+                out[n] = quad >> 16;
+                out[n + 1] = quad >> 8;
+                out[n + 2] = quad;
+                n += 3;
+                in += 4;
+                continue;
+            }
+        }
+
+        Uint8 value = t[*in++];
+        if(value == SPACE) {continue;}
+        if(value == PADDING) {break;}
+        if(value == INVALID) {return false;}
+
+        bits = (bits << 6) | value;
+        if(++count == 4) {
+            if(n + 3 > capacity) {return false;}
+            out[n] = bits >> 16;
+            out[n + 1] = bits >> 8;
+            out[n + 2] = bits;
+            n += 3;
+            bits = 0;
+            count = 0;
+        }
+    }
+
+    // Flush the trailing partial quad
+    if(count == 1) {return false;}
+    if(count == 2) {
+        if(n + 1 > capacity) {return false;}
+        out[n++] = bits >> 4;
+    }
+    else if(count == 3) {
+        if(n + 2 > capacity) {return false;}
+        out[n++] = bits >> 10;
+        out[n++] = bits >> 2;
+    }
+
+    out_size = n;
+    return true;
+}
+
+/**
+ * @brief Decodes base64 text into a vector
+ * @param text The null terminated base64 encoded text
+ * @param bytes Receives the decoded bytes
+ * @return @c bool which is false on missing text or invalid characters
+ */
+bool decode(const char* text, std::vector<Uint8>& bytes) {
+    if(text == nullptr) {return false;}
+    size_t length = std::strlen(text);
+    bytes.resize(max_decoded_size(length));
+    size_t size = 0;
+    if(!decode(text, length, bytes.data(), bytes.size(), size)) {
+        bytes.clear();
+        return false;
+    }
+    bytes.resize(size);
+    return true;
+}
+
+}
+}} // namespace salmon::internal
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BASE64_HPP_INCLUDED
+#define BASE64_HPP_INCLUDED
+
+#include <SDL.h>
+#include <cstddef>
+#include <vector>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Table based base64 decoding straight into caller supplied memory
+ *
+ * Whitespace anywhere in the text gets skipped, decoding stops at the first padding character.
+ */
+namespace base64{
+    /// Returns the maximum number of bytes base64 text of the given length decodes to
+    inline size_t max_decoded_size(size_t length) {return length / 4 * 3 + 3;}
+
+    bool decode(const char* text, size_t length, Uint8* out, size_t capacity, size_t& out_size);
+    bool decode(const char* text, std::vector<Uint8>& bytes);
+}
+}} // namespace salmon::internal
+
+#endif // BASE64_HPP_INCLUDED
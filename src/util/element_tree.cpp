@@ -0,0 +1,296 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/element_tree.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace salmon { namespace internal {
+
+const Uint32 ElementTree::NONE = 0xFFFFFFFF;
+
+namespace {
+    /// Hexadecimal numbers get accepted like tinyxml2 does
+    bool is_prefix_hex(const char* text) {
+        while(std::isspace(static_cast<unsigned char>(*text))) {text++;}
+        return text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+    }
+
+    bool to_unsigned(const char* text, unsigned* value) {
+        return std::sscanf(text, is_prefix_hex(text) ? "%x" : "%u", value) == 1;
+    }
+
+    bool to_int(const char* text, int* value) {
+        if(is_prefix_hex(text)) {
+            unsigned hex;
+            if(std::sscanf(text, "%x", &hex) != 1) {return false;}
+            *value = static_cast<int>(hex);
+            return true;
+        }
+        return std::sscanf(text, "%d", value) == 1;
+    }
+
+    template<class T>
+    void append(std::vector<char>& buffer, const T* values, size_t count) {
+        const char* bytes = reinterpret_cast<const char*>(values);
+        buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+    }
+}
+
+/**
+ * @brief Returns the value of an attribute
+ * @param name The name of the attribute
+ * @param value Only return the attribute if it has this value, unless this is a @c nullptr
+ * @return The value or @c nullptr if the attribute is missing
+ */
+const char* Element::Attribute(const char* name, const char* value) const {
+    for(unsigned i = 0; i < m_attribute_count; i++) {
+        if(std::strcmp(m_attributes[i * 2], name) == 0) {
+            const char* found = m_attributes[i * 2 + 1];
+            return (value == nullptr || std::strcmp(found, value) == 0) ? found : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+/// Returns the first child element, optionally the first one with the given name
+const Element* Element::FirstChildElement(const char* name) const {
+    const Element* child = m_first_child;
+    while(child != nullptr && name != nullptr && std::strcmp(child->m_name, name) != 0) {
+        child = child->m_next_sibling;
+    }
+    return child;
+}
+
+/// Returns the next sibling element, optionally the next one with the given name
+const Element* Element::NextSiblingElement(const char* name) const {
+    const Element* sibling = m_next_sibling;
+    while(sibling != nullptr && name != nullptr && std::strcmp(sibling->m_name, name) != 0) {
+        sibling = sibling->m_next_sibling;
+    }
+    return sibling;
+}
+
+tinyxml2::XMLError Element::QueryBoolAttribute(const char* name, bool* value) const {
+    const char* text = Attribute(name);
+    if(text == nullptr) {return tinyxml2::XML_NO_ATTRIBUTE;}
+    int number;
+    if(to_int(text, &number)) {*value = number != 0;}
+    else if(std::strcmp(text, "true") == 0 || std::strcmp(text, "True") == 0 || std::strcmp(text, "TRUE") == 0) {*value = true;}
+    else if(std::strcmp(text, "false") == 0 || std::strcmp(text, "False") == 0 || std::strcmp(text, "FALSE") == 0) {*value = false;}
+    else {return tinyxml2::XML_WRONG_ATTRIBUTE_TYPE;}
+    return tinyxml2::XML_SUCCESS;
+}
+
+tinyxml2::XMLError Element::QueryIntAttribute(const char* name, int* value) const {
+    const char* text = Attribute(name);
+    if(text == nullptr) {return tinyxml2::XML_NO_ATTRIBUTE;}
+    return to_int(text, value) ? tinyxml2::XML_SUCCESS : tinyxml2::XML_WRONG_ATTRIBUTE_TYPE;
+}
+
+tinyxml2::XMLError Element::QueryUnsignedAttribute(const char* name, unsigned* value) const {
+    const char* text = Attribute(name);
+    if(text == nullptr) {return tinyxml2::XML_NO_ATTRIBUTE;}
+    return to_unsigned(text, value) ? tinyxml2::XML_SUCCESS : tinyxml2::XML_WRONG_ATTRIBUTE_TYPE;
+}
+
+tinyxml2::XMLError Element::QueryFloatAttribute(const char* name, float* value) const {
+    const char* text = Attribute(name);
+    if(text == nullptr) {return tinyxml2::XML_NO_ATTRIBUTE;}
+    return std::sscanf(text, "%f", value) == 1 ? tinyxml2::XML_SUCCESS : tinyxml2::XML_WRONG_ATTRIBUTE_TYPE;
+}
+
+tinyxml2::XMLError Element::QueryDoubleAttribute(const char* name, double* value) const {
+    const char* text = Attribute(name);
+    if(text == nullptr) {return tinyxml2::XML_NO_ATTRIBUTE;}
+    return std::sscanf(text, "%lf", value) == 1 ? tinyxml2::XML_SUCCESS : tinyxml2::XML_WRONG_ATTRIBUTE_TYPE;
+}
+
+/// Returns the attribute as int or @p default_value if it's missing or no number
+int Element::IntAttribute(const char* name, int default_value) const {
+    int value = default_value;
+    QueryIntAttribute(name, &value);
+    return value;
+}
+
+/// Returns the attribute as unsigned or @p default_value if it's missing or no number
+unsigned Element::UnsignedAttribute(const char* name, unsigned default_value) const {
+    unsigned value = default_value;
+    QueryUnsignedAttribute(name, &value);
+    return value;
+}
+
+/**
+ * @brief Copies an XML element with all its attributes, text and child elements
+ * @param root The element which becomes the root of the tree
+ */
+void ElementTree::parse(const tinyxml2::XMLElement* root) {
+    clear();
+    std::unordered_map<std::string, Uint32> strings;
+    add(root, strings);
+    mp_strings = m_string_buffer.data();
+    m_strings_size = m_string_buffer.size();
+    link();
+}
+
+/**
+ * @brief Loads the binary tables written by write()
+ * @param data The tables, which have to outlive the tree
+ * @param size The size of @p data in bytes
+ * @return @c bool which indicates if the tables are complete and consistent
+ */
+bool ElementTree::load(const Uint8* data, size_t size) {
+    static_assert(sizeof(Record) == 6 * sizeof(Uint32), "Records have to be stored without padding");
+    clear();
+
+    Uint32 counts[3];
+    if(size < sizeof(counts)) {return false;}
+    std::memcpy(counts, data, sizeof(counts));
+    const Uint64 record_bytes = static_cast<Uint64>(counts[0]) * sizeof(Record);
+    const Uint64 attribute_bytes = static_cast<Uint64>(counts[1]) * 2 * sizeof(Uint32);
+    if(counts[0] == 0 || counts[2] == 0 || sizeof(counts) + record_bytes + attribute_bytes + counts[2] != size) {return false;}
+
+    m_records.resize(counts[0]);
+    m_attribute_records.resize(static_cast<size_t>(counts[1]) * 2);
+    std::memcpy(m_records.data(), data + sizeof(counts), record_bytes);
+    std::memcpy(m_attribute_records.data(), data + sizeof(counts) + record_bytes, attribute_bytes);
+    mp_strings = reinterpret_cast<const char*>(data + sizeof(counts) + record_bytes + attribute_bytes);
+    m_strings_size = counts[2];
+
+    // Children and siblings have to follow their element, which rules out cycles
+    bool valid = mp_strings[m_strings_size - 1] == '\0';
+    for(Uint32 i = 0; valid && i < m_records.size(); i++) {
+        const Record& record = m_records[i];
+        valid = record.name < m_strings_size &&
+                (record.text == NONE || record.text < m_strings_size) &&
+                static_cast<Uint64>(record.first_attribute) + record.attribute_count <= counts[1] &&
+                (record.first_child == NONE || (record.first_child > i && record.first_child < counts[0])) &&
+                (record.next_sibling == NONE || (record.next_sibling > i && record.next_sibling < counts[0]));
+    }
+    for(size_t i = 0; valid && i < m_attribute_records.size(); i++) {
+        valid = m_attribute_records[i] < m_strings_size;
+    }
+    if(!valid) {
+        clear();
+        return false;
+    }
+
+    link();
+    return true;
+}
+
+/**
+ * @brief Appends the tree as binary tables to a buffer
+ *
+ * The tables are the element, attribute and string counts followed by the element
+ * records, the attribute records and the null terminated strings, all in native byte order.
+ */
+void ElementTree::write(std::vector<char>& buffer) const {
+    const Uint32 counts[3] = {static_cast<Uint32>(m_records.size()),
+                              static_cast<Uint32>(m_attribute_records.size() / 2),
+                              static_cast<Uint32>(m_strings_size)};
+    append(buffer, counts, 3);
+    append(buffer, m_records.data(), m_records.size());
+    append(buffer, m_attribute_records.data(), m_attribute_records.size());
+    append(buffer, mp_strings, m_strings_size);
+}
+
+/// Removes all elements
+void ElementTree::clear() {
+    m_records.clear();
+    m_attribute_records.clear();
+    m_string_buffer.clear();
+    mp_strings = nullptr;
+    m_strings_size = 0;
+    m_elements.clear();
+    m_attributes.clear();
+}
+
+/**
+ * @brief Appends the records of an XML element and its descendants in document order
+ * @param source The XML element
+ * @param strings The offsets of the strings which are already stored, for sharing repeated names and values
+ * @return The index of the record of @p source
+ */
+Uint32 ElementTree::add(const tinyxml2::XMLElement* source, std::unordered_map<std::string, Uint32>& strings) {
+    Record record;
+    record.name = add_string(source->Name(), &strings);
+    // Texts like the tile data of map layers are rarely repeated and can get huge
+    record.text = source->GetText() == nullptr ? NONE : add_string(source->GetText(), nullptr);
+    record.first_attribute = static_cast<Uint32>(m_attribute_records.size() / 2);
+    record.attribute_count = 0;
+    for(const tinyxml2::XMLAttribute* attribute = source->FirstAttribute(); attribute != nullptr; attribute = attribute->Next()) {
+        m_attribute_records.push_back(add_string(attribute->Name(), &strings));
+        m_attribute_records.push_back(add_string(attribute->Value(), &strings));
+        record.attribute_count++;
+    }
+    record.first_child = NONE;
+    record.next_sibling = NONE;
+
+    const Uint32 index = static_cast<Uint32>(m_records.size());
+    m_records.push_back(record);
+
+    Uint32 previous = NONE;
+    for(const tinyxml2::XMLElement* child = source->FirstChildElement(); child != nullptr; child = child->NextSiblingElement()) {
+        const Uint32 child_index = add(child, strings);
+        if(previous == NONE) {m_records[index].first_child = child_index;}
+        else {m_records[previous].next_sibling = child_index;}
+        previous = child_index;
+    }
+    return index;
+}
+
+/**
+ * @brief Stores a null terminated string in the string buffer
+ * @param text The string
+ * @param strings The offsets of the strings which are already stored or @c nullptr to always store a copy
+ * @return The offset of the string
+ */
+Uint32 ElementTree::add_string(const char* text, std::unordered_map<std::string, Uint32>* strings) {
+    if(strings != nullptr) {
+        auto found = strings->find(text);
+        if(found != strings->end()) {return found->second;}
+    }
+    const Uint32 offset = static_cast<Uint32>(m_string_buffer.size());
+    m_string_buffer.insert(m_string_buffer.end(), text, text + std::strlen(text) + 1);
+    if(strings != nullptr) {strings->emplace(text, offset);}
+    return offset;
+}
+
+/// Builds the elements from the records
+void ElementTree::link() {
+    m_elements.resize(m_records.size());
+    m_attributes.resize(m_attribute_records.size());
+    for(size_t i = 0; i < m_attribute_records.size(); i++) {
+        m_attributes[i] = mp_strings + m_attribute_records[i];
+    }
+    for(size_t i = 0; i < m_records.size(); i++) {
+        const Record& record = m_records[i];
+        Element& element = m_elements[i];
+        element.m_name = mp_strings + record.name;
+        element.m_text = record.text == NONE ? nullptr : mp_strings + record.text;
+        element.m_attributes = m_attributes.data() + static_cast<size_t>(record.first_attribute) * 2;
+        element.m_attribute_count = record.attribute_count;
+        element.m_first_child = record.first_child == NONE ? nullptr : &m_elements[record.first_child];
+        element.m_next_sibling = record.next_sibling == NONE ? nullptr : &m_elements[record.next_sibling];
+    }
+}
+
+}} // namespace salmon::internal
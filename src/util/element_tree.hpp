@@ -0,0 +1,112 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ELEMENT_TREE_HPP_INCLUDED
+#define ELEMENT_TREE_HPP_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SDL.h>
+#include <tinyxml2.h>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief A read only element of an ElementTree
+ *
+ * Offers the same queries as @c tinyxml2::XMLElement, so the map parsers work
+ * alike on maps loaded from XML and on cooked maps.
+ */
+class Element {
+    public:
+        const char* Name() const {return m_name;}
+        const char* GetText() const {return m_text;}
+        const char* Attribute(const char* name, const char* value = nullptr) const;
+        const Element* FirstChildElement(const char* name = nullptr) const;
+        const Element* NextSiblingElement(const char* name = nullptr) const;
+
+        tinyxml2::XMLError QueryBoolAttribute(const char* name, bool* value) const;
+        tinyxml2::XMLError QueryIntAttribute(const char* name, int* value) const;
+        tinyxml2::XMLError QueryUnsignedAttribute(const char* name, unsigned* value) const;
+        tinyxml2::XMLError QueryFloatAttribute(const char* name, float* value) const;
+        tinyxml2::XMLError QueryDoubleAttribute(const char* name, double* value) const;
+        int IntAttribute(const char* name, int default_value = 0) const;
+        unsigned UnsignedAttribute(const char* name, unsigned default_value = 0) const;
+
+    private:
+        friend class ElementTree;
+
+        const char* m_name = nullptr;
+        const char* m_text = nullptr;
+        const char* const* m_attributes = nullptr; ///< Pairs of attribute name and value
+        unsigned m_attribute_count = 0;
+        const Element* m_first_child = nullptr;
+        const Element* m_next_sibling = nullptr;
+};
+
+/**
+ * @brief The elements of a map or tileset as flat tables, see Element
+ *
+ * A tree either gets parsed from a tinyxml2 document or loaded from the binary
+ * tables written by write(). Loading only checks and links the tables, the strings
+ * stay inside the loaded memory, which has to outlive the tree.
+ */
+class ElementTree {
+    public:
+        ElementTree() = default;
+        ElementTree(const ElementTree& other) = delete;
+        ElementTree& operator=(const ElementTree& other) = delete;
+
+        void parse(const tinyxml2::XMLElement* root);
+        bool load(const Uint8* data, size_t size);
+        void write(std::vector<char>& buffer) const;
+        void clear();
+
+        const Element* get_root() const {return m_elements.empty() ? nullptr : &m_elements.front();}
+
+    private:
+        static const Uint32 NONE;
+
+        /// An element as stored in the binary tables, strings are offsets into the string table
+        struct Record {
+            Uint32 name;
+            Uint32 text;
+            Uint32 first_attribute;
+            Uint32 attribute_count;
+            Uint32 first_child;
+            Uint32 next_sibling;
+        };
+
+        Uint32 add(const tinyxml2::XMLElement* source, std::unordered_map<std::string, Uint32>& strings);
+        Uint32 add_string(const char* text, std::unordered_map<std::string, Uint32>* strings);
+        void link();
+
+        std::vector<Record> m_records; ///< In document order, so children and siblings follow their element
+        std::vector<Uint32> m_attribute_records; ///< Pairs of string offsets of attribute name and value
+        std::vector<char> m_string_buffer; ///< Holds the strings of parsed trees
+        const char* mp_strings = nullptr;
+        size_t m_strings_size = 0;
+
+        std::vector<Element> m_elements;
+        std::vector<const char*> m_attributes;
+};
+
+}} // namespace salmon::internal
+
+#endif // ELEMENT_TREE_HPP_INCLUDED
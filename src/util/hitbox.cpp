@@ -0,0 +1,212 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/hitbox.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace salmon { namespace internal {
+
+constexpr HitboxId HitboxNames::DEFAULT;
+constexpr HitboxId HitboxNames::INVALID;
+
+namespace {
+    struct Name {
+        std::string text;
+        HitboxId id;
+    };
+
+    /**
+     * @brief Hash table of interned names which readers probe without locking
+     *
+     * Slots only ever change from nullptr to a name, so a reader sees either a
+     * complete entry or an empty slot. At most half of the slots are used,
+     * which keeps probes short and guarantees that each probe ends.
+     */
+    struct Table {
+        explicit Table(size_t c) : capacity{c}, slots(new std::atomic<const Name*>[c * 2]), by_id(new std::atomic<const Name*>[c]) {
+            for(size_t i = 0; i < c * 2; i++) {slots[i].store(nullptr, std::memory_order_relaxed);}
+            for(size_t i = 0; i < c; i++) {by_id[i].store(nullptr, std::memory_order_relaxed);}
+        }
+        const size_t capacity; ///< Number of names fitting into the table
+        std::unique_ptr<std::atomic<const Name*>[]> slots; ///< Names by hash with linear probing
+        std::unique_ptr<std::atomic<const Name*>[]> by_id; ///< Names indexed by their id
+
+        HitboxId find(const std::string& name) const {
+            size_t mask = capacity * 2 - 1;
+            for(size_t i = std::hash<std::string>()(name) & mask;; i = (i + 1) & mask) {
+                const Name* entry = slots[i].load(std::memory_order_acquire);
+                if(entry == nullptr) {return HitboxNames::INVALID;}
+                if(entry->text == name) {return entry->id;}
+            }
+        }
+
+        void insert(const Name& entry) {
+            by_id[entry.id].store(&entry, std::memory_order_release);
+            size_t mask = capacity * 2 - 1;
+            size_t i = std::hash<std::string>()(entry.text) & mask;
+            while(slots[i].load(std::memory_order_relaxed) != nullptr) {i = (i + 1) & mask;}
+            slots[i].store(&entry, std::memory_order_release);
+        }
+    };
+
+    /**
+     * @brief Holds all interned names and the table to look them up
+     *
+     * Names can be interned at any time, e.g. when a CollisionQuery gets built.
+     * A full table is replaced by one of twice the capacity. Old tables are kept
+     * since readers may still probe them, but as each is half the size of the
+     * next, all of them together take less memory than the current one.
+     */
+    struct Registry {
+        Registry() {
+            tables.emplace_back(new Table(16));
+            names.push_back(Name{DEFAULT_HITBOX, HitboxNames::DEFAULT});
+            tables.back()->insert(names.back());
+            current.store(tables.back().get());
+        }
+        std::mutex mutex; ///< Serializes interning new names
+        std::deque<Name> names; ///< Keeps references to names valid while growing
+        std::vector<std::unique_ptr<Table>> tables;
+        std::atomic<Table*> current;
+    };
+
+    Registry& registry() {
+        static Registry r;
+        return r;
+    }
+}
+
+/// Returns the id of the hitbox name and registers it if it's new
+HitboxId HitboxNames::intern(const std::string& name) {
+    HitboxId id = find(name);
+    if(id != INVALID) {return id;}
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Table* table = r.current.load(std::memory_order_relaxed);
+    id = table->find(name);
+    if(id != INVALID) {return id;}
+    if(r.names.size() == table->capacity) {
+        r.tables.emplace_back(new Table(table->capacity * 2));
+        table = r.tables.back().get();
+        for(const Name& entry : r.names) {table->insert(entry);}
+        r.current.store(table, std::memory_order_release);
+    }
+    id = static_cast<HitboxId>(r.names.size());
+    r.names.push_back(Name{name, id});
+    table->insert(r.names.back());
+    return id;
+}
+
+/// Returns the id of the hitbox name or INVALID if no hitbox has this name, doesn't lock
+HitboxId HitboxNames::find(const std::string& name) {
+    return registry().current.load(std::memory_order_acquire)->find(name);
+}
+
+/// Returns the ids of the hitbox names in the same order
+std::vector<HitboxId> HitboxNames::find(const std::vector<std::string>& names) {
+    std::vector<HitboxId> ids;
+    ids.reserve(names.size());
+    for(const std::string& name : names) {
+        ids.push_back(find(name));
+    }
+    return ids;
+}
+
+/// Returns the name of the hitbox id or an empty string if the id is invalid, doesn't lock
+const std::string& HitboxNames::get_name(HitboxId id) {
+    static const std::string empty;
+    const Table& table = *registry().current.load(std::memory_order_acquire);
+    if(id >= table.capacity) {return empty;}
+    const Name* entry = table.by_id[id].load(std::memory_order_acquire);
+    if(entry == nullptr) {return empty;}
+    return entry->text;
+}
+
+/// Returns a pointer to the hitbox with the id or nullptr if there is none
+const Rect* HitboxSet::find(HitboxId id) const {
+    for(const Entry& e : m_entries) {
+        if(e.id == id) {return &e.rect;}
+        if(e.id > id) {break;}
+    }
+    return nullptr;
+}
+
+/// Returns the hitbox with the id or an empty one if there is none
+Rect HitboxSet::get(HitboxId id) const {
+    const Rect* rect = find(id);
+    if(rect == nullptr) {return Rect{0,0,0,0};}
+    return *rect;
+}
+
+/// Adds the hitbox or overrides the one with the same id
+void HitboxSet::set(HitboxId id, const Rect& rect) {
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), id,
+                               [](const Entry& e, HitboxId i){return e.id < i;});
+    if(it != m_entries.end() && it->id == id) {
+        it->rect = rect;
+    }
+    else {
+        m_entries.insert(it, Entry{id, rect});
+    }
+}
+
+/// Adds all hitboxes of other, which override the ones with the same id
+void HitboxSet::merge(const HitboxSet& other) {
+    for(const Entry& e : other.m_entries) {
+        set(e.id, e.rect);
+    }
+}
+
+/// Returns true if both sets hold the same hitboxes at the same positions
+bool HitboxSet::operator==(const HitboxSet& other) const {
+    if(m_entries.size() != other.m_entries.size()) {return false;}
+    for(size_t i = 0; i < m_entries.size(); i++) {
+        const Entry& a = m_entries[i];
+        const Entry& b = other.m_entries[i];
+        if(a.id != b.id || a.rect.x != b.rect.x || a.rect.y != b.rect.y || a.rect.w != b.rect.w || a.rect.h != b.rect.h) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Returns the smallest rect enclosing all non-empty hitboxes, or an empty rect if there are none
+Rect HitboxSet::get_bounds() const {
+    Rect bounds;
+    for(const Entry& e : m_entries) {
+        const Rect& r = e.rect;
+        if(r.empty()) {continue;}
+        if(bounds.empty()) {bounds = r; continue;}
+        float x2 = std::max(bounds.x + bounds.w, r.x + r.w);
+        float y2 = std::max(bounds.y + bounds.h, r.y + r.h);
+        bounds.x = std::min(bounds.x, r.x);
+        bounds.y = std::min(bounds.y, r.y);
+        bounds.w = x2 - bounds.x;
+        bounds.h = y2 - bounds.y;
+    }
+    return bounds;
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HITBOX_HPP_INCLUDED
+#define HITBOX_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+/// Interned name of a hitbox
+typedef unsigned HitboxId;
+
+/**
+ * @brief Global registry which maps each distinct hitbox name to a small integer id
+ *
+ * Names get interned while parsing tiles and when a CollisionQuery gets built,
+ * so collision checks only compare ids. Other calls taking hitbox names only
+ * look them up, since a name which was never interned can't match any hitbox.
+ * The id of DEFAULT_HITBOX is always DEFAULT. Ids follow the order in which names
+ * were first interned, not their alphabetical order.
+ *
+ * Looking up names and ids never locks, only interning a new name does.
+ */
+class HitboxNames {
+    public:
+        static constexpr HitboxId DEFAULT = 0;
+        static constexpr HitboxId INVALID = static_cast<HitboxId>(-1); ///< Id of names which were never interned
+
+        static HitboxId intern(const std::string& name);
+        static HitboxId find(const std::string& name);
+        static std::vector<HitboxId> find(const std::vector<std::string>& names);
+        static const std::string& get_name(HitboxId id);
+};
+
+/**
+ * @brief Small flat set of hitboxes keyed by their interned name
+ *
+ * Entries are kept sorted by id. Since a tile or actor only has a handful of hitboxes,
+ * a linear search beats any tree or hash lookup.
+ */
+class HitboxSet {
+    public:
+        struct Entry {
+            HitboxId id;
+            Rect rect;
+        };
+
+        const Rect* find(HitboxId id) const;
+        Rect get(HitboxId id) const;
+        void set(HitboxId id, const Rect& rect);
+        void merge(const HitboxSet& other);
+        Rect get_bounds() const;
+
+        bool operator==(const HitboxSet& other) const;
+        bool operator!=(const HitboxSet& other) const {return !(*this == other);}
+
+        bool empty() const {return m_entries.empty();}
+        size_t size() const {return m_entries.size();}
+
+        std::vector<Entry>::iterator begin() {return m_entries.begin();}
+        std::vector<Entry>::iterator end() {return m_entries.end();}
+        std::vector<Entry>::const_iterator begin() const {return m_entries.begin();}
+        std::vector<Entry>::const_iterator end() const {return m_entries.end();}
+
+    private:
+        std::vector<Entry> m_entries;
+};
+
+/**
+ * @brief Reports each pair of intersecting non-empty hitboxes of two lists
+ * @param first, second The lists, e.g. a HitboxSet, a TileCollider or a list of hitbox ids
+ * @param first_entry, second_entry Map an element of their list to its id and rect in world coordinates
+ * @param report Gets called with the ids of the first and the second hitbox of each intersecting pair
+ * @return True if any pair of hitboxes intersected
+ *
+ * Pairs get reported in the order of the first list, then in the order of the second list.
+ */
+template<class First, class Second, class FirstEntry, class SecondEntry, class Report>
+bool intersect_hitboxes(const First& first, FirstEntry first_entry, const Second& second, SecondEntry second_entry, Report report) {
+    bool collided = false;
+    for(const auto& first_element : first) {
+        const HitboxSet::Entry first_hitbox = first_entry(first_element);
+        if(first_hitbox.rect.empty()) {continue;}
+        for(const auto& second_element : second) {
+            const HitboxSet::Entry second_hitbox = second_entry(second_element);
+            if(second_hitbox.rect.empty()) {continue;}
+            if(first_hitbox.rect.has_intersection(second_hitbox.rect)) {
+                collided = true;
+                report(first_hitbox.id, second_hitbox.id);
+            }
+        }
+    }
+    return collided;
+}
+
+/// Reports each pair of intersecting non-empty hitboxes of two sets, whose rects are in world coordinates
+template<class Report>
+bool intersect_hitboxes(const HitboxSet& first, const HitboxSet& second, Report report) {
+    auto same = [](const HitboxSet::Entry& entry) -> const HitboxSet::Entry& {return entry;};
+    return intersect_hitboxes(first, same, second, same, report);
+}
+
+}} // namespace salmon::internal
+
+#endif // HITBOX_HPP_INCLUDED
@@ -26,6 +26,8 @@
 
 namespace salmon { namespace internal {
 
+std::mutex Logger::s_mutex;
+
 #ifndef __EMSCRIPTEN__
     // Define static vars
     const char* Logger::s_log_filename = "log.txt";
@@ -96,6 +98,8 @@ void Logger::flush() {
     std::string time = timestamp();
     std::string level = log_level();
 
+    std::lock_guard<std::mutex> lock(s_mutex);
+
     // Windows has problems with ANSI color codes
     #ifdef _WIN32
         // Write log to terminal
@@ -23,6 +23,7 @@
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 
 namespace salmon { namespace internal {
 
@@ -75,6 +76,8 @@ private:
     LogLevel m_log_level = info;
     std::stringstream m_buffer;
 
+    static std::mutex s_mutex; ///< Keeps messages of different threads from interleaving
+
     #ifndef __EMSCRIPTEN__
         static std::ofstream open_log();
         static std::ofstream s_logfile;
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/mapped_file.hpp"
+
+#if defined(_WIN32)
+    #include <windows.h>
+#elif defined(__EMSCRIPTEN__)
+    #include <fstream>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Maps the file at the given path, a previously mapped file gets closed
+ * @return @c bool which indicates success, empty files count as failure
+ */
+bool MappedFile::open(std::string path) {
+    close();
+
+    #if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE) {return false;}
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(mapping == nullptr) {
+            CloseHandle(file);
+            return false;
+        }
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if(data == nullptr) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+        m_file = file;
+        m_mapping = mapping;
+        m_data = static_cast<const Uint8*>(data);
+        m_size = static_cast<size_t>(size.QuadPart);
+    #elif defined(__EMSCRIPTEN__)
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file) {return false;}
+        std::streamoff size = file.tellg();
+        if(size <= 0) {return false;}
+        m_buffer.resize(static_cast<size_t>(size));
+        file.seekg(0);
+        if(!file.read(reinterpret_cast<char*>(m_buffer.data()), size)) {
+            m_buffer.clear();
+            return false;
+        }
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+    #else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if(file < 0) {return false;}
+        struct stat info;
+        if(fstat(file, &info) != 0 || info.st_size == 0) {
+            ::close(file);
+            return false;
+        }
+        void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        // The mapping stays valid after closing the file descriptor
+        ::close(file);
+        if(data == MAP_FAILED) {return false;}
+        m_data = static_cast<const Uint8*>(data);
+        m_size = static_cast<size_t>(info.st_size);
+    #endif
+    return true;
+}
+
+/// Unmaps the file
+void MappedFile::close() {
+    if(m_data == nullptr) {return;}
+
+    #if defined(_WIN32)
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = nullptr;
+    #elif defined(__EMSCRIPTEN__)
+        std::vector<Uint8>().swap(m_buffer);
+    #else
+        munmap(const_cast<Uint8*>(m_data), m_size);
+    #endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+}} // namespace salmon::internal
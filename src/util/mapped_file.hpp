@@ -0,0 +1,62 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MAPPED_FILE_HPP_INCLUDED
+#define MAPPED_FILE_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <SDL.h>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Maps a whole file read only into memory
+ *
+ * Emscripten builds read the file into a buffer instead.
+ */
+class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile() {close();}
+
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+
+        bool open(std::string path);
+        void close();
+
+        bool is_open() const {return m_data != nullptr;}
+        const Uint8* get_data() const {return m_data;}
+        size_t get_size() const {return m_size;}
+
+    private:
+        const Uint8* m_data = nullptr;
+        size_t m_size = 0;
+
+        #if defined(_WIN32)
+            void* m_file = nullptr;
+            void* m_mapping = nullptr;
+        #elif defined(__EMSCRIPTEN__)
+            std::vector<Uint8> m_buffer;
+        #endif
+};
+
+}} // namespace salmon::internal
+
+#endif // MAPPED_FILE_HPP_INCLUDED
@@ -28,12 +28,12 @@ namespace salmon { namespace internal {
 
  /**
  * @brief Converts the xmlelement to a proper Rect with checking
- * @param source The @c XMLElement which holds the information
+ * @param source The @c Element which holds the information
  * @param rect The rect which gets produced
  * @return @c XMLError Indicating success or failure
  * @note Only the first hitbox gets parsed, multiple hitboxes lead to an error
  */
-tinyxml2::XMLError parse::hitbox(tinyxml2::XMLElement* source, Rect& rect) {
+tinyxml2::XMLError parse::hitbox(const Element* source, Rect& rect) {
     using namespace tinyxml2;
     XMLError eResult;
 
@@ -78,11 +78,11 @@ tinyxml2::XMLError parse::hitbox(tinyxml2::XMLElement* source, Rect& rect) {
 
 /**
  * @brief Converts the xmlelement to multiple proper Rects with checking
- * @param source The @c XMLElement which holds the information
+ * @param source The @c Element which holds the information
  * @param rects The rects which get produced
  * @return @c XMLError Indicating success or failure
  */
-tinyxml2::XMLError parse::hitboxes(tinyxml2::XMLElement* source, std::map<std::string, Rect>& rects) {
+tinyxml2::XMLError parse::hitboxes(const Element* source, HitboxSet& rects) {
     using namespace tinyxml2;
     XMLError eResult;
 
@@ -123,12 +123,13 @@ tinyxml2::XMLError parse::hitboxes(tinyxml2::XMLElement* source, std::map<std::s
         if(eResult != XML_SUCCESS) return eResult;
         temp_rec.h = temp;
 
-        if(rects.find(name) != rects.end()) {
+        HitboxId id = HitboxNames::intern(name);
+        if(rects.find(id) != nullptr) {
             Logger(Logger::error) << "Possible multiple definition of hitbox: " << name << " !";
             return XML_ERROR_PARSING_ATTRIBUTE;
         }
 
-        rects[name] = temp_rec;
+        rects.set(id, temp_rec);
 
         source = source->NextSiblingElement("object");
     }
@@ -137,11 +138,11 @@ tinyxml2::XMLError parse::hitboxes(tinyxml2::XMLElement* source, std::map<std::s
 
 /**
  * @brief Set the blendmode of a texture according to XML information
- * @param source The @c XMLElement which holds the information
+ * @param source The @c Element which holds the information
  * @param img The texture which blendmode gets set
  * @return @c XMLError Indicating success or failure
  */
-tinyxml2::XMLError parse::blendmode(tinyxml2::XMLElement* source, Texture& img) {
+tinyxml2::XMLError parse::blendmode(const Element* source, Texture& img) {
     using namespace tinyxml2;
     const char* p_mode;
     p_mode = source->Attribute("value");
@@ -160,11 +161,11 @@ tinyxml2::XMLError parse::blendmode(tinyxml2::XMLElement* source, Texture& img)
 
 /**
  * @brief Parse the background color of a map to a variable
- * @param source The @c XMLElement which holds the information
+ * @param source The @c Element which holds the information
  * @param color The referencte where the resulting color will be stored
  * @return @c CMLError Indicating sucess or failure
  */
-tinyxml2::XMLError parse::bg_color(tinyxml2::XMLElement* source, SDL_Color& color) {
+tinyxml2::XMLError parse::bg_color(const Element* source, SDL_Color& color) {
     using namespace tinyxml2;
 
     const char* p_bg_color;
@@ -181,4 +182,24 @@ tinyxml2::XMLError parse::bg_color(tinyxml2::XMLElement* source, SDL_Color& colo
     }
 }
 
+/**
+ * @brief Parse the value of a COLLISION_CATEGORY or COLLISION_MASK property
+ * @param source The @c Element of the property
+ * @param bits The bit field where the value gets stored
+ * @return @c XMLError Indicating success or failure
+ *
+ * Tiled only knows signed ints, so -1 yields a mask with all bits set
+ */
+tinyxml2::XMLError parse::collision_bits(const Element* source, Uint32& bits) {
+    using namespace tinyxml2;
+    int value;
+    XMLError eResult = source->QueryIntAttribute("value", &value);
+    if(eResult != XML_SUCCESS) {
+        Logger(Logger::error) << "Malformed collision bits, expected an int property";
+        return eResult;
+    }
+    bits = static_cast<Uint32>(value);
+    return XML_SUCCESS;
+}
+
 }} // namespace salmon::internal
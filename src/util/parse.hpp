@@ -25,18 +25,21 @@
 #include <map>
 #include <tinyxml2.h>
 
+#include "util/element_tree.hpp"
 #include "util/game_types.hpp"
+#include "util/hitbox.hpp"
 
 namespace salmon { namespace internal {
 
 class Texture;
 
 namespace parse{
-    tinyxml2::XMLError hitbox(tinyxml2::XMLElement* source, Rect& rect);
-    tinyxml2::XMLError hitboxes(tinyxml2::XMLElement* source, std::map<std::string, Rect>& rects);
-    tinyxml2::XMLError blendmode(tinyxml2::XMLElement* source, Texture& img);
+    tinyxml2::XMLError hitbox(const Element* source, Rect& rect);
+    tinyxml2::XMLError hitboxes(const Element* source, HitboxSet& rects);
+    tinyxml2::XMLError blendmode(const Element* source, Texture& img);
 
-    tinyxml2::XMLError bg_color(tinyxml2::XMLElement* source, SDL_Color& color);
+    tinyxml2::XMLError bg_color(const Element* source, SDL_Color& color);
+    tinyxml2::XMLError collision_bits(const Element* source, Uint32& bits);
 }
 }} // namespace salmon::internal
 
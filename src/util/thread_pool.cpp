@@ -0,0 +1,67 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/thread_pool.hpp"
+
+namespace salmon { namespace internal {
+
+/// Starts the given number of worker threads
+ThreadPool::ThreadPool(unsigned workers) {
+    m_workers.reserve(workers);
+    for(unsigned i = 0; i < workers; i++) {
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+/// Finishes all queued tasks and joins the worker threads
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for(std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+/// Returns the number of hardware threads, or zero if threads aren't available
+unsigned ThreadPool::default_size() {
+    #ifdef __EMSCRIPTEN__
+        return 0;
+    #else
+        return std::thread::hardware_concurrency();
+    #endif
+}
+
+/// Loop of each worker thread which runs tasks until the pool gets destroyed
+void ThreadPool::work() {
+    while(true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this](){return m_stop || !m_tasks.empty();});
+            if(m_tasks.empty()) {return;}
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef THREAD_POOL_HPP_INCLUDED
+#define THREAD_POOL_HPP_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief A fixed set of worker threads which run submitted tasks in FIFO order
+ *
+ * Results and exceptions of tasks are handed back through futures.
+ * A pool without workers runs each task directly inside of submit(), which is
+ * always the case for emscripten builds.
+ */
+class ThreadPool {
+    public:
+        ThreadPool() : ThreadPool(default_size()) {}
+        explicit ThreadPool(unsigned workers);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+
+        template<class Func>
+        auto submit(Func func) -> std::future<decltype(func())>;
+
+        unsigned get_size() const {return m_workers.size();}
+
+        static unsigned default_size();
+
+    private:
+        void work();
+
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stop = false;
+};
+
+/**
+ * @brief Queue a task for the worker threads
+ * @param func Callable without arguments
+ * @return @c std::future holding the return value of @p func
+ */
+template<class Func>
+auto ThreadPool::submit(Func func) -> std::future<decltype(func())> {
+    using Result = decltype(func());
+    // std::function requires a copyable target, so the task gets shared
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::move(func));
+    std::future<Result> result = task->get_future();
+
+    if(m_workers.empty()) {
+        (*task)();
+        return result;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.emplace_back([task](){(*task)();});
+    }
+    m_condition.notify_one();
+    return result;
+}
+
+}} // namespace salmon::internal
+
+#endif // THREAD_POOL_HPP_INCLUDED